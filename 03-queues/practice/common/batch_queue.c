@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "batch_queue.h"
+#include "tick_timeout.h"
+
+static const char *TAG = "BATCH_Q";
+
+bool batch_queue_init(batch_queue_t* queue, uint16_t capacity, size_t item_size) {
+    memset(queue, 0, sizeof(batch_queue_t));
+    queue->storage = heap_caps_malloc((size_t)capacity * item_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!queue->storage) {
+        ESP_LOGE(TAG, "Failed to allocate %d × %d byte queue", capacity, (int)item_size);
+        return false;
+    }
+    queue->item_size = item_size;
+    queue->capacity = capacity;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    queue->lock = unlocked;
+    return true;
+}
+
+void batch_queue_deinit(batch_queue_t* queue) {
+    heap_caps_free(queue->storage);
+    queue->storage = NULL;
+}
+
+// Waiter lists are FIFO so the longest-waiting task is woken first
+static bool add_waiter(TaskHandle_t* list, uint8_t* count, TaskHandle_t task) {
+    if (*count >= BATCH_QUEUE_MAX_WAITERS) return false;
+    list[(*count)++] = task;
+    return true;
+}
+
+static void remove_waiter(TaskHandle_t* list, uint8_t* count, TaskHandle_t task) {
+    for (int i = 0; i < *count; i++) {
+        if (list[i] == task) {
+            memmove(&list[i], &list[i + 1], (*count - i - 1) * sizeof(TaskHandle_t));
+            (*count)--;
+            return;
+        }
+    }
+}
+
+static TaskHandle_t pop_waiter(TaskHandle_t* list, uint8_t* count) {
+    if (*count == 0) return NULL;
+    TaskHandle_t task = list[0];
+    remove_waiter(list, count, task);
+    return task;
+}
+
+// Ring copies, split in two where the batch wraps
+static void copy_in(batch_queue_t* queue, const uint8_t* src, int n) {
+    uint16_t tail = (queue->head + queue->count) % queue->capacity;
+    int first = n < queue->capacity - tail ? n : queue->capacity - tail;
+    memcpy(queue->storage + tail * queue->item_size, src, first * queue->item_size);
+    memcpy(queue->storage, src + first * queue->item_size, (n - first) * queue->item_size);
+    queue->count += n;
+}
+
+static void copy_out(batch_queue_t* queue, uint8_t* dst, int n) {
+    int first = n < queue->capacity - queue->head ? n : queue->capacity - queue->head;
+    memcpy(dst, queue->storage + queue->head * queue->item_size, first * queue->item_size);
+    memcpy(dst + first * queue->item_size, queue->storage, (n - first) * queue->item_size);
+    queue->head = (queue->head + n) % queue->capacity;
+    queue->count -= n;
+}
+
+static void wake(TaskHandle_t task) {
+    if (task) xTaskNotifyGive(task);
+}
+
+int queue_send_batch(batch_queue_t* queue, const void* items, int n, TickType_t timeout) {
+    const uint8_t* src = items;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+    int sent = 0;
+
+    while (1) {
+        TickType_t left = tick_timeout_left(start, timeout);
+        TaskHandle_t receiver = NULL, next_sender = NULL;
+        bool registered = false;
+
+        portENTER_CRITICAL(&queue->lock);
+        remove_waiter(queue->senders, &queue->sender_count, self);
+        int space = queue->capacity - queue->count;
+        int chunk = n - sent < space ? n - sent : space;
+        if (chunk > 0) {
+            copy_in(queue, src + sent * queue->item_size, chunk);
+            sent += chunk;
+            queue->send_batches++;
+            queue->items_moved += chunk;
+            receiver = pop_waiter(queue->receivers, &queue->receiver_count);
+        }
+        if (sent < n && left > 0) {
+            registered = add_waiter(queue->senders, &queue->sender_count, self);
+        } else if (queue->count < queue->capacity) {
+            next_sender = pop_waiter(queue->senders, &queue->sender_count);
+        }
+        queue->wakeups += (receiver != NULL) + (next_sender != NULL);
+        portEXIT_CRITICAL(&queue->lock);
+
+        wake(receiver);
+        wake(next_sender);
+        if (sent == n || left == 0) return sent;
+
+        // With the waiter list full, fall back to polling every tick
+        ulTaskNotifyTake(pdTRUE, registered ? left : 1);
+    }
+}
+
+int queue_receive_batch(batch_queue_t* queue, void* out, int max_n, TickType_t timeout) {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+
+    while (1) {
+        TickType_t left = tick_timeout_left(start, timeout);
+        TaskHandle_t sender = NULL, next_receiver = NULL;
+        bool registered = false;
+
+        portENTER_CRITICAL(&queue->lock);
+        remove_waiter(queue->receivers, &queue->receiver_count, self);
+        int taken = queue->count < max_n ? queue->count : max_n;
+        if (taken > 0) {
+            copy_out(queue, out, taken);
+            queue->receive_batches++;
+            sender = pop_waiter(queue->senders, &queue->sender_count);
+            if (queue->count > 0) {
+                next_receiver = pop_waiter(queue->receivers, &queue->receiver_count);
+            }
+        } else if (left > 0) {
+            registered = add_waiter(queue->receivers, &queue->receiver_count, self);
+        }
+        queue->wakeups += (sender != NULL) + (next_receiver != NULL);
+        portEXIT_CRITICAL(&queue->lock);
+
+        wake(sender);
+        wake(next_receiver);
+        if (taken > 0 || left == 0) return taken;
+
+        ulTaskNotifyTake(pdTRUE, registered ? left : 1);
+    }
+}
+
+uint16_t batch_queue_count(batch_queue_t* queue) {
+    portENTER_CRITICAL(&queue->lock);
+    uint16_t count = queue->count;
+    portEXIT_CRITICAL(&queue->lock);
+    return count;
+}
@@ -0,0 +1,54 @@
+#ifndef BATCH_QUEUE_H
+#define BATCH_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Fixed-size item queue that moves items in batches. xQueueSend and
+// xQueueReceive take the queue lock and may wake a task for every single
+// item; here a whole batch is copied in one critical section and at most
+// one waiting task is woken per batch, so a consumer that drains
+// everything available pays for one lock and one context switch.
+//
+// Blocked tasks wait on their task notification; a woken task retries and
+// passes the wakeup on if it leaves room or items for the next waiter.
+
+#define BATCH_QUEUE_MAX_WAITERS 8
+
+typedef struct {
+    uint8_t* storage;
+    size_t item_size;
+    uint16_t capacity;
+    uint16_t head;
+    uint16_t count;
+
+    TaskHandle_t receivers[BATCH_QUEUE_MAX_WAITERS];
+    TaskHandle_t senders[BATCH_QUEUE_MAX_WAITERS];
+    uint8_t receiver_count;
+    uint8_t sender_count;
+    portMUX_TYPE lock;
+
+    // Statistics
+    uint32_t send_batches;
+    uint32_t receive_batches;
+    uint32_t items_moved;
+    uint32_t wakeups;
+} batch_queue_t;
+
+bool batch_queue_init(batch_queue_t* queue, uint16_t capacity, size_t item_size);
+void batch_queue_deinit(batch_queue_t* queue);
+
+// Copies up to n items, blocking while the queue is full; returns how many
+// were queued before the timeout (n unless it expired)
+int queue_send_batch(batch_queue_t* queue, const void* items, int n, TickType_t timeout);
+
+// Waits until at least one item is available, then takes up to max_n in
+// one go; returns the number received (0 on timeout)
+int queue_receive_batch(batch_queue_t* queue, void* out, int max_n, TickType_t timeout);
+
+uint16_t batch_queue_count(batch_queue_t* queue);
+
+#endif
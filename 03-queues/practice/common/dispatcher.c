@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "dispatcher.h"
+
+static const char *TAG = "DISPATCH";
+
+bool dispatcher_init(dispatcher_t* dispatcher, UBaseType_t set_length,
+                     dispatch_policy_t policy, uint16_t max_per_wakeup) {
+    memset(dispatcher, 0, sizeof(dispatcher_t));
+    dispatcher->set = xQueueCreateSet(set_length);
+    if (!dispatcher->set) {
+        ESP_LOGE(TAG, "Failed to create queue set (%d entries)", (int)set_length);
+        return false;
+    }
+    dispatcher->policy = policy;
+    dispatcher->max_per_wakeup = max_per_wakeup ? max_per_wakeup : 1;
+    dispatcher->reported_us = esp_timer_get_time();
+    return true;
+}
+
+bool dispatcher_add(dispatcher_t* dispatcher, const char* name, QueueSetMemberHandle_t member,
+                    void* source, dispatch_take_t take,
+                    dispatch_handler_t handler, void* ctx, uint16_t budget) {
+    if (dispatcher->count == DISPATCH_MAX_MEMBERS) {
+        ESP_LOGE(TAG, "No room for member %s (max %d)", name, DISPATCH_MAX_MEMBERS);
+        return false;
+    }
+    if (xQueueAddToSet(member, dispatcher->set) != pdPASS) {
+        ESP_LOGE(TAG, "Could not add %s to the set (not empty?)", name);
+        return false;
+    }
+    dispatch_entry_t* entry = &dispatcher->entries[dispatcher->count++];
+    memset(entry, 0, sizeof(dispatch_entry_t));
+    entry->name = name;
+    entry->member = member;
+    entry->source = source;
+    entry->take = take;
+    entry->handler = handler;
+    entry->ctx = ctx;
+    entry->budget = budget ? budget : 1;
+    return true;
+}
+
+static dispatch_take_result_t take_queue_item(void* source, void* item) {
+    return iqueue_receive(source, item, 0) ? DISPATCH_ITEM : DISPATCH_EMPTY;
+}
+
+bool dispatcher_add_queue(dispatcher_t* dispatcher, const char* name, iqueue_t* queue,
+                          dispatch_handler_t handler, void* ctx, uint16_t budget) {
+    if (queue->item_size > DISPATCH_MAX_ITEM_SIZE) {
+        ESP_LOGE(TAG, "Items of %s too large (%d bytes)", name, queue->item_size);
+        return false;
+    }
+    if (!dispatcher_add(dispatcher, name, queue->handle, queue, take_queue_item, handler, ctx, budget)) {
+        return false;
+    }
+    dispatcher->entries[dispatcher->count - 1].queue = queue;
+    return true;
+}
+
+static dispatch_take_result_t take_semaphore(void* source, void* item) {
+    return xSemaphoreTake((SemaphoreHandle_t)source, 0) == pdPASS ? DISPATCH_ITEM : DISPATCH_EMPTY;
+}
+
+bool dispatcher_add_semaphore(dispatcher_t* dispatcher, const char* name, SemaphoreHandle_t semaphore,
+                              dispatch_handler_t handler, void* ctx, uint16_t budget) {
+    return dispatcher_add(dispatcher, name, semaphore, semaphore, take_semaphore, handler, ctx, budget);
+}
+
+// A write that lands between taking the signal and reading the value is
+// picked up by this read, and its own signal later finds nothing new
+static dispatch_take_result_t take_mailbox_update(void* source, void* item) {
+    dispatch_entry_t* entry = source;
+    if (xSemaphoreTake(entry->mailbox->updated, 0) != pdPASS) {
+        return DISPATCH_EMPTY;
+    }
+    return mailbox_read_new(entry->mailbox, entry->reader, item) ? DISPATCH_ITEM : DISPATCH_CONSUMED;
+}
+
+bool dispatcher_add_mailbox(dispatcher_t* dispatcher, const char* name, mailbox_t* mailbox,
+                            mailbox_reader_t* reader, dispatch_handler_t handler, void* ctx) {
+    if (mailbox->size > DISPATCH_MAX_ITEM_SIZE) {
+        ESP_LOGE(TAG, "Mailbox %s too large (%d bytes)", name, (int)mailbox->size);
+        return false;
+    }
+    dispatch_entry_t* entry = &dispatcher->entries[dispatcher->count];
+    if (!dispatcher_add(dispatcher, name, mailbox->updated, entry, take_mailbox_update, handler, ctx, 1)) {
+        return false;
+    }
+    entry->mailbox = mailbox;
+    entry->reader = reader;
+    return true;
+}
+
+int dispatcher_run_once(dispatcher_t* dispatcher, TickType_t timeout) {
+    uint32_t item[(DISPATCH_MAX_ITEM_SIZE + 3) / 4];
+    if (dispatcher->count == 0 || xQueueSelectFromSet(dispatcher->set, timeout) == NULL) {
+        return 0;
+    }
+    dispatcher->wakeups++;
+
+    // The select above removed one set entry; remove one more per extra item
+    bool credit = true;
+    int handled = 0;
+    int start = 0;
+    if (dispatcher->policy == DISPATCH_ROUND_ROBIN) {
+        start = dispatcher->next;
+        dispatcher->next = (dispatcher->next + 1) % dispatcher->count;
+    }
+
+    bool progress = true;
+    while (progress && handled < dispatcher->max_per_wakeup) {
+        progress = false;
+        for (int i = 0; i < dispatcher->count && handled < dispatcher->max_per_wakeup; i++) {
+            dispatch_entry_t* entry = &dispatcher->entries[(start + i) % dispatcher->count];
+            uint16_t batch = 0;
+            while (batch < entry->budget && handled < dispatcher->max_per_wakeup) {
+                dispatch_take_result_t taken = entry->take(entry->source, item);
+                if (taken == DISPATCH_EMPTY) break;
+                if (credit) {
+                    credit = false;
+                } else {
+                    xQueueSelectFromSet(dispatcher->set, 0);
+                }
+                if (taken == DISPATCH_CONSUMED) continue;
+                entry->handler(item, entry->ctx);
+                batch++;
+                handled++;
+            }
+            if (batch == 0) continue;
+            progress = true;
+            entry->events += batch;
+            entry->turns++;
+            if (batch == entry->budget) entry->budget_hits++;
+            if (batch > entry->max_batch) entry->max_batch = batch;
+        }
+    }
+    return handled;
+}
+
+void dispatcher_report(dispatcher_t* dispatcher) {
+    uint64_t now = esp_timer_get_time();
+    uint64_t elapsed_us = now - dispatcher->reported_us;
+    dispatcher->reported_us = now;
+
+    ESP_LOGI(TAG, "🔀 Dispatcher (%s, %d per wakeup): %lu wakeups",
+             dispatcher->policy == DISPATCH_ROUND_ROBIN ? "round-robin" : "priority",
+             dispatcher->max_per_wakeup, (unsigned long)dispatcher->wakeups);
+    for (int i = 0; i < dispatcher->count; i++) {
+        dispatch_entry_t* entry = &dispatcher->entries[i];
+        uint32_t events = entry->events;
+        uint32_t recent = events - entry->reported_events;
+        entry->reported_events = events;
+        float rate = elapsed_us ? recent * 1000000.0f / elapsed_us : 0;
+
+        char delay[64] = "";
+        if (entry->queue) {
+            snprintf(delay, sizeof(delay), ", delay p50 ≤%lums p99 ≤%lums",
+                     (unsigned long)((iqueue_latency_percentile(entry->queue, 50) + 999) / 1000),
+                     (unsigned long)((iqueue_latency_percentile(entry->queue, 99) + 999) / 1000));
+        }
+        ESP_LOGI(TAG, "  %-8s budget %2d: %5lu events (%.2f/s), batch max %d, budget used up %lu×%s",
+                 entry->name, entry->budget, (unsigned long)events, rate, entry->max_batch,
+                 (unsigned long)entry->budget_hits, delay);
+    }
+}
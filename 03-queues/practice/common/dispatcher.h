@@ -0,0 +1,105 @@
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "iqueue.h"
+#include "mailbox.h"
+
+// Table-driven dispatcher over a queue set. Each member is registered
+// with a handler and a budget; one dispatcher_run_once() sleeps on the
+// set, then drains every ready member in rounds, at most `budget` items
+// per member per round and max_per_wakeup items in total.
+//
+// The set is only used as a wakeup: it holds one entry per queued item,
+// so for every item taken beyond the first the dispatcher also removes
+// one entry (whichever member it names). The set therefore never holds
+// stale entries and cannot overflow, however deep the batches.
+//
+// Fairness between members:
+//   DISPATCH_ROUND_ROBIN - every wakeup starts one member further on;
+//                          budgets act as weights
+//   DISPATCH_PRIORITY    - every round starts at the first registered
+//                          member; budgets bound how long it holds the
+//                          lower ones off
+
+#define DISPATCH_MAX_MEMBERS    8
+#define DISPATCH_MAX_ITEM_SIZE  IQUEUE_MAX_ITEM_SIZE
+
+typedef enum {
+    DISPATCH_ROUND_ROBIN,
+    DISPATCH_PRIORITY
+} dispatch_policy_t;
+
+// Takes one item without blocking. DISPATCH_CONSUMED: the source used up
+// a wakeup but had nothing new to hand over (a mailbox already read).
+typedef enum {
+    DISPATCH_EMPTY,
+    DISPATCH_ITEM,
+    DISPATCH_CONSUMED
+} dispatch_take_result_t;
+
+typedef dispatch_take_result_t (*dispatch_take_t)(void* source, void* item);
+typedef void (*dispatch_handler_t)(const void* item, void* ctx);
+
+typedef struct {
+    const char* name;
+    QueueSetMemberHandle_t member;
+    void* source;
+    dispatch_take_t take;
+    dispatch_handler_t handler;
+    void* ctx;
+    iqueue_t* queue;                // Queueing delay source, NULL if none
+    mailbox_t* mailbox;             // Set for mailbox members
+    mailbox_reader_t* reader;
+    uint16_t budget;
+
+    // Statistics
+    uint32_t events;
+    uint32_t turns;                 // Rounds in which it had work
+    uint32_t budget_hits;           // Turns that used the whole budget
+    uint16_t max_batch;
+    uint32_t reported_events;       // events at the last report
+} dispatch_entry_t;
+
+typedef struct {
+    QueueSetHandle_t set;
+    dispatch_policy_t policy;
+    uint16_t max_per_wakeup;
+    int count;
+    int next;                       // Round-robin start
+    uint32_t wakeups;
+    uint64_t reported_us;
+    dispatch_entry_t entries[DISPATCH_MAX_MEMBERS];
+} dispatcher_t;
+
+// set_length: the summed lengths of every member that will be added
+bool dispatcher_init(dispatcher_t* dispatcher, UBaseType_t set_length,
+                     dispatch_policy_t policy, uint16_t max_per_wakeup);
+
+// Members must be empty when added (a queue set requirement)
+bool dispatcher_add(dispatcher_t* dispatcher, const char* name, QueueSetMemberHandle_t member,
+                    void* source, dispatch_take_t take,
+                    dispatch_handler_t handler, void* ctx, uint16_t budget);
+bool dispatcher_add_queue(dispatcher_t* dispatcher, const char* name, iqueue_t* queue,
+                          dispatch_handler_t handler, void* ctx, uint16_t budget);
+bool dispatcher_add_semaphore(dispatcher_t* dispatcher, const char* name, SemaphoreHandle_t semaphore,
+                              dispatch_handler_t handler, void* ctx, uint16_t budget);
+
+// Handles the latest value once per wakeup; reader tracks missed updates
+// and must outlive the dispatcher
+bool dispatcher_add_mailbox(dispatcher_t* dispatcher, const char* name, mailbox_t* mailbox,
+                            mailbox_reader_t* reader, dispatch_handler_t handler, void* ctx);
+
+// Returns the number of items handled, 0 on timeout
+int dispatcher_run_once(dispatcher_t* dispatcher, TickType_t timeout);
+
+// Per member: events, events/s since the previous report, batching and
+// queueing delay (for queue members)
+void dispatcher_report(dispatcher_t* dispatcher);
+
+#endif
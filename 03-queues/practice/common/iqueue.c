@@ -0,0 +1,195 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "iqueue.h"
+#include "log2_hist.h"
+
+static const char *TAG = "IQUEUE";
+
+// Each slot is the 32-bit enqueue stamp followed by the item
+#define IQUEUE_STAMP_SIZE   sizeof(uint32_t)
+#define IQUEUE_SLOT_WORDS   ((IQUEUE_STAMP_SIZE + IQUEUE_MAX_ITEM_SIZE + 3) / 4)
+
+static iqueue_t* registered_queues[IQUEUE_MAX_QUEUES];
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static inline uint32_t now_us(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// Registry
+static bool register_queue(iqueue_t* queue) {
+    bool registered = false;
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < IQUEUE_MAX_QUEUES; i++) {
+        if (!registered_queues[i]) {
+            registered_queues[i] = queue;
+            registered = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+    return registered;
+}
+
+static void unregister_queue(iqueue_t* queue) {
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < IQUEUE_MAX_QUEUES; i++) {
+        if (registered_queues[i] == queue) {
+            registered_queues[i] = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+iqueue_t* iqueue_create(const char* name, UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0 || length > UINT16_MAX || item_size == 0 || item_size > IQUEUE_MAX_ITEM_SIZE) {
+        ESP_LOGE(TAG, "Invalid queue %s: %d × %d bytes (max item %d)",
+                 name, (int)length, (int)item_size, IQUEUE_MAX_ITEM_SIZE);
+        return NULL;
+    }
+    iqueue_t* queue = heap_caps_calloc(1, sizeof(iqueue_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    QueueHandle_t handle = xQueueCreate(length, IQUEUE_STAMP_SIZE + item_size);
+    if (!queue || !handle) {
+        ESP_LOGE(TAG, "Failed to allocate queue %s", name);
+        heap_caps_free(queue);
+        if (handle) vQueueDelete(handle);
+        return NULL;
+    }
+
+    queue->name = name;
+    queue->handle = handle;
+    queue->length = length;
+    queue->item_size = item_size;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    queue->lock = unlocked;
+    if (!register_queue(queue)) {
+        ESP_LOGW(TAG, "Registry full, %s is not included in reports", name);
+    }
+    return queue;
+}
+
+void iqueue_delete(iqueue_t* queue) {
+    if (!queue) return;
+    unregister_queue(queue);
+    vQueueDelete(queue->handle);
+    heap_caps_free(queue);
+}
+
+static void record_call(iqueue_t* queue, iqueue_side_stats_t* side, bool blocked,
+                        uint32_t blocked_us, bool done) {
+    portENTER_CRITICAL(&queue->lock);
+    side->calls++;
+    if (blocked) {
+        side->blocked++;
+        side->blocked_us += blocked_us;
+    }
+    if (!done) side->timeouts++;
+    portEXIT_CRITICAL(&queue->lock);
+}
+
+// Latency runs from the send call (blocking on a full queue included) to
+// the receive
+bool iqueue_send(iqueue_t* queue, const void* item, TickType_t timeout) {
+    uint32_t slot[IQUEUE_SLOT_WORDS];
+    slot[0] = now_us();
+    memcpy(&slot[1], item, queue->item_size);
+
+    bool blocked = false;
+    uint32_t blocked_us = 0;
+    bool done = xQueueSend(queue->handle, slot, 0) == pdPASS;
+    if (!done && timeout > 0) {
+        blocked = true;
+        uint32_t start = now_us();
+        done = xQueueSend(queue->handle, slot, timeout) == pdPASS;
+        blocked_us = now_us() - start;
+    }
+    record_call(queue, &queue->send, blocked, blocked_us, done);
+
+    if (done) {
+        UBaseType_t waiting = uxQueueMessagesWaiting(queue->handle);
+        portENTER_CRITICAL(&queue->lock);
+        if (waiting > queue->high_water) queue->high_water = waiting;
+        portEXIT_CRITICAL(&queue->lock);
+    }
+    return done;
+}
+
+bool iqueue_receive(iqueue_t* queue, void* item, TickType_t timeout) {
+    uint32_t slot[IQUEUE_SLOT_WORDS];
+    bool blocked = false;
+    uint32_t blocked_us = 0;
+    bool done = xQueueReceive(queue->handle, slot, 0) == pdPASS;
+    if (!done && timeout > 0) {
+        blocked = true;
+        uint32_t start = now_us();
+        done = xQueueReceive(queue->handle, slot, timeout) == pdPASS;
+        blocked_us = now_us() - start;
+    }
+    record_call(queue, &queue->receive, blocked, blocked_us, done);
+    if (!done) return false;
+
+    uint32_t latency = now_us() - slot[0];
+    memcpy(item, &slot[1], queue->item_size);
+    portENTER_CRITICAL(&queue->lock);
+    queue->latency_hist[log2_hist_bucket(latency, IQUEUE_LATENCY_BUCKETS)]++;
+    if (latency > queue->latency_max_us) queue->latency_max_us = latency;
+    portEXIT_CRITICAL(&queue->lock);
+    return true;
+}
+
+UBaseType_t iqueue_waiting(const iqueue_t* queue) {
+    return uxQueueMessagesWaiting(queue->handle);
+}
+
+uint32_t iqueue_latency_percentile(iqueue_t* queue, int q) {
+    uint32_t hist[IQUEUE_LATENCY_BUCKETS];
+    portENTER_CRITICAL(&queue->lock);
+    memcpy(hist, queue->latency_hist, sizeof(hist));
+    portEXIT_CRITICAL(&queue->lock);
+    return log2_hist_percentile(hist, IQUEUE_LATENCY_BUCKETS, q);
+}
+
+void iqueue_for_each(iqueue_visitor_t visitor, void* ctx) {
+    iqueue_t* queues[IQUEUE_MAX_QUEUES];
+    portENTER_CRITICAL(&registry_lock);
+    memcpy(queues, registered_queues, sizeof(queues));
+    portEXIT_CRITICAL(&registry_lock);
+    for (int i = 0; i < IQUEUE_MAX_QUEUES; i++) {
+        if (queues[i]) visitor(queues[i], ctx);
+    }
+}
+
+static void report_queue(iqueue_t* queue, void* ctx) {
+    iqueue_t snapshot;
+    portENTER_CRITICAL(&queue->lock);
+    snapshot = *queue;
+    portEXIT_CRITICAL(&queue->lock);
+
+    char p50[12], p99[12], max[12], send_blocked[12], receive_blocked[12];
+    log2_hist_format_us(iqueue_latency_percentile(queue, 50), p50, sizeof(p50));
+    log2_hist_format_us(iqueue_latency_percentile(queue, 99), p99, sizeof(p99));
+    log2_hist_format_us(snapshot.latency_max_us, max, sizeof(max));
+    log2_hist_format_us(snapshot.send.blocked_us, send_blocked, sizeof(send_blocked));
+    log2_hist_format_us(snapshot.receive.blocked_us, receive_blocked, sizeof(receive_blocked));
+
+    ESP_LOGI(TAG, "  %-10s %2d/%-2d peak %2d | latency p50 ≤%s p99 ≤%s max %s",
+             snapshot.name, (int)iqueue_waiting(queue), snapshot.length, snapshot.high_water,
+             p50, p99, max);
+    ESP_LOGI(TAG, "  %-10s sent %lu, full %lu (%s, %lu timeouts) | received %lu, empty %lu (%s, %lu timeouts)",
+             "", (unsigned long)snapshot.send.calls - snapshot.send.timeouts,
+             (unsigned long)snapshot.send.blocked, send_blocked, (unsigned long)snapshot.send.timeouts,
+             (unsigned long)snapshot.receive.calls - snapshot.receive.timeouts,
+             (unsigned long)snapshot.receive.blocked, receive_blocked,
+             (unsigned long)snapshot.receive.timeouts);
+}
+
+void iqueue_report_all(void) {
+    ESP_LOGI(TAG, "📏 Queue metrics (blocked time in parentheses):");
+    iqueue_for_each(report_queue, NULL);
+}
@@ -0,0 +1,63 @@
+#ifndef IQUEUE_H
+#define IQUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// Instrumented queue: a FreeRTOS queue whose slots carry a µs enqueue
+// stamp ahead of the item. Senders and receivers use iqueue_send/receive
+// instead of xQueueSend/xQueueReceive and get, with no per-queue setup:
+//   - a log2 histogram of send→receive latency
+//   - the occupancy high-water mark
+//   - how often a call found the queue full/empty and had to block, how
+//     long it blocked in total, and how many of those calls timed out
+// Every queue registers itself on creation, so one iqueue_report_all()
+// (or iqueue_for_each) covers all of them. The underlying handle can be
+// added to a queue set; receive from it with iqueue_receive(..., 0).
+
+#define IQUEUE_MAX_QUEUES       16
+#define IQUEUE_MAX_ITEM_SIZE    128
+#define IQUEUE_LATENCY_BUCKETS  24      // [2^b, 2^(b+1)) µs, the last from ~8 s up
+
+typedef struct {
+    uint32_t calls;
+    uint32_t blocked;               // Had to wait: full for send, empty for receive
+    uint32_t timeouts;              // Gave up without an item/slot
+    uint64_t blocked_us;
+} iqueue_side_stats_t;
+
+typedef struct {
+    const char* name;
+    QueueHandle_t handle;           // Add this one to queue sets
+    uint16_t length;
+    uint16_t item_size;
+    portMUX_TYPE lock;
+
+    // Statistics
+    iqueue_side_stats_t send;
+    iqueue_side_stats_t receive;
+    uint16_t high_water;
+    uint32_t latency_max_us;
+    uint32_t latency_hist[IQUEUE_LATENCY_BUCKETS];
+} iqueue_t;
+
+iqueue_t* iqueue_create(const char* name, UBaseType_t length, UBaseType_t item_size);
+void iqueue_delete(iqueue_t* queue);
+
+bool iqueue_send(iqueue_t* queue, const void* item, TickType_t timeout);
+bool iqueue_receive(iqueue_t* queue, void* item, TickType_t timeout);
+UBaseType_t iqueue_waiting(const iqueue_t* queue);
+
+// Upper bound of the histogram bucket holding the q-th percentile, 0 if empty
+uint32_t iqueue_latency_percentile(iqueue_t* queue, int q);
+
+typedef void (*iqueue_visitor_t)(iqueue_t* queue, void* ctx);
+void iqueue_for_each(iqueue_visitor_t visitor, void* ctx);
+
+// Two lines per registered queue
+void iqueue_report_all(void);
+
+#endif
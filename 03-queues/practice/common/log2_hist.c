@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "log2_hist.h"
+
+int log2_hist_bucket(uint64_t value, int buckets) {
+    int bucket = 0;
+    while (value > 1 && bucket < buckets - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+uint64_t log2_hist_percentile(const uint32_t* hist, int buckets, int q) {
+    uint64_t total = 0;
+    for (int b = 0; b < buckets; b++) total += hist[b];
+    if (total == 0) return 0;
+
+    uint64_t target = (total * q + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < buckets; b++) {
+        seen += hist[b];
+        if (seen >= target) return 1ULL << (b + 1);
+    }
+    return 1ULL << buckets;
+}
+
+void log2_hist_format_us(uint64_t us, char* buf, size_t len) {
+    if (us < 1000) {
+        snprintf(buf, len, "%lluus", (unsigned long long)us);
+    } else if (us < 1000 * 1000) {
+        snprintf(buf, len, "%llums", (unsigned long long)(us / 1000));
+    } else {
+        snprintf(buf, len, "%.1fs", us / 1000000.0);
+    }
+}
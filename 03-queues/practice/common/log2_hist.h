@@ -0,0 +1,20 @@
+#ifndef LOG2_HIST_H
+#define LOG2_HIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Log2-scale histograms for durations and sizes. Bucket b counts values
+// in [2^b, 2^(b+1)); 0 and 1 share bucket 0 and the last bucket also
+// takes everything above its range. A histogram is a plain uint32_t
+// array of `buckets` counters owned (and locked) by the caller.
+
+int log2_hist_bucket(uint64_t value, int buckets);
+
+// Upper bound of the bucket holding the q-th percentile, 0 if empty
+uint64_t log2_hist_percentile(const uint32_t* hist, int buckets, int q);
+
+// "850us", "12ms" or "3.4s"
+void log2_hist_format_us(uint64_t us, char* buf, size_t len);
+
+#endif
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "mailbox.h"
+
+static const char *TAG = "MAILBOX";
+
+bool mailbox_init(mailbox_t* mailbox, size_t size) {
+    memset(mailbox, 0, sizeof(mailbox_t));
+    mailbox->data = heap_caps_calloc(1, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    mailbox->updated = xSemaphoreCreateBinary();
+    if (size == 0 || !mailbox->data || !mailbox->updated) {
+        ESP_LOGE(TAG, "Failed to create %d-byte mailbox", (int)size);
+        mailbox_deinit(mailbox);
+        return false;
+    }
+    mailbox->size = size;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    mailbox->write_lock = unlocked;
+    return true;
+}
+
+void mailbox_deinit(mailbox_t* mailbox) {
+    heap_caps_free(mailbox->data);
+    if (mailbox->updated) vSemaphoreDelete(mailbox->updated);
+    mailbox->data = NULL;
+    mailbox->updated = NULL;
+}
+
+uint32_t mailbox_write(mailbox_t* mailbox, const void* value) {
+    // The critical section keeps the odd window short: nothing on this
+    // core can preempt the copy, readers on the other core retry
+    portENTER_CRITICAL(&mailbox->write_lock);
+    uint32_t seq = atomic_load_explicit(&mailbox->seq, memory_order_relaxed);
+    atomic_store_explicit(&mailbox->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(mailbox->data, value, mailbox->size);
+    mailbox->written_us = (uint32_t)esp_timer_get_time();
+    atomic_store_explicit(&mailbox->seq, seq + 2, memory_order_release);
+    mailbox->writes++;
+    portEXIT_CRITICAL(&mailbox->write_lock);
+
+    // Already given: the pending wakeup covers this write too
+    xSemaphoreGive(mailbox->updated);
+    return (seq + 2) / 2;
+}
+
+uint32_t mailbox_read(mailbox_t* mailbox, void* out, uint32_t* age_us) {
+    uint32_t before, after, written_us;
+    while (1) {
+        before = atomic_load_explicit(&mailbox->seq, memory_order_acquire);
+        if ((before & 1) == 0) {
+            memcpy(out, mailbox->data, mailbox->size);
+            written_us = mailbox->written_us;
+            atomic_thread_fence(memory_order_acquire);
+            after = atomic_load_explicit(&mailbox->seq, memory_order_relaxed);
+            if (after == before) break;
+        }
+        atomic_fetch_add_explicit(&mailbox->read_retries, 1, memory_order_relaxed);
+    }
+    if (age_us) *age_us = before ? (uint32_t)esp_timer_get_time() - written_us : 0;
+    return before / 2;
+}
+
+bool mailbox_read_new(mailbox_t* mailbox, mailbox_reader_t* reader, void* out) {
+    if (mailbox_version(mailbox) == reader->version) {
+        return false;
+    }
+    uint32_t version = mailbox_read(mailbox, out, NULL);
+    if (version == reader->version) {
+        return false;
+    }
+    reader->missed += version - reader->version - 1;
+    reader->version = version;
+    reader->reads++;
+    return true;
+}
+
+uint32_t mailbox_version(mailbox_t* mailbox) {
+    return atomic_load_explicit(&mailbox->seq, memory_order_acquire) / 2;
+}
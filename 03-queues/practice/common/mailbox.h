@@ -0,0 +1,56 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Latest-value mailbox: one slot that every write overwrites, guarded by
+// a sequence lock. The sequence is odd while a write is in progress and
+// its half is the version of the value, so readers copy the slot and
+// retry only if a write overlapped the copy. Writers never wait for
+// readers and any number of readers get a consistent snapshot.
+//
+// A reader that keeps a mailbox_reader_t learns how many versions were
+// overwritten before it looked (missed updates). Each write also gives
+// the binary semaphore `updated`; add it to a queue set to be woken by
+// writes. Bursts of writes collapse into one wakeup.
+
+typedef struct {
+    _Atomic uint32_t seq;
+    uint8_t* data;
+    size_t size;
+    uint32_t written_us;            // esp_timer low 32 bits at the write
+    portMUX_TYPE write_lock;        // Serializes writers only
+    SemaphoreHandle_t updated;
+
+    // Statistics
+    uint32_t writes;
+    _Atomic uint32_t read_retries;
+} mailbox_t;
+
+typedef struct {
+    uint32_t version;               // Last version this reader saw
+    uint32_t reads;
+    uint32_t missed;
+} mailbox_reader_t;
+
+bool mailbox_init(mailbox_t* mailbox, size_t size);
+void mailbox_deinit(mailbox_t* mailbox);
+
+// Never blocks; returns the new version
+uint32_t mailbox_write(mailbox_t* mailbox, const void* value);
+
+// Latest snapshot and its version, 0 if nothing was written yet.
+// age_us may be NULL.
+uint32_t mailbox_read(mailbox_t* mailbox, void* out, uint32_t* age_us);
+
+// Like mailbox_read, but false if the reader already saw the latest version
+bool mailbox_read_new(mailbox_t* mailbox, mailbox_reader_t* reader, void* out);
+
+uint32_t mailbox_version(mailbox_t* mailbox);
+
+#endif
@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "mpmc_queue.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+static const char *TAG = "MPMC_Q";
+
+// Surplus posts only cause spurious wakeups; the cap just bounds them
+#define MPMC_SIGNAL_MAX     0x7FFF
+
+static uint64_t mpmc_now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+// Let an equal-priority peer run before trying again
+static void mpmc_relax(void) {
+    taskYIELD();
+}
+
+static void* mpmc_alloc(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+static void mpmc_free(void* ptr) {
+    heap_caps_free(ptr);
+}
+
+static void* signal_create(void) {
+    return xSemaphoreCreateCounting(MPMC_SIGNAL_MAX, 0);
+}
+
+static void signal_delete(void* signal) {
+    if (signal) vSemaphoreDelete((SemaphoreHandle_t)signal);
+}
+
+static void signal_post(void* signal) {
+    xSemaphoreGive((SemaphoreHandle_t)signal);
+}
+
+static void signal_wait(void* signal, uint32_t timeout_ms) {
+    xSemaphoreTake((SemaphoreHandle_t)signal,
+                   timeout_ms == MPMC_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+}
+#else
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+
+static uint64_t mpmc_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void mpmc_relax(void) {
+    sched_yield();
+}
+
+static void* mpmc_alloc(size_t size) {
+    return malloc(size);
+}
+
+static void mpmc_free(void* ptr) {
+    free(ptr);
+}
+
+static void* signal_create(void) {
+    sem_t* sem = malloc(sizeof(sem_t));
+    if (sem && sem_init(sem, 0, 0) != 0) {
+        free(sem);
+        return NULL;
+    }
+    return sem;
+}
+
+static void signal_delete(void* signal) {
+    if (!signal) return;
+    sem_destroy(signal);
+    free(signal);
+}
+
+static void signal_post(void* signal) {
+    sem_post(signal);
+}
+
+static void signal_wait(void* signal, uint32_t timeout_ms) {
+    if (timeout_ms == MPMC_WAIT_FOREVER) {
+        while (sem_wait(signal) != 0 && errno == EINTR) {}
+        return;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    sem_timedwait(signal, &ts);
+}
+#endif
+
+// Each cell is its sequence number followed by the item, 8-byte aligned
+#define MPMC_SEQ_SIZE   8
+
+// Retries (yielding in between) before a blocking call registers and
+// sleeps; the peer usually frees a slot or delivers an item within a few
+#define MPMC_SPIN_TRIES 16
+
+static inline _Atomic uint32_t* cell_seq(mpmc_queue_t* queue, uint32_t pos) {
+    return (_Atomic uint32_t*)(queue->cells + (pos & queue->mask) * queue->cell_size);
+}
+
+static inline uint8_t* cell_item(mpmc_queue_t* queue, uint32_t pos) {
+    return queue->cells + (pos & queue->mask) * queue->cell_size + MPMC_SEQ_SIZE;
+}
+
+bool mpmc_queue_init(mpmc_queue_t* queue, uint32_t capacity, size_t item_size) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+#ifdef ESP_PLATFORM
+        ESP_LOGE(TAG, "Invalid capacity: %lu (must be a power of 2)", (unsigned long)capacity);
+#endif
+        return false;
+    }
+    memset(queue, 0, sizeof(mpmc_queue_t));
+    queue->item_size = item_size;
+    queue->cell_size = (MPMC_SEQ_SIZE + item_size + 7) & ~(size_t)7;
+    queue->mask = capacity - 1;
+    queue->cells = mpmc_alloc(capacity * queue->cell_size);
+    queue->not_full = signal_create();
+    queue->not_empty = signal_create();
+    if (!queue->cells || !queue->not_full || !queue->not_empty) {
+#ifdef ESP_PLATFORM
+        ESP_LOGE(TAG, "Failed to allocate %lu-slot queue", (unsigned long)capacity);
+#endif
+        mpmc_queue_deinit(queue);
+        return false;
+    }
+
+    // Slot i is ready for the producer of position i
+    for (uint32_t i = 0; i < capacity; i++) {
+        atomic_init(cell_seq(queue, i), i);
+    }
+    return true;
+}
+
+void mpmc_queue_deinit(mpmc_queue_t* queue) {
+    mpmc_free(queue->cells);
+    signal_delete(queue->not_full);
+    signal_delete(queue->not_empty);
+    queue->cells = NULL;
+    queue->not_full = NULL;
+    queue->not_empty = NULL;
+}
+
+bool mpmc_queue_try_push(mpmc_queue_t* queue, const void* item) {
+    uint32_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    while (1) {
+        uint32_t seq = atomic_load_explicit(cell_seq(queue, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;           // Slot still holds last lap's item: full
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(cell_item(queue, pos), item, queue->item_size);
+    atomic_store_explicit(cell_seq(queue, pos), pos + 1, memory_order_release);
+    return true;
+}
+
+bool mpmc_queue_try_pop(mpmc_queue_t* queue, void* item) {
+    uint32_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    while (1) {
+        uint32_t seq = atomic_load_explicit(cell_seq(queue, pos), memory_order_acquire);
+        int32_t diff = (int32_t)(seq - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;           // Not written yet: empty
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+        }
+    }
+    memcpy(item, cell_item(queue, pos), queue->item_size);
+    // Hand the slot to the producer of the next lap
+    atomic_store_explicit(cell_seq(queue, pos), pos + queue->mask + 1, memory_order_release);
+    return true;
+}
+
+// After a successful operation: wake one sleeper on the other side, if
+// any. The fence pairs with the waiter's increment so that either the
+// waiter's re-try sees our item/slot or we see its count.
+static void notify(_Atomic uint32_t* waiting, void* signal) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiting, memory_order_relaxed) > 0) {
+        signal_post(signal);
+    }
+}
+
+typedef bool (*mpmc_op_t)(mpmc_queue_t* queue, void* item);
+
+static bool blocking_op(mpmc_queue_t* queue, mpmc_op_t op, void* item, uint32_t timeout_ms,
+                        _Atomic uint32_t* waiting, void* wait_signal,
+                        _Atomic uint32_t* peer_waiting, void* peer_signal) {
+    for (int i = 0; i <= MPMC_SPIN_TRIES; i++) {
+        if (op(queue, item)) {
+            notify(peer_waiting, peer_signal);
+            return true;
+        }
+        if (timeout_ms == 0) return false;
+        mpmc_relax();
+    }
+
+    uint64_t start = mpmc_now_ms();
+    while (1) {
+        atomic_fetch_add(waiting, 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        bool done = op(queue, item);
+        uint64_t elapsed = mpmc_now_ms() - start;
+        bool expired = timeout_ms != MPMC_WAIT_FOREVER && elapsed >= timeout_ms;
+        if (!done && !expired) {
+            signal_wait(wait_signal, timeout_ms == MPMC_WAIT_FOREVER ?
+                                     MPMC_WAIT_FOREVER : (uint32_t)(timeout_ms - elapsed));
+        }
+        atomic_fetch_sub(waiting, 1);
+
+        if (done) {
+            notify(peer_waiting, peer_signal);
+            return true;
+        }
+        if (expired) return false;
+    }
+}
+
+static bool push_op(mpmc_queue_t* queue, void* item) {
+    return mpmc_queue_try_push(queue, item);
+}
+
+bool mpmc_queue_push(mpmc_queue_t* queue, const void* item, uint32_t timeout_ms) {
+    return blocking_op(queue, push_op, (void*)item, timeout_ms,
+                       &queue->waiting_producers, queue->not_full,
+                       &queue->waiting_consumers, queue->not_empty);
+}
+
+bool mpmc_queue_pop(mpmc_queue_t* queue, void* item, uint32_t timeout_ms) {
+    return blocking_op(queue, mpmc_queue_try_pop, item, timeout_ms,
+                       &queue->waiting_consumers, queue->not_empty,
+                       &queue->waiting_producers, queue->not_full);
+}
+
+uint32_t mpmc_queue_count(mpmc_queue_t* queue) {
+    uint32_t head = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    int32_t count = (int32_t)(tail - head);
+    if (count < 0) return 0;
+    return (uint32_t)count > queue->mask + 1 ? queue->mask + 1 : (uint32_t)count;
+}
+
+#if !defined(ESP_PLATFORM) && !defined(MPMC_QUEUE_NO_MAIN)
+// Host scaling benchmark. The baseline is a ring behind one mutex with
+// two condition variables, which is how a FreeRTOS queue serializes its
+// senders and receivers.
+
+#define BENCH_CAPACITY  256
+#define BENCH_STOP      UINT64_MAX
+
+typedef struct {
+    uint64_t* items;
+    uint32_t head;
+    uint32_t count;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} lock_queue_t;
+
+static void lock_queue_push(lock_queue_t* q, uint64_t item) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == BENCH_CAPACITY) pthread_cond_wait(&q->not_full, &q->lock);
+    q->items[(q->head + q->count++) % BENCH_CAPACITY] = item;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+static uint64_t lock_queue_pop(lock_queue_t* q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) pthread_cond_wait(&q->not_empty, &q->lock);
+    uint64_t item = q->items[q->head];
+    q->head = (q->head + 1) % BENCH_CAPACITY;
+    q->count--;
+    pthread_cond_signal(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return item;
+}
+
+typedef struct {
+    bool lock_free;
+    mpmc_queue_t mpmc;
+    lock_queue_t locked;
+    uint64_t per_producer;
+    _Atomic uint64_t checksum;
+} bench_t;
+
+typedef struct {
+    bench_t* bench;
+    uint64_t first;
+} bench_arg_t;
+
+static void bench_push(bench_t* b, uint64_t item) {
+    if (b->lock_free) mpmc_queue_push(&b->mpmc, &item, MPMC_WAIT_FOREVER);
+    else lock_queue_push(&b->locked, item);
+}
+
+static uint64_t bench_pop(bench_t* b) {
+    uint64_t item;
+    if (b->lock_free) mpmc_queue_pop(&b->mpmc, &item, MPMC_WAIT_FOREVER);
+    else item = lock_queue_pop(&b->locked);
+    return item;
+}
+
+static void* bench_producer(void* arg) {
+    bench_arg_t* a = arg;
+    for (uint64_t i = 0; i < a->bench->per_producer; i++) {
+        bench_push(a->bench, a->first + i);
+    }
+    return NULL;
+}
+
+static void* bench_consumer(void* arg) {
+    bench_arg_t* a = arg;
+    uint64_t sum = 0;
+    while (1) {
+        uint64_t item = bench_pop(a->bench);
+        if (item == BENCH_STOP) break;
+        sum += item;
+    }
+    atomic_fetch_add(&a->bench->checksum, sum);
+    return NULL;
+}
+
+// Returns millions of items per second, 0 if the checksum is wrong
+static double run_bench(bench_t* b, int producers, int consumers, uint64_t items) {
+    pthread_t threads[16];
+    bench_arg_t args[16];
+    b->per_producer = items / producers;
+    atomic_store(&b->checksum, 0);
+
+    uint64_t start = mpmc_now_ms();
+    for (int i = 0; i < consumers; i++) {
+        args[i] = (bench_arg_t){.bench = b};
+        pthread_create(&threads[i], NULL, bench_consumer, &args[i]);
+    }
+    for (int i = 0; i < producers; i++) {
+        args[consumers + i] = (bench_arg_t){.bench = b, .first = i * b->per_producer};
+        pthread_create(&threads[consumers + i], NULL, bench_producer, &args[consumers + i]);
+    }
+    for (int i = 0; i < producers; i++) pthread_join(threads[consumers + i], NULL);
+    for (int i = 0; i < consumers; i++) bench_push(b, BENCH_STOP);
+    for (int i = 0; i < consumers; i++) pthread_join(threads[i], NULL);
+    uint64_t elapsed = mpmc_now_ms() - start;
+
+    uint64_t total = b->per_producer * producers;
+    if (atomic_load(&b->checksum) != total * (total - 1) / 2) return 0;
+    return elapsed ? total / 1000.0 / elapsed : 0;
+}
+
+int main(int argc, char** argv) {
+    uint64_t items = argc > 1 ? strtoull(argv[1], NULL, 10) : 4000000;
+    static const int sizes[] = {1, 2, 4, 8};
+    static bench_t bench;
+
+    bench.locked.items = malloc(BENCH_CAPACITY * sizeof(uint64_t));
+    pthread_mutex_init(&bench.locked.lock, NULL);
+    pthread_cond_init(&bench.locked.not_empty, NULL);
+    pthread_cond_init(&bench.locked.not_full, NULL);
+    if (!bench.locked.items || !mpmc_queue_init(&bench.mpmc, BENCH_CAPACITY, sizeof(uint64_t))) {
+        fprintf(stderr, "allocation failed\n");
+        return 1;
+    }
+
+    printf("%llu items, capacity %d, Mitems/s\n", (unsigned long long)items, BENCH_CAPACITY);
+    printf("  P x C   one lock     mpmc  speedup\n");
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        int n = sizes[i];
+        bench.lock_free = false;
+        double locked = run_bench(&bench, n, n, items);
+        bench.lock_free = true;
+        double lock_free = run_bench(&bench, n, n, items);
+        printf("  %d x %d  %8.2f %8.2f  %6.2fx%s\n", n, n, locked, lock_free,
+               locked > 0 ? lock_free / locked : 0,
+               locked == 0 || lock_free == 0 ? "  (checksum mismatch)" : "");
+    }
+
+    mpmc_queue_deinit(&bench.mpmc);
+    free(bench.locked.items);
+    return 0;
+}
+#endif
@@ -0,0 +1,56 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov): every
+// slot carries a sequence number that says whether it is ready for the
+// producer or the consumer of a given lap. Producers claim a position
+// with one CAS on the enqueue counter, consumers with one CAS on the
+// dequeue counter, so producers never contend with consumers and no
+// operation takes a lock.
+//
+// mpmc_queue_try_push/try_pop never block. mpmc_queue_push/pop try first
+// and only sleep on a counting semaphore when the queue is full/empty;
+// the other side posts it only while someone is registered as waiting.
+//
+// The same file builds on the host for a scaling benchmark against a
+// single-lock queue (the FreeRTOS queue pattern):
+//   gcc -O2 -pthread -o mpmc_queue mpmc_queue.c && ./mpmc_queue [items]
+
+#define MPMC_CACHE_LINE     64
+#define MPMC_WAIT_FOREVER   UINT32_MAX
+
+typedef struct {
+    _Atomic uint32_t enqueue_pos;
+    _Atomic uint32_t waiting_producers;
+    _Atomic uint32_t dequeue_pos __attribute__((aligned(MPMC_CACHE_LINE)));
+    _Atomic uint32_t waiting_consumers;
+
+    // Read-only after init
+    uint8_t* cells __attribute__((aligned(MPMC_CACHE_LINE)));
+    size_t cell_size;               // Sequence number + item, rounded up
+    size_t item_size;
+    uint32_t mask;
+    void* not_full;                 // Counting semaphores
+    void* not_empty;
+} __attribute__((aligned(MPMC_CACHE_LINE))) mpmc_queue_t;
+
+// capacity must be a power of two
+bool mpmc_queue_init(mpmc_queue_t* queue, uint32_t capacity, size_t item_size);
+void mpmc_queue_deinit(mpmc_queue_t* queue);
+
+bool mpmc_queue_try_push(mpmc_queue_t* queue, const void* item);
+bool mpmc_queue_try_pop(mpmc_queue_t* queue, void* item);
+
+// Blocking wrappers; false if the timeout expires first
+bool mpmc_queue_push(mpmc_queue_t* queue, const void* item, uint32_t timeout_ms);
+bool mpmc_queue_pop(mpmc_queue_t* queue, void* item, uint32_t timeout_ms);
+
+// Approximate while producers or consumers are active
+uint32_t mpmc_queue_count(mpmc_queue_t* queue);
+
+#endif
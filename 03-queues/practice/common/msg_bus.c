@@ -0,0 +1,314 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "msg_bus.h"
+
+static const char *TAG = "MSG_BUS";
+
+#define MSG_MAGIC   0x4D53
+
+typedef enum {
+    MSG_FREE = 0,
+    MSG_OWNED,
+    MSG_QUEUED
+} msg_state_t;
+
+typedef struct msg_header {
+    struct msg_header* next_free;
+    msg_pool_t* pool;
+    TaskHandle_t owner;
+    uint16_t magic;
+    uint8_t state;
+} msg_header_t;
+
+// Header rounded up so payloads keep MSG_ALIGNMENT
+#define MSG_HEADER_SIZE ((sizeof(msg_header_t) + MSG_ALIGNMENT - 1) & ~(size_t)(MSG_ALIGNMENT - 1))
+
+struct msg_pool {
+    uint8_t* slab;
+    size_t block_size;              // Header + payload
+    msg_header_t* free_list;
+    msg_pool_stats_t stats;
+    portMUX_TYPE lock;
+};
+
+static inline msg_header_t* header_of(const void* msg) {
+    return (msg_header_t*)((uint8_t*)msg - MSG_HEADER_SIZE);
+}
+
+static inline void* payload_of(msg_header_t* header) {
+    return (uint8_t*)header + MSG_HEADER_SIZE;
+}
+
+msg_pool_t* msg_pool_create(const char* name, size_t payload_size, uint16_t count) {
+    if (payload_size == 0 || payload_size > UINT16_MAX || count == 0) {
+        ESP_LOGE(TAG, "Invalid pool %s: %d × %d bytes", name, count, (int)payload_size);
+        return NULL;
+    }
+    size_t payload = (payload_size + MSG_ALIGNMENT - 1) & ~(size_t)(MSG_ALIGNMENT - 1);
+    size_t block_size = MSG_HEADER_SIZE + payload;
+
+    msg_pool_t* pool = heap_caps_calloc(1, sizeof(msg_pool_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint8_t* slab = heap_caps_malloc(block_size * count, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!pool || !slab) {
+        ESP_LOGE(TAG, "Failed to allocate pool %s (%d bytes)", name, (int)(block_size * count));
+        heap_caps_free(pool);
+        heap_caps_free(slab);
+        return NULL;
+    }
+
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    pool->lock = unlocked;
+    pool->slab = slab;
+    pool->block_size = block_size;
+    pool->stats.name = name;
+    pool->stats.payload_size = payload_size;
+    pool->stats.block_count = count;
+
+    for (int i = count - 1; i >= 0; i--) {
+        msg_header_t* header = (msg_header_t*)(slab + i * block_size);
+        header->pool = pool;
+        header->owner = NULL;
+        header->magic = MSG_MAGIC;
+        header->state = MSG_FREE;
+        header->next_free = pool->free_list;
+        pool->free_list = header;
+    }
+
+    ESP_LOGI(TAG, "✅ Message pool %s: %d × %d bytes", name, count, (int)payload_size);
+    return pool;
+}
+
+bool msg_pool_delete(msg_pool_t* pool) {
+    if (!pool) return false;
+    if (pool->stats.in_use > 0) {
+        ESP_LOGE(TAG, "Pool %s still has %d messages in flight", pool->stats.name, pool->stats.in_use);
+        return false;
+    }
+    heap_caps_free(pool->slab);
+    heap_caps_free(pool);
+    return true;
+}
+
+void* msg_alloc(msg_pool_t* pool) {
+    if (!pool) return NULL;
+
+    portENTER_CRITICAL(&pool->lock);
+    msg_header_t* header = pool->free_list;
+    if (!header) {
+        pool->stats.exhausted++;
+        portEXIT_CRITICAL(&pool->lock);
+        return NULL;
+    }
+    pool->free_list = header->next_free;
+    header->next_free = NULL;
+    header->owner = xTaskGetCurrentTaskHandle();
+    header->state = MSG_OWNED;
+    pool->stats.in_use++;
+    if (pool->stats.in_use > pool->stats.peak_in_use) {
+        pool->stats.peak_in_use = pool->stats.in_use;
+    }
+    pool->stats.allocations++;
+    portEXIT_CRITICAL(&pool->lock);
+
+    return payload_of(header);
+}
+
+static bool valid_message(const void* msg) {
+    if (!msg) return false;
+    const msg_header_t* header = header_of(msg);
+    if (header->magic != MSG_MAGIC || !header->pool) {
+        ESP_LOGE(TAG, "🚨 %p is not a bus message", msg);
+        return false;
+    }
+    return true;
+}
+
+static void report_ownership_error(const char* op, const void* msg, uint8_t state) {
+    static const char* state_names[] = {"free", "owned by another task", "queued"};
+    ESP_LOGE(TAG, "🚨 %s of %p refused: message is %s", op, msg,
+             state < 3 ? state_names[state] : "corrupt");
+}
+
+void msg_release(void* msg) {
+    if (!valid_message(msg)) return;
+    msg_header_t* header = header_of(msg);
+    msg_pool_t* pool = header->pool;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    portENTER_CRITICAL(&pool->lock);
+    uint8_t state = header->state;
+    bool owned = state == MSG_OWNED && header->owner == self;
+    if (owned) {
+        header->state = MSG_FREE;
+        header->owner = NULL;
+        header->next_free = pool->free_list;
+        pool->free_list = header;
+        pool->stats.in_use--;
+    } else {
+        pool->stats.ownership_errors++;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+
+    if (!owned) {
+        report_ownership_error("Release", msg, state);
+    }
+}
+
+size_t msg_payload_size(const void* msg) {
+    if (!valid_message(msg)) return 0;
+    return header_of(msg)->pool->stats.payload_size;
+}
+
+bool msg_bus_init(msg_bus_t* bus, uint16_t depth) {
+    memset(bus, 0, sizeof(msg_bus_t));
+    bus->queue = xQueueCreate(depth, sizeof(void*));
+    if (!bus->queue) {
+        ESP_LOGE(TAG, "Failed to create bus queue");
+        return false;
+    }
+    return true;
+}
+
+bool msg_bus_init_lock_free(msg_bus_t* bus, uint16_t depth) {
+    memset(bus, 0, sizeof(msg_bus_t));
+    uint32_t capacity = 2;
+    while (capacity < depth) capacity *= 2;
+
+    bus->lock_free = heap_caps_aligned_alloc(MPMC_CACHE_LINE, sizeof(mpmc_queue_t),
+                                             MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!bus->lock_free || !mpmc_queue_init(bus->lock_free, capacity, sizeof(void*))) {
+        ESP_LOGE(TAG, "Failed to create lock-free bus queue");
+        heap_caps_free(bus->lock_free);
+        bus->lock_free = NULL;
+        return false;
+    }
+    return true;
+}
+
+static uint32_t ticks_to_ms(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? MPMC_WAIT_FOREVER : pdTICKS_TO_MS(ticks);
+}
+
+static bool transport_send(msg_bus_t* bus, void* msg, TickType_t timeout) {
+    if (bus->lock_free) {
+        return mpmc_queue_push(bus->lock_free, &msg, ticks_to_ms(timeout));
+    }
+    return xQueueSend(bus->queue, &msg, timeout) == pdTRUE;
+}
+
+static bool transport_receive(msg_bus_t* bus, void** msg, TickType_t timeout) {
+    if (bus->lock_free) {
+        return mpmc_queue_pop(bus->lock_free, msg, ticks_to_ms(timeout));
+    }
+    return xQueueReceive(bus->queue, msg, timeout) == pdTRUE;
+}
+
+bool msg_bus_send(msg_bus_t* bus, void* msg, TickType_t timeout) {
+    if (!valid_message(msg)) return false;
+    msg_header_t* header = header_of(msg);
+    msg_pool_t* pool = header->pool;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    // Hand over before the pointer becomes visible to a receiver
+    portENTER_CRITICAL(&pool->lock);
+    uint8_t state = header->state;
+    bool owned = state == MSG_OWNED && header->owner == self;
+    if (owned) {
+        header->state = MSG_QUEUED;
+        header->owner = NULL;
+    } else {
+        pool->stats.ownership_errors++;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+
+    if (!owned) {
+        report_ownership_error("Send", msg, state);
+        return false;
+    }
+
+    if (!transport_send(bus, msg, timeout)) {
+        // Nobody else saw the pointer, so ownership simply returns
+        portENTER_CRITICAL(&pool->lock);
+        header->state = MSG_OWNED;
+        header->owner = self;
+        portEXIT_CRITICAL(&pool->lock);
+        atomic_fetch_add_explicit(&bus->send_failures, 1, memory_order_relaxed);
+        return false;
+    }
+    atomic_fetch_add_explicit(&bus->sent, 1, memory_order_relaxed);
+    return true;
+}
+
+void* msg_bus_receive(msg_bus_t* bus, TickType_t timeout) {
+    void* msg;
+    if (!transport_receive(bus, &msg, timeout)) {
+        return NULL;
+    }
+    msg_header_t* header = header_of(msg);
+    msg_pool_t* pool = header->pool;
+
+    portENTER_CRITICAL(&pool->lock);
+    header->state = MSG_OWNED;
+    header->owner = xTaskGetCurrentTaskHandle();
+    portEXIT_CRITICAL(&pool->lock);
+
+    atomic_fetch_add_explicit(&bus->received, 1, memory_order_relaxed);
+    return msg;
+}
+
+bool msg_bus_consume(msg_bus_t* bus, msg_handler_t handler, void* ctx, TickType_t timeout) {
+    void* msg = msg_bus_receive(bus, timeout);
+    if (!msg) return false;
+    handler(msg, ctx);
+    msg_release(msg);
+    return true;
+}
+
+int msg_bus_drain(msg_bus_t* bus) {
+    int dropped = 0;
+    void* msg;
+    while ((msg = msg_bus_receive(bus, 0)) != NULL) {
+        msg_release(msg);
+        dropped++;
+    }
+    return dropped;
+}
+
+void msg_bus_deinit(msg_bus_t* bus) {
+    if (!bus->queue && !bus->lock_free) return;
+    msg_bus_drain(bus);
+    if (bus->lock_free) {
+        mpmc_queue_deinit(bus->lock_free);
+        heap_caps_free(bus->lock_free);
+        bus->lock_free = NULL;
+    } else {
+        vQueueDelete(bus->queue);
+        bus->queue = NULL;
+    }
+}
+
+uint32_t msg_bus_waiting(msg_bus_t* bus) {
+    if (bus->lock_free) return mpmc_queue_count(bus->lock_free);
+    return uxQueueMessagesWaiting(bus->queue);
+}
+
+void msg_pool_get_stats(const msg_pool_t* pool, msg_pool_stats_t* out) {
+    msg_pool_t* p = (msg_pool_t*)pool;
+    portENTER_CRITICAL(&p->lock);
+    *out = p->stats;
+    portEXIT_CRITICAL(&p->lock);
+}
+
+void msg_pool_print_stats(const msg_pool_t* pool) {
+    msg_pool_stats_t st;
+    msg_pool_get_stats(pool, &st);
+    ESP_LOGI(TAG, "📨 %s: %d/%d in flight (peak %d), %lu allocs, %lu exhausted, %lu ownership errors",
+             st.name, st.in_use, st.block_count, st.peak_in_use, (unsigned long)st.allocations,
+             (unsigned long)st.exhausted, (unsigned long)st.ownership_errors);
+}
@@ -0,0 +1,76 @@
+#ifndef MSG_BUS_H
+#define MSG_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "mpmc_queue.h"
+
+// Zero-copy message passing. Messages live in fixed-size pool blocks and
+// the queue only carries a pointer to them, so a message is written once
+// by its producer and read in place by its consumer, whatever its size.
+//
+// Every message has exactly one owner:
+//   msg_alloc          → the calling task owns it
+//   msg_bus_send       → on success the bus owns it; the sender must not
+//                        touch it again (on failure the sender still does)
+//   msg_bus_receive    → the receiving task owns it until msg_release
+//   msg_bus_consume    → receive, run the handler, release automatically
+// Sending or releasing a message the caller does not own is refused and
+// logged, which catches use-after-send and double release.
+
+#define MSG_ALIGNMENT       8
+
+typedef struct msg_pool msg_pool_t;
+
+typedef struct {
+    const char* name;
+    uint16_t payload_size;
+    uint16_t block_count;
+    uint16_t in_use;
+    uint16_t peak_in_use;
+    uint32_t allocations;
+    uint32_t exhausted;             // msg_alloc calls that found no free block
+    uint32_t ownership_errors;      // Refused sends/releases
+} msg_pool_stats_t;
+
+typedef struct {
+    QueueHandle_t queue;            // Carries msg pointers...
+    mpmc_queue_t* lock_free;        // ...or this, if created with msg_bus_init_lock_free
+    // Updated by every producer and consumer of the bus
+    _Atomic uint32_t sent;
+    _Atomic uint32_t received;
+    _Atomic uint32_t send_failures;
+} msg_bus_t;
+
+// Payload of the handler is released when it returns
+typedef void (*msg_handler_t)(void* msg, void* ctx);
+
+msg_pool_t* msg_pool_create(const char* name, size_t payload_size, uint16_t count);
+// Fails while any message of the pool is still allocated
+bool msg_pool_delete(msg_pool_t* pool);
+void msg_pool_get_stats(const msg_pool_t* pool, msg_pool_stats_t* out);
+void msg_pool_print_stats(const msg_pool_t* pool);
+
+// Returns a payload owned by the caller, NULL if the pool is exhausted
+void* msg_alloc(msg_pool_t* pool);
+void msg_release(void* msg);
+size_t msg_payload_size(const void* msg);
+
+bool msg_bus_init(msg_bus_t* bus, uint16_t depth);
+// Same bus over a lock-free MPMC queue; depth is rounded up to a power of two
+bool msg_bus_init_lock_free(msg_bus_t* bus, uint16_t depth);
+// Releases queued messages and deletes the queue
+void msg_bus_deinit(msg_bus_t* bus);
+bool msg_bus_send(msg_bus_t* bus, void* msg, TickType_t timeout);
+void* msg_bus_receive(msg_bus_t* bus, TickType_t timeout);
+bool msg_bus_consume(msg_bus_t* bus, msg_handler_t handler, void* ctx, TickType_t timeout);
+
+// Releases everything still queued; returns the number of messages dropped
+int msg_bus_drain(msg_bus_t* bus);
+uint32_t msg_bus_waiting(msg_bus_t* bus);
+
+#endif
@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "msg_layout.h"
+
+static const char *TAG = "MSG_LAYOUT";
+
+uint32_t msg_layout_queue_rate(size_t item_size) {
+    uint8_t* item = heap_caps_calloc(1, item_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    QueueHandle_t queue = xQueueCreate(8, item_size);
+    if (item == NULL || queue == NULL) {
+        ESP_LOGE(TAG, "No memory to benchmark %d-byte items", (int)item_size);
+        heap_caps_free(item);
+        if (queue) vQueueDelete(queue);
+        return 0;
+    }
+    uint64_t start = esp_timer_get_time();
+    for (int i = 0; i < LAYOUT_BENCH_MESSAGES; i++) {
+        xQueueSend(queue, item, 0);
+        xQueueReceive(queue, item, 0);
+    }
+    uint64_t elapsed = esp_timer_get_time() - start;
+    vQueueDelete(queue);
+    heap_caps_free(item);
+    return elapsed ? (uint32_t)(LAYOUT_BENCH_MESSAGES * 1000000ULL / elapsed) : 0;
+}
+
+void msg_layout_report(const char* name, size_t legacy_size, size_t compact_size) {
+    uint32_t legacy_rate = msg_layout_queue_rate(legacy_size);
+    uint32_t compact_rate = msg_layout_queue_rate(compact_size);
+    ESP_LOGI(TAG, "📐 %s: %d → %d bytes, %d → %d bytes copied/msg, %lu → %lu msg/s",
+             name, (int)legacy_size, (int)compact_size, (int)(2 * legacy_size), (int)(2 * compact_size),
+             (unsigned long)legacy_rate, (unsigned long)compact_rate);
+}
@@ -0,0 +1,19 @@
+#ifndef MSG_LAYOUT_H
+#define MSG_LAYOUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cost of a message layout on a by-value FreeRTOS queue: every send and
+// every receive copies the whole item, so a round trip moves 2 × size bytes.
+
+#define LAYOUT_BENCH_MESSAGES 2000
+
+// Same-task send/receive round trips per second for items of item_size
+// bytes, 0 if the queue or buffer could not be allocated
+uint32_t msg_layout_queue_rate(size_t item_size);
+
+// Logs both sizes, bytes copied per message and the round-trip rates
+void msg_layout_report(const char* name, size_t legacy_size, size_t compact_size);
+
+#endif
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "spsc_ring.h"
+#include "tick_timeout.h"
+
+static const char *TAG = "SPSC_RING";
+
+bool spsc_ring_init(spsc_ring_t* ring, uint32_t capacity, size_t item_size) {
+    if (capacity == 0 || capacity > (1UL << 31)) {
+        ESP_LOGE(TAG, "Invalid capacity: %lu", (unsigned long)capacity);
+        return false;
+    }
+    // Slots round up to a power of two so indices can be masked
+    uint32_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+
+    memset(ring, 0, sizeof(spsc_ring_t));
+    ring->storage = heap_caps_malloc(slots * item_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!ring->storage) {
+        ESP_LOGE(TAG, "Failed to allocate %lu × %d byte ring", (unsigned long)slots, (int)item_size);
+        return false;
+    }
+    ring->item_size = item_size;
+    ring->capacity = capacity;
+    ring->mask = slots - 1;
+    return true;
+}
+
+void spsc_ring_deinit(spsc_ring_t* ring) {
+    heap_caps_free(ring->storage);
+    ring->storage = NULL;
+}
+
+// Called after publishing an index. The fence pairs with the one in
+// wait_for_peer: either the sleeper sees the new index when it re-checks,
+// or we see its handle here.
+static void wake_peer(_Atomic(TaskHandle_t)* waiting) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiting, memory_order_relaxed) != NULL) {
+        TaskHandle_t task = atomic_exchange(waiting, NULL);
+        if (task) xTaskNotifyGive(task);
+    }
+}
+
+// Slow path: announce ourselves, re-check the peer's index, then sleep
+// until it moves. Returns false on timeout.
+static bool wait_for_peer(spsc_ring_t* ring, bool producer, uint32_t own_index, TickType_t timeout) {
+    _Atomic(TaskHandle_t)* waiting = producer ? &ring->producer_waiting : &ring->consumer_waiting;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    TickType_t start = xTaskGetTickCount();
+
+    while (1) {
+        atomic_store(waiting, self);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        bool ready;
+        if (producer) {
+            ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+            ready = own_index - ring->cached_head < ring->capacity;
+        } else {
+            ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+            ready = ring->cached_tail != own_index;
+        }
+        TickType_t left = ready ? 0 : tick_timeout_left(start, timeout);
+        if (ready || left == 0) {
+            atomic_store(waiting, NULL);
+            return ready;
+        }
+
+        if (producer) ring->full_waits++;
+        else ring->empty_waits++;
+        // A stale notification only costs one extra pass round the loop
+        ulTaskNotifyTake(pdTRUE, left);
+    }
+}
+
+bool spsc_ring_push(spsc_ring_t* ring, const void* item, TickType_t timeout) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - ring->cached_head >= ring->capacity) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head >= ring->capacity &&
+            (timeout == 0 || !wait_for_peer(ring, true, tail, timeout))) {
+            return false;
+        }
+    }
+    memcpy(ring->storage + (tail & ring->mask) * ring->item_size, item, ring->item_size);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    wake_peer(&ring->consumer_waiting);
+    return true;
+}
+
+bool spsc_ring_pop(spsc_ring_t* ring, void* item, TickType_t timeout) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == ring->cached_tail) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail &&
+            (timeout == 0 || !wait_for_peer(ring, false, head, timeout))) {
+            return false;
+        }
+    }
+    memcpy(item, ring->storage + (head & ring->mask) * ring->item_size, ring->item_size);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    wake_peer(&ring->producer_waiting);
+    return true;
+}
+
+uint32_t spsc_ring_count(spsc_ring_t* ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    // The monitor may read between the two loads; never report more than fits
+    return tail - head < ring->capacity ? tail - head : ring->capacity;
+}
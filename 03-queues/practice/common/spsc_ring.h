@@ -0,0 +1,61 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Lock-free ring for exactly one producer task and one consumer task.
+// Push and pop never take a lock or enter a critical section: each side
+// owns one index, publishes it with a release store and only reads the
+// other side's index when its cached copy says the ring is full/empty.
+// The fast path is wait-free; a side blocks on its direct task
+// notification only when the ring is full (producer) or empty (consumer),
+// and the other side wakes it after its next push/pop.
+//
+// Producer and consumer state sit on separate cache lines so the two
+// cores do not bounce one line between them. Declare rings static (or
+// allocate them SPSC_CACHE_LINE-aligned) to keep that layout.
+//
+// The ring uses the default notification slot of both tasks; do not mix
+// it with other ulTaskNotifyTake users in the same task.
+
+#define SPSC_CACHE_LINE     64
+
+typedef struct {
+    // Producer side
+    _Atomic uint32_t tail;
+    uint32_t cached_head;
+    uint32_t full_waits;
+    _Atomic(TaskHandle_t) producer_waiting;
+
+    // Consumer side
+    _Atomic uint32_t head __attribute__((aligned(SPSC_CACHE_LINE)));
+    uint32_t cached_tail;
+    uint32_t empty_waits;
+    _Atomic(TaskHandle_t) consumer_waiting;
+
+    // Read-only after init
+    uint8_t* storage __attribute__((aligned(SPSC_CACHE_LINE)));
+    size_t item_size;
+    uint32_t capacity;              // Items the ring accepts
+    uint32_t mask;                  // Slots (capacity rounded up to a power of two) - 1
+} __attribute__((aligned(SPSC_CACHE_LINE))) spsc_ring_t;
+
+// Any capacity works; a power of two wastes no slots
+bool spsc_ring_init(spsc_ring_t* ring, uint32_t capacity, size_t item_size);
+void spsc_ring_deinit(spsc_ring_t* ring);
+
+// Producer only; false if still full when the timeout expires
+bool spsc_ring_push(spsc_ring_t* ring, const void* item, TickType_t timeout);
+
+// Consumer only; false if still empty when the timeout expires
+bool spsc_ring_pop(spsc_ring_t* ring, void* item, TickType_t timeout);
+
+// Snapshot, exact only when called from one of the two sides
+uint32_t spsc_ring_count(spsc_ring_t* ring);
+
+#endif
@@ -0,0 +1,9 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "tick_timeout.h"
+
+TickType_t tick_timeout_left(TickType_t start, TickType_t timeout) {
+    if (timeout == portMAX_DELAY) return portMAX_DELAY;
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+}
@@ -0,0 +1,11 @@
+#ifndef TICK_TIMEOUT_H
+#define TICK_TIMEOUT_H
+
+#include "freertos/FreeRTOS.h"
+
+// Remaining part of a timeout that started at tick `start`, for blocking
+// calls that retry after a wakeup: 0 once it has run out, portMAX_DELAY
+// stays portMAX_DELAY. Tick wraparound is handled.
+TickType_t tick_timeout_left(TickType_t start, TickType_t timeout);
+
+#endif
@@ -0,0 +1,497 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "work_steal.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+static const char *TAG = "WORK_STEAL";
+
+static void* ws_alloc(size_t size) {
+    return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+static void ws_free(void* ptr) {
+    heap_caps_free(ptr);
+}
+
+// Binary: several posts while the worker runs collapse into one wakeup
+static void* signal_create(void) {
+    return xSemaphoreCreateBinary();
+}
+
+static void signal_delete(void* signal) {
+    if (signal) vSemaphoreDelete((SemaphoreHandle_t)signal);
+}
+
+static void signal_post(void* signal) {
+    xSemaphoreGive((SemaphoreHandle_t)signal);
+}
+
+static void signal_wait(void* signal) {
+    xSemaphoreTake((SemaphoreHandle_t)signal, portMAX_DELAY);
+}
+#else
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+static void* ws_alloc(size_t size) {
+    return malloc(size);
+}
+
+static void ws_free(void* ptr) {
+    free(ptr);
+}
+
+static void* signal_create(void) {
+    sem_t* sem = malloc(sizeof(sem_t));
+    if (sem && sem_init(sem, 0, 0) != 0) {
+        free(sem);
+        return NULL;
+    }
+    return sem;
+}
+
+static void signal_delete(void* signal) {
+    if (!signal) return;
+    sem_destroy(signal);
+    free(signal);
+}
+
+static void signal_post(void* signal) {
+    sem_post(signal);
+}
+
+static void signal_wait(void* signal) {
+    while (sem_wait(signal) != 0 && errno == EINTR) {}
+}
+#endif
+
+// Refills never exceed WS_REFILL_BATCH, so the deques stay small
+#define WS_DEQUE_DEPTH      8
+
+// ═══ Chase-Lev deque ═══
+// Orderings follow Lê et al., "Correct and Efficient Work-Stealing for
+// Weak Memory Models". Indices are free-running and compared by signed
+// difference, so they may wrap.
+
+bool ws_deque_init(ws_deque_t* deque, uint32_t capacity) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    memset(deque, 0, sizeof(ws_deque_t));
+    deque->slots = ws_alloc(capacity * sizeof(deque->slots[0]));
+    if (!deque->slots) {
+        return false;
+    }
+    for (uint32_t i = 0; i < capacity; i++) {
+        atomic_init(&deque->slots[i], NULL);
+    }
+    deque->mask = capacity - 1;
+    return true;
+}
+
+void ws_deque_deinit(ws_deque_t* deque) {
+    ws_free((void*)deque->slots);
+    deque->slots = NULL;
+}
+
+bool ws_deque_push(ws_deque_t* deque, void* job) {
+    uint32_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if ((int32_t)(b - t) > (int32_t)deque->mask) {
+        return false;
+    }
+    atomic_store_explicit(&deque->slots[b & deque->mask], job, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    return true;
+}
+
+void* ws_deque_pop(ws_deque_t* deque) {
+    uint32_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if ((int32_t)(b - t) < 0) {
+        // Empty: undo the claim
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+    void* job = atomic_load_explicit(&deque->slots[b & deque->mask], memory_order_relaxed);
+    if (b == t) {
+        // Last job: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            job = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+void* ws_deque_steal(ws_deque_t* deque) {
+    uint32_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if ((int32_t)(b - t) <= 0) {
+        return NULL;
+    }
+    void* job = atomic_load_explicit(&deque->slots[t & deque->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL;
+    }
+    return job;
+}
+
+// ═══ Executor ═══
+
+bool ws_executor_init(ws_executor_t* executor, int workers, uint32_t inbox_depth,
+                      ws_job_fn_t run, void* ctx) {
+    if (workers < 1 || workers > WS_MAX_WORKERS) {
+#ifdef ESP_PLATFORM
+        ESP_LOGE(TAG, "Invalid worker count: %d (1-%d)", workers, WS_MAX_WORKERS);
+#endif
+        return false;
+    }
+    memset(executor, 0, sizeof(ws_executor_t));
+    executor->worker_count = workers;
+    executor->run = run;
+    executor->ctx = ctx;
+    executor->stealing = true;
+
+    for (int i = 0; i < workers; i++) {
+        ws_worker_t* worker = &executor->workers[i];
+        worker->executor = executor;
+        worker->index = i;
+        worker->wake = signal_create();
+        if (!worker->wake ||
+            !mpmc_queue_init(&worker->inbox, inbox_depth, sizeof(void*)) ||
+            !ws_deque_init(&worker->deque, WS_DEQUE_DEPTH)) {
+#ifdef ESP_PLATFORM
+            ESP_LOGE(TAG, "Failed to allocate worker %d", i);
+#endif
+            ws_executor_deinit(executor);
+            return false;
+        }
+    }
+    return true;
+}
+
+void ws_executor_deinit(ws_executor_t* executor) {
+    for (int i = 0; i < executor->worker_count; i++) {
+        ws_worker_t* worker = &executor->workers[i];
+        mpmc_queue_deinit(&worker->inbox);
+        ws_deque_deinit(&worker->deque);
+        signal_delete(worker->wake);
+        worker->wake = NULL;
+    }
+}
+
+static bool has_work(ws_worker_t* worker) {
+    ws_deque_t* deque = &worker->deque;
+    uint32_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    uint32_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    return (int32_t)(b - t) > 0 || mpmc_queue_count(&worker->inbox) > 0;
+}
+
+// After new work appears on target: wake it if it sleeps, otherwise wake
+// one sleeping worker that can steal. The fence pairs with the one in
+// ws_executor_work: either the sleeper's last scan sees the job or we
+// see its sleeping flag.
+static void wake_for(ws_executor_t* executor, ws_worker_t* target) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&target->sleeping, memory_order_relaxed)) {
+        signal_post(target->wake);
+        return;
+    }
+    if (!executor->stealing) {
+        return;
+    }
+    for (int i = 1; i < executor->worker_count; i++) {
+        ws_worker_t* other = &executor->workers[(target->index + i) % executor->worker_count];
+        if (atomic_load_explicit(&other->sleeping, memory_order_relaxed)) {
+            signal_post(other->wake);
+            return;
+        }
+    }
+}
+
+bool ws_executor_submit_to(ws_executor_t* executor, int worker, void* job, uint32_t timeout_ms) {
+    ws_worker_t* target = &executor->workers[worker % executor->worker_count];
+    if (!mpmc_queue_push(&target->inbox, &job, timeout_ms)) {
+        return false;
+    }
+    wake_for(executor, target);
+    return true;
+}
+
+bool ws_executor_submit(ws_executor_t* executor, void* job, uint32_t timeout_ms) {
+    uint32_t worker = atomic_fetch_add_explicit(&executor->next_worker, 1, memory_order_relaxed);
+    return ws_executor_submit_to(executor, worker % executor->worker_count, job, timeout_ms);
+}
+
+// Moves a batch from the inbox to the deque in reverse, so the owner
+// (popping the bottom) runs it in submission order and thieves take the
+// newest first
+static void refill(ws_worker_t* worker) {
+    void* batch[WS_REFILL_BATCH];
+    int n = 0;
+    while (n < WS_REFILL_BATCH && mpmc_queue_try_pop(&worker->inbox, &batch[n])) {
+        n++;
+    }
+    while (n > 0) {
+        ws_deque_push(&worker->deque, batch[--n]);
+    }
+}
+
+static void* find_job(ws_executor_t* executor, ws_worker_t* self) {
+    void* job = ws_deque_pop(&self->deque);
+    if (job) return job;
+    refill(self);
+    job = ws_deque_pop(&self->deque);
+    if (job || !executor->stealing) return job;
+
+    // Deques first: those jobs were taken by a busy worker
+    for (int i = 1; i < executor->worker_count; i++) {
+        ws_worker_t* victim = &executor->workers[(self->index + i) % executor->worker_count];
+        job = ws_deque_steal(&victim->deque);
+        if (job) break;
+    }
+    for (int i = 1; job == NULL && i < executor->worker_count; i++) {
+        ws_worker_t* victim = &executor->workers[(self->index + i) % executor->worker_count];
+        if (!mpmc_queue_try_pop(&victim->inbox, &job)) job = NULL;
+    }
+    if (job) self->stolen++;
+    return job;
+}
+
+static bool any_work(ws_executor_t* executor, ws_worker_t* self) {
+    if (!executor->stealing) return has_work(self);
+    for (int i = 0; i < executor->worker_count; i++) {
+        if (has_work(&executor->workers[i])) return true;
+    }
+    return false;
+}
+
+void ws_executor_work(ws_executor_t* executor, int worker) {
+    ws_worker_t* self = &executor->workers[worker];
+    while (1) {
+        void* job = find_job(executor, self);
+        if (job) {
+            executor->run(job, executor->ctx);
+            self->executed++;
+            continue;
+        }
+
+        atomic_store_explicit(&self->sleeping, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        bool stopping = atomic_load_explicit(&executor->stopping, memory_order_relaxed);
+        bool work = any_work(executor, self);
+        if (!work && !stopping) {
+            self->sleeps++;
+            signal_wait(self->wake);
+        }
+        atomic_store_explicit(&self->sleeping, 0, memory_order_relaxed);
+        if (stopping && !work) return;
+    }
+}
+
+void ws_executor_stop(ws_executor_t* executor) {
+    atomic_store(&executor->stopping, true);
+    for (int i = 0; i < executor->worker_count; i++) {
+        signal_post(executor->workers[i].wake);
+    }
+}
+
+#ifndef ESP_PLATFORM
+// Host benchmark: W workers run jobs whose durations are skewed (most
+// short, a few 50x longer), fed either through one shared lock-protected
+// queue (the xQueue pattern), through per-worker queues without stealing,
+// or through the work-stealing executor. Each design runs saturated for
+// throughput and then paced at ~70% load for completion latency.
+
+#define BENCH_MAX_JOBS      20000
+#define BENCH_SHORT_US      20
+#define BENCH_LONG_US       1000
+#define BENCH_LONG_PERCENT  5
+
+typedef struct {
+    uint64_t submitted_us;
+    uint32_t work_us;
+} bench_job_t;
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void spin_us(uint32_t us) {
+    uint64_t end = now_us() + us;
+    while (now_us() < end) {}
+}
+
+typedef struct {
+    bench_job_t jobs[BENCH_MAX_JOBS];
+    uint32_t latency_us[BENCH_MAX_JOBS];
+    _Atomic uint32_t done;
+} bench_run_t;
+
+static bench_run_t run_state;
+
+static void run_job(void* job, void* ctx) {
+    (void)ctx;
+    bench_job_t* j = job;
+    spin_us(j->work_us);
+    uint32_t slot = atomic_fetch_add(&run_state.done, 1);
+    run_state.latency_us[slot] = (uint32_t)(now_us() - j->submitted_us);
+}
+
+// Shared queue baseline: one mutex, two condition variables
+typedef struct {
+    void* items[BENCH_MAX_JOBS];
+    uint32_t head, tail;
+    bool stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+} shared_queue_t;
+
+static shared_queue_t shared = {
+    .lock = PTHREAD_MUTEX_INITIALIZER, .not_empty = PTHREAD_COND_INITIALIZER
+};
+
+static void shared_submit(void* job) {
+    pthread_mutex_lock(&shared.lock);
+    shared.items[shared.tail++] = job;
+    pthread_cond_signal(&shared.not_empty);
+    pthread_mutex_unlock(&shared.lock);
+}
+
+static void* shared_worker(void* arg) {
+    (void)arg;
+    while (1) {
+        pthread_mutex_lock(&shared.lock);
+        while (shared.head == shared.tail && !shared.stopping) {
+            pthread_cond_wait(&shared.not_empty, &shared.lock);
+        }
+        if (shared.head == shared.tail) {
+            pthread_mutex_unlock(&shared.lock);
+            return NULL;
+        }
+        void* job = shared.items[shared.head++];
+        pthread_mutex_unlock(&shared.lock);
+        run_job(job, NULL);
+    }
+}
+
+static ws_executor_t executor;
+
+typedef struct {
+    int index;
+} ws_arg_t;
+
+static void* ws_worker(void* arg) {
+    ws_executor_work(&executor, ((ws_arg_t*)arg)->index);
+    return NULL;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+typedef enum { DESIGN_SHARED, DESIGN_NO_STEAL, DESIGN_STEAL } design_t;
+
+static const char* const design_names[] = {"shared queue", "per-worker, no steal", "work stealing"};
+
+// gap_us 0 = submit as fast as possible
+static void run_design(design_t design, int workers, uint32_t jobs, uint32_t gap_us,
+                       double* jobs_per_s, uint32_t* p50, uint32_t* p99) {
+    pthread_t threads[WS_MAX_WORKERS];
+    ws_arg_t args[WS_MAX_WORKERS];
+    atomic_store(&run_state.done, 0);
+    srand(1);
+    for (uint32_t i = 0; i < jobs; i++) {
+        run_state.jobs[i].work_us = (rand() % 100 < BENCH_LONG_PERCENT) ? BENCH_LONG_US : BENCH_SHORT_US;
+    }
+
+    if (design == DESIGN_SHARED) {
+        shared.head = shared.tail = 0;
+        shared.stopping = false;
+    } else {
+        ws_executor_init(&executor, workers, 1024, run_job, NULL);
+        executor.stealing = design == DESIGN_STEAL;
+    }
+    for (int i = 0; i < workers; i++) {
+        args[i].index = i;
+        pthread_create(&threads[i], NULL, design == DESIGN_SHARED ? shared_worker : ws_worker, &args[i]);
+    }
+
+    uint64_t start = now_us();
+    for (uint32_t i = 0; i < jobs; i++) {
+        if (gap_us) {
+            while (now_us() < start + (uint64_t)i * gap_us) {}
+        }
+        run_state.jobs[i].submitted_us = now_us();
+        if (design == DESIGN_SHARED) shared_submit(&run_state.jobs[i]);
+        else ws_executor_submit(&executor, &run_state.jobs[i], MPMC_WAIT_FOREVER);
+    }
+    if (design == DESIGN_SHARED) {
+        pthread_mutex_lock(&shared.lock);
+        shared.stopping = true;
+        pthread_cond_broadcast(&shared.not_empty);
+        pthread_mutex_unlock(&shared.lock);
+    } else {
+        ws_executor_stop(&executor);
+    }
+    for (int i = 0; i < workers; i++) pthread_join(threads[i], NULL);
+    uint64_t elapsed = now_us() - start;
+    if (design != DESIGN_SHARED) ws_executor_deinit(&executor);
+
+    uint32_t done = atomic_load(&run_state.done);
+    qsort(run_state.latency_us, done, sizeof(uint32_t), compare_u32);
+    *jobs_per_s = elapsed ? done * 1e6 / elapsed : 0;
+    *p50 = done ? run_state.latency_us[done / 2] : 0;
+    *p99 = done ? run_state.latency_us[(uint64_t)done * 99 / 100] : 0;
+    if (done != jobs) printf("  !! %s lost jobs: %u of %u\n", design_names[design], done, jobs);
+}
+
+int main(int argc, char** argv) {
+    uint32_t jobs = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : 4000;
+    if (jobs > BENCH_MAX_JOBS) jobs = BENCH_MAX_JOBS;
+    static const int sizes[] = {2, 4};
+    double mean_us = (BENCH_LONG_PERCENT * BENCH_LONG_US + (100 - BENCH_LONG_PERCENT) * BENCH_SHORT_US) / 100.0;
+
+    printf("Jobs: %u, %d%% x %dus, rest %dus (mean %.0fus)\n",
+           jobs, BENCH_LONG_PERCENT, BENCH_LONG_US, BENCH_SHORT_US, mean_us);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int workers = sizes[s];
+        // Paced at ~70% of what the workers can do on this machine
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        int parallel = cpus > 0 && cpus < workers ? (int)cpus : workers;
+        uint32_t gap_us = (uint32_t)(mean_us / parallel / 0.7);
+        printf("\n%d workers           saturated jobs/s   paced(gap %uus) p50 / p99 us\n", workers, gap_us);
+        for (int d = DESIGN_SHARED; d <= DESIGN_STEAL; d++) {
+            double rate, unused;
+            uint32_t p50, p99, u50, u99;
+            run_design(d, workers, jobs, 0, &rate, &u50, &u99);
+            run_design(d, workers, jobs, gap_us, &unused, &p50, &p99);
+            printf("  %-22s %10.0f   %10u / %u\n", design_names[d], rate, p50, p99);
+        }
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,88 @@
+#ifndef WORK_STEAL_H
+#define WORK_STEAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "mpmc_queue.h"
+
+// Work-stealing executor. Every worker owns a Chase-Lev deque: the owner
+// pushes and pops at the bottom without contention, idle workers steal
+// from the top with one CAS. Submitters cannot touch a deque (it has a
+// single owner), so each worker also has an MPMC inbox; the owner moves
+// up to WS_REFILL_BATCH jobs from it into its deque whenever the deque
+// runs dry, and thieves that find every deque empty pop inboxes directly.
+// A worker stuck on a long job therefore never holds up more than the
+// batch it took, and even that is stolen by whoever goes idle.
+//
+// The executor does not create tasks: call ws_executor_work() from one
+// task (or thread) per worker. The same file builds on the host for a
+// benchmark against a shared single-lock queue on skewed job durations:
+//   gcc -O2 -pthread -DMPMC_QUEUE_NO_MAIN -o work_steal work_steal.c mpmc_queue.c && ./work_steal
+
+#define WS_MAX_WORKERS      8
+#define WS_REFILL_BATCH     4
+
+// Chase-Lev deque of job pointers; capacity is a power of two
+typedef struct {
+    _Atomic uint32_t top;                       // Thieves
+    _Atomic uint32_t bottom __attribute__((aligned(MPMC_CACHE_LINE)));  // Owner
+    _Atomic(void*)* slots __attribute__((aligned(MPMC_CACHE_LINE)));
+    uint32_t mask;
+} ws_deque_t;
+
+bool ws_deque_init(ws_deque_t* deque, uint32_t capacity);
+void ws_deque_deinit(ws_deque_t* deque);
+
+// Owner only; push returns false when full, pop NULL when empty
+bool ws_deque_push(ws_deque_t* deque, void* job);
+void* ws_deque_pop(ws_deque_t* deque);
+
+// Any worker; NULL when empty or when another thief won the race
+void* ws_deque_steal(ws_deque_t* deque);
+
+typedef void (*ws_job_fn_t)(void* job, void* ctx);
+
+typedef struct ws_executor ws_executor_t;
+
+typedef struct {
+    mpmc_queue_t inbox;             // Submissions for this worker
+    ws_deque_t deque;
+    ws_executor_t* executor;
+    void* wake;                     // Posted when work may be available
+    _Atomic uint32_t sleeping;
+    int index;
+
+    // Statistics, written by the worker only
+    uint32_t executed;
+    uint32_t stolen;
+    uint32_t sleeps;
+} ws_worker_t;
+
+// Embeds the queues; allocate statically or with an aligned allocator
+struct ws_executor {
+    ws_worker_t workers[WS_MAX_WORKERS];
+    int worker_count;
+    ws_job_fn_t run;
+    void* ctx;
+    bool stealing;                  // false = plain per-worker queues
+    _Atomic uint32_t next_worker;
+    _Atomic bool stopping;
+};
+
+bool ws_executor_init(ws_executor_t* executor, int workers, uint32_t inbox_depth,
+                      ws_job_fn_t run, void* ctx);
+void ws_executor_deinit(ws_executor_t* executor);
+
+// Round-robin over the workers
+bool ws_executor_submit(ws_executor_t* executor, void* job, uint32_t timeout_ms);
+
+// Affinity: queue on a given worker (others may still steal it)
+bool ws_executor_submit_to(ws_executor_t* executor, int worker, void* job, uint32_t timeout_ms);
+
+// Worker loop; returns once ws_executor_stop() was called and no work is left
+void ws_executor_work(ws_executor_t* executor, int worker);
+void ws_executor_stop(ws_executor_t* executor);
+
+#endif
@@ -6,19 +6,63 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
+#include "esp_timer.h"
+#include "spsc_ring.h"
+#include "msg_layout.h"
 
 static const char *TAG = "QUEUE_LAB";
 
 #define LED_SENDER GPIO_NUM_2
 #define LED_RECEIVER GPIO_NUM_4
 
+// Sender → receiver is a strict single-producer/single-consumer link, so
+// it can run over the lock-free ring instead of a FreeRTOS queue
+#define USE_SPSC_RING           1
+#define LINK_DEPTH              5
+#define SPSC_BENCH_MESSAGES     20000
+
 QueueHandle_t xQueue;
+static spsc_ring_t link_ring;
 
+// Widest field first, id wraps at 65535; "Hello from sender #65535" fits
+typedef struct {
+    uint32_t timestamp;
+    uint16_t id;
+    char message[26];
+} queue_message_t;
+
+_Static_assert(sizeof(queue_message_t) <= 32, "queue_message_t exceeds its 32-byte budget");
+
+// Original layout, kept for the layout benchmark
 typedef struct {
     int id;
     char message[50];
     uint32_t timestamp;
-} queue_message_t;
+} queue_message_legacy_t;
+
+static bool link_send(const queue_message_t* message, TickType_t timeout) {
+#if USE_SPSC_RING
+    return spsc_ring_push(&link_ring, message, timeout);
+#else
+    return xQueueSend(xQueue, message, timeout) == pdPASS;
+#endif
+}
+
+static bool link_receive(queue_message_t* message, TickType_t timeout) {
+#if USE_SPSC_RING
+    return spsc_ring_pop(&link_ring, message, timeout);
+#else
+    return xQueueReceive(xQueue, message, timeout) == pdPASS;
+#endif
+}
+
+static UBaseType_t link_waiting(void) {
+#if USE_SPSC_RING
+    return spsc_ring_count(&link_ring);
+#else
+    return uxQueueMessagesWaiting(xQueue);
+#endif
+}
 
 void sender_task(void *pvParameters) {
     queue_message_t message;
@@ -30,8 +74,7 @@ void sender_task(void *pvParameters) {
         message.timestamp = xTaskGetTickCount();
 
         // --- Default blocking send ---
-        BaseType_t xStatus = xQueueSend(xQueue, &message, pdMS_TO_TICKS(1000));
-        if (xStatus == pdPASS) {
+        if (link_send(&message, pdMS_TO_TICKS(1000))) {
             ESP_LOGI(TAG, "Sent: ID=%d", message.id);
             gpio_set_level(LED_SENDER, 1);
             vTaskDelay(pdMS_TO_TICKS(100));
@@ -45,7 +88,7 @@ void sender_task(void *pvParameters) {
         */
 
         /* --- Customization: Non-blocking send (Queue Overflow Protection) ---
-        if (xQueueSend(xQueue, &message, 0) != pdPASS) {
+        if (!link_send(&message, 0)) {
             ESP_LOGW(TAG, "Queue full! Dropping message ID=%d", message.id);
         }
         */
@@ -60,8 +103,7 @@ void receiver_task(void *pvParameters) {
     while (1) {
 
         // --- Default blocking receive ---
-        BaseType_t xStatus = xQueueReceive(xQueue, &received_message, pdMS_TO_TICKS(5000));
-        if (xStatus == pdPASS) {
+        if (link_receive(&received_message, pdMS_TO_TICKS(5000))) {
             ESP_LOGI(TAG, "Received: ID=%d", received_message.id);
             gpio_set_level(LED_RECEIVER, 1);
             vTaskDelay(pdMS_TO_TICKS(200));
@@ -76,7 +118,7 @@ void receiver_task(void *pvParameters) {
         */
 
         /* --- Customization: Non-blocking receive ---
-        if (xQueueReceive(xQueue, &received_message, 0) == pdPASS) {
+        if (link_receive(&received_message, 0)) {
             ESP_LOGI(TAG, "Received: ID=%d", received_message.id);
         } else {
             ESP_LOGI(TAG, "No message available, doing other work...");
@@ -91,11 +133,11 @@ void queue_monitor_task(void *pvParameters) {
     UBaseType_t uxSpacesAvailable;
     ESP_LOGI(TAG, "Queue monitor task started");
     while (1) {
-        uxMessagesWaiting = uxQueueMessagesWaiting(xQueue);
-        uxSpacesAvailable = uxQueueSpacesAvailable(xQueue);
+        uxMessagesWaiting = link_waiting();
+        uxSpacesAvailable = LINK_DEPTH - uxMessagesWaiting;
         ESP_LOGI(TAG, "Queue Status - Messages: %d, Free spaces: %d", uxMessagesWaiting, uxSpacesAvailable);
         printf("Queue: [\n");
-        for (int i = 0; i < 5; i++) {
+        for (int i = 0; i < LINK_DEPTH; i++) {
             if (i < uxMessagesWaiting) {
                 printf("■");
             } else {
@@ -107,15 +149,116 @@ void queue_monitor_task(void *pvParameters) {
     }
 }
 
+typedef struct {
+    bool use_ring;
+    QueueHandle_t queue;
+    spsc_ring_t* ring;
+    uint64_t elapsed_us;
+    TaskHandle_t caller;
+    TaskHandle_t sender;
+    TaskHandle_t receiver;
+} spsc_bench_t;
+
+static void spsc_bench_sender(void *pvParameters) {
+    spsc_bench_t* bench = pvParameters;
+    queue_message_t message = {0};
+    for (int i = 0; i < SPSC_BENCH_MESSAGES; i++) {
+        message.id = i;
+        if (bench->use_ring) spsc_ring_push(bench->ring, &message, portMAX_DELAY);
+        else xQueueSend(bench->queue, &message, portMAX_DELAY);
+    }
+    vTaskSuspend(NULL); // Deleted by measure_link_streaming
+}
+
+static void spsc_bench_receiver(void *pvParameters) {
+    spsc_bench_t* bench = pvParameters;
+    queue_message_t message;
+    uint64_t start = esp_timer_get_time();
+    for (int i = 0; i < SPSC_BENCH_MESSAGES; i++) {
+        if (bench->use_ring) spsc_ring_pop(bench->ring, &message, portMAX_DELAY);
+        else xQueueReceive(bench->queue, &message, portMAX_DELAY);
+    }
+    bench->elapsed_us = esp_timer_get_time() - start;
+    xTaskNotifyGive(bench->caller);
+    vTaskSuspend(NULL); // Deleted by measure_link_streaming
+}
+
+// Streams messages between two tasks of equal priority, one per core
+// where there are two, so both the fast path and the blocking path count
+static uint32_t measure_link_streaming(bool use_ring) {
+    static spsc_ring_t ring;
+    static spsc_bench_t bench;
+    bench = (spsc_bench_t){.use_ring = use_ring, .ring = &ring, .caller = xTaskGetCurrentTaskHandle()};
+    if (use_ring) {
+        if (!spsc_ring_init(&ring, LINK_DEPTH, sizeof(queue_message_t))) return 0;
+    } else {
+        bench.queue = xQueueCreate(LINK_DEPTH, sizeof(queue_message_t));
+        if (!bench.queue) return 0;
+    }
+
+    xTaskCreatePinnedToCore(spsc_bench_receiver, "SpscRx", 2048, &bench, 5, &bench.receiver, 0);
+    xTaskCreatePinnedToCore(spsc_bench_sender, "SpscTx", 2048, &bench, 5, &bench.sender, portNUM_PROCESSORS - 1);
+    bool done = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10000)) > 0;
+    if (!done) {
+        ESP_LOGE(TAG, "Link benchmark did not finish");
+    }
+
+    // Both tasks park instead of exiting, so their handles stay valid here
+    // even on a timeout; stop both before either can be deleted, since one
+    // may still notify the other through the link
+    if (bench.sender) vTaskSuspend(bench.sender);
+    if (bench.receiver) vTaskSuspend(bench.receiver);
+    if (bench.sender) vTaskDelete(bench.sender);
+    if (bench.receiver) vTaskDelete(bench.receiver);
+
+    if (use_ring) spsc_ring_deinit(&ring);
+    else vQueueDelete(bench.queue);
+    if (!done) return 0;
+    return bench.elapsed_us ? (uint32_t)(SPSC_BENCH_MESSAGES * 1000000ULL / bench.elapsed_us) : 0;
+}
+
+// Same-task round trips isolate the per-operation cost
+static uint32_t measure_ring_round_trips(void) {
+    static spsc_ring_t ring;
+    queue_message_t message = {0};
+    if (!spsc_ring_init(&ring, LINK_DEPTH, sizeof(queue_message_t))) return 0;
+    uint64_t start = esp_timer_get_time();
+    for (int i = 0; i < LAYOUT_BENCH_MESSAGES; i++) {
+        spsc_ring_push(&ring, &message, 0);
+        spsc_ring_pop(&ring, &message, 0);
+    }
+    uint64_t elapsed = esp_timer_get_time() - start;
+    spsc_ring_deinit(&ring);
+    return elapsed ? (uint32_t)(LAYOUT_BENCH_MESSAGES * 1000000ULL / elapsed) : 0;
+}
+
+static void report_spsc_benchmark(void) {
+    uint32_t queue_trip = msg_layout_queue_rate(sizeof(queue_message_t));
+    uint32_t ring_trip = measure_ring_round_trips();
+    uint32_t queue_stream = measure_link_streaming(false);
+    uint32_t ring_stream = measure_link_streaming(true);
+    ESP_LOGI(TAG, "🔁 xQueue vs SPSC ring (%d-byte messages, depth %d):",
+             (int)sizeof(queue_message_t), LINK_DEPTH);
+    ESP_LOGI(TAG, "  round trip: %6lu → %6lu msg/s", (unsigned long)queue_trip, (unsigned long)ring_trip);
+    ESP_LOGI(TAG, "  streaming:  %6lu → %6lu msg/s", (unsigned long)queue_stream, (unsigned long)ring_stream);
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "Basic Queue Operations Lab Starting...");
     gpio_set_direction(LED_SENDER, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_RECEIVER, GPIO_MODE_OUTPUT);
     gpio_set_level(LED_SENDER, 0);
     gpio_set_level(LED_RECEIVER, 0);
-    xQueue = xQueueCreate(5, sizeof(queue_message_t));
-    if (xQueue != NULL) {
-        ESP_LOGI(TAG, "Queue created successfully (size: 5 messages)");
+    msg_layout_report("queue_message_t", sizeof(queue_message_legacy_t), sizeof(queue_message_t));
+    report_spsc_benchmark();
+#if USE_SPSC_RING
+    bool link_ready = spsc_ring_init(&link_ring, LINK_DEPTH, sizeof(queue_message_t));
+#else
+    xQueue = xQueueCreate(LINK_DEPTH, sizeof(queue_message_t));
+    bool link_ready = xQueue != NULL;
+#endif
+    if (link_ready) {
+        ESP_LOGI(TAG, "Queue created successfully (size: %d messages)", LINK_DEPTH);
         xTaskCreate(sender_task, "Sender", 2048, NULL, 2, NULL);
         xTaskCreate(receiver_task, "Receiver", 2048, NULL, 1, NULL);
         xTaskCreate(queue_monitor_task, "Monitor", 2048, NULL, 1, NULL);
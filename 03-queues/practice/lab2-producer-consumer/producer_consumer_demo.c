@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
@@ -9,6 +10,12 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "msg_bus.h"
+#include "batch_queue.h"
+#include "work_steal.h"
+#include "msg_layout.h"
 
 static const char *TAG = "PROD_CONS";
 
@@ -18,7 +25,59 @@ static const char *TAG = "PROD_CONS";
 #define LED_CONSUMER_1 GPIO_NUM_18
 #define LED_CONSUMER_2 GPIO_NUM_19
 
-QueueHandle_t xProductQueue;
+// Products travel by pointer: the bus queue holds PRODUCT_QUEUE_DEPTH
+// pointers and the pool also covers one product in hand per producer and
+// one being processed per consumer (CONSUMER_POOL_MAX of them). The depth is a power of two so both
+// bus transports hold the same number of products.
+#define PRODUCT_QUEUE_DEPTH     16
+#define PRODUCT_POOL_SIZE       24
+#define BUS_BENCH_MAX_PAYLOAD   4096
+
+// With one queue lock, all three producers and both consumers serialize
+// on it. Over the lock-free bus, producers only race each other for a
+// slot and consumers only race each other for an item.
+#define USE_LOCK_FREE_BUS       1
+
+// Batch-size sweep: one producer hands products to one higher-priority
+// consumer, per item through xQueue or in batches through batch_queue
+#define BATCH_BENCH_ITEMS       4000
+#define BATCH_BENCH_MAX         16
+#define BATCH_BENCH_DEPTH       32
+
+// Work-stealing comparison: WS_BENCH_WORKERS workers spread over both
+// cores run CPU-bound jobs with skewed processing times, fed through one
+// shared xQueue of pointers (the product bus design), through per-worker
+// queues, or through the work-stealing executor. Each runs saturated for
+// throughput, then paced by an esp_timer at ~70% load for completion
+// latency. Processing times are in µs so the comparison fits in startup.
+#define WS_BENCH_JOBS           400
+#define WS_BENCH_WORKERS        4
+#define WS_BENCH_INBOX_DEPTH    128
+#define WS_BENCH_SHORT_US       100
+#define WS_BENCH_LONG_US        5000
+#define WS_BENCH_LONG_PERCENT   10
+
+// Elastic consumer pool: CONSUMER_POOL_MAX workers are created up front on
+// static stacks; the first CONSUMER_POOL_MIN run and the rest stay parked
+// on a task notification until the load balancer needs them. Scaling up
+// takes the backlog or the product wait above its high mark for
+// SCALE_UP_CHECKS checks in a row, scaling down takes both below their
+// low marks for SCALE_DOWN_CHECKS checks. Each change starts a cooldown,
+// so the pool does not flap around a threshold.
+#define CONSUMER_POOL_MIN       2
+#define CONSUMER_POOL_MAX       5
+#define CONSUMER_STACK_SIZE     3072
+#define SCALE_CHECK_MS          1000
+#define SCALE_UP_BACKLOG        8
+#define SCALE_DOWN_BACKLOG      2
+#define SCALE_UP_WAIT_MS        3000
+#define SCALE_DOWN_WAIT_MS      1000
+#define SCALE_UP_CHECKS         2
+#define SCALE_DOWN_CHECKS       5
+#define SCALE_COOLDOWN_CHECKS   3
+
+msg_bus_t product_bus;
+msg_pool_t* product_pool;
 SemaphoreHandle_t xPrintMutex;
 
 typedef struct {
@@ -29,13 +88,25 @@ typedef struct {
 
 stats_t global_stats = {0, 0, 0};
 
+// Reordered by size with narrow ids; "Product-P3-#65535" fits the name
+typedef struct {
+    uint32_t production_time;       // Tick count
+    uint16_t product_id;
+    uint16_t processing_time_ms;
+    uint8_t producer_id;
+    char product_name[19];
+} product_t;
+
+_Static_assert(sizeof(product_t) <= 28, "product_t exceeds its 28-byte budget");
+
+// Original layout, kept for the layout benchmark
 typedef struct {
     int producer_id;
     int product_id;
     char product_name[30];
     uint32_t production_time;
     int processing_time_ms;
-} product_t;
+} product_legacy_t;
 
 void safe_printf(const char* format, ...) {
     va_list args;
@@ -49,7 +120,6 @@ void safe_printf(const char* format, ...) {
 
 void producer_task(void *pvParameters) {
     int producer_id = *((int*)pvParameters);
-    product_t product;
     int product_counter = 0;
     gpio_num_t led_pin;
     switch (producer_id) {
@@ -60,55 +130,118 @@ void producer_task(void *pvParameters) {
     }
     safe_printf("Producer %d started\n", producer_id);
     while (1) {
-        product.producer_id = producer_id;
-        product.product_id = product_counter++;
-        snprintf(product.product_name, sizeof(product.product_name), "Product-P%d-#%d", producer_id, product.product_id);
-        product.production_time = xTaskGetTickCount();
-        product.processing_time_ms = 500 + (esp_random() % 2000);
-        if (xQueueSend(xProductQueue, &product, pdMS_TO_TICKS(100)) == pdPASS) {
+        uint16_t product_id = product_counter++;
+        uint16_t processing_time_ms = 500 + (esp_random() % 2000);
+        product_t* product = msg_alloc(product_pool);
+        if (product == NULL) {
+            global_stats.dropped++;
+            safe_printf("✗ Producer %d: Pool exhausted! Dropped product #%d\n", producer_id, product_id);
+            vTaskDelay(pdMS_TO_TICKS(1000 + (esp_random() % 2000)));
+            continue;
+        }
+        // Written once, in place; consumers read this same buffer
+        product->producer_id = producer_id;
+        product->product_id = product_id;
+        snprintf(product->product_name, sizeof(product->product_name), "Product-P%d-#%d", producer_id, product_id);
+        product->production_time = xTaskGetTickCount();
+        product->processing_time_ms = processing_time_ms;
+        // After a successful send the product belongs to the bus: log from the locals
+        if (msg_bus_send(&product_bus, product, pdMS_TO_TICKS(100))) {
             global_stats.produced++;
-            safe_printf("✓ Producer %d: Created %s (processing: %dms)\n", producer_id, product.product_name, product.processing_time_ms);
+            safe_printf("✓ Producer %d: Created Product-P%d-#%d (processing: %dms)\n", producer_id, producer_id, product_id, processing_time_ms);
             gpio_set_level(led_pin, 1);
             vTaskDelay(pdMS_TO_TICKS(50));
             gpio_set_level(led_pin, 0);
         } else {
             global_stats.dropped++;
-            safe_printf("✗ Producer %d: Queue full! Dropped %s\n", producer_id, product.product_name);
+            safe_printf("✗ Producer %d: Queue full! Dropped %s\n", producer_id, product->product_name);
+            msg_release(product);
         }
         vTaskDelay(pdMS_TO_TICKS(1000 + (esp_random() % 2000)));
     }
 }
 
-void consumer_task(void *pvParameters) {
-    int consumer_id = *((int*)pvParameters);
-    product_t product;
+typedef struct {
+    int consumer_id;
     gpio_num_t led_pin;
-    switch (consumer_id) {
-        case 1: led_pin = LED_CONSUMER_1; break;
-        case 2: led_pin = LED_CONSUMER_2; break;
-        default: led_pin = LED_CONSUMER_1;
+    TaskHandle_t handle;
+    volatile bool parked;
+} consumer_ctx_t;
+
+typedef struct {
+    volatile int active;            // Consumers 1..active take products
+    _Atomic uint32_t max_wait_ms;   // Longest queue time since the last check
+    uint32_t scale_ups;
+    uint32_t scale_downs;
+    int peak_active;
+} consumer_pool_t;
+
+static consumer_ctx_t consumers[CONSUMER_POOL_MAX];
+static StaticTask_t consumer_tcbs[CONSUMER_POOL_MAX];
+static StackType_t consumer_stacks[CONSUMER_POOL_MAX][CONSUMER_STACK_SIZE] __attribute__((aligned(8)));
+static consumer_pool_t consumer_pool = {.active = CONSUMER_POOL_MIN, .peak_active = CONSUMER_POOL_MIN};
+
+// Works on the product in place; msg_bus_consume releases it afterwards
+static void process_product(void* msg, void* ctx) {
+    const product_t* product = msg;
+    const consumer_ctx_t* consumer = ctx;
+    global_stats.consumed++;
+    uint32_t queue_time = xTaskGetTickCount() - product->production_time;
+    uint32_t wait_ms = queue_time * portTICK_PERIOD_MS;
+    uint32_t max_wait = atomic_load_explicit(&consumer_pool.max_wait_ms, memory_order_relaxed);
+    while (wait_ms > max_wait &&
+           !atomic_compare_exchange_weak_explicit(&consumer_pool.max_wait_ms, &max_wait, wait_ms,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
     }
-    safe_printf("Consumer %d started\n", consumer_id);
+    safe_printf("→ Consumer %d: Processing %s (queue time: %lums)\n", consumer->consumer_id, product->product_name, wait_ms);
+    gpio_set_level(consumer->led_pin, 1);
+    vTaskDelay(pdMS_TO_TICKS(product->processing_time_ms));
+    gpio_set_level(consumer->led_pin, 0);
+    safe_printf("✓ Consumer %d: Finished %s\n", consumer->consumer_id, product->product_name);
+}
+
+void consumer_task(void *pvParameters) {
+    consumer_ctx_t* ctx = pvParameters;
+    safe_printf("Consumer %d started\n", ctx->consumer_id);
     while (1) {
-        if (xQueueReceive(xProductQueue, &product, pdMS_TO_TICKS(5000)) == pdPASS) {
-            global_stats.consumed++;
-            uint32_t queue_time = xTaskGetTickCount() - product.production_time;
-            safe_printf("→ Consumer %d: Processing %s (queue time: %lums)\n", consumer_id, product.product_name, queue_time * portTICK_PERIOD_MS);
-            gpio_set_level(led_pin, 1);
-            vTaskDelay(pdMS_TO_TICKS(product.processing_time_ms));
-            gpio_set_level(led_pin, 0);
-            safe_printf("✓ Consumer %d: Finished %s\n", consumer_id, product.product_name);
-        } else {
-            safe_printf("⏰ Consumer %d: No products to process (timeout)\n", consumer_id);
+        // Outside the active set: finish nothing new, sleep until scaled up
+        if (ctx->consumer_id > consumer_pool.active) {
+            ctx->parked = true;
+            safe_printf("💤 Consumer %d parked\n", ctx->consumer_id);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            ctx->parked = false;
+            continue;
+        }
+        if (!msg_bus_consume(&product_bus, process_product, ctx, pdMS_TO_TICKS(5000))) {
+            safe_printf("⏰ Consumer %d: No products to process (timeout)\n", ctx->consumer_id);
+        }
+    }
+}
+
+// Creates every consumer from the static set; those above
+// CONSUMER_POOL_MIN park right away
+static bool consumer_pool_start(void) {
+    for (int i = 0; i < CONSUMER_POOL_MAX; i++) {
+        consumer_ctx_t* ctx = &consumers[i];
+        char task_name[16];
+        ctx->consumer_id = i + 1;
+        ctx->led_pin = (i % 2 == 0) ? LED_CONSUMER_1 : LED_CONSUMER_2;
+        snprintf(task_name, sizeof(task_name), "Consumer%d", ctx->consumer_id);
+        ctx->handle = xTaskCreateStatic(consumer_task, task_name, CONSUMER_STACK_SIZE, ctx, 2,
+                                        consumer_stacks[i], &consumer_tcbs[i]);
+        if (ctx->handle == NULL) {
+            ESP_LOGE(TAG, "Failed to create consumer %d", ctx->consumer_id);
+            return false;
         }
     }
+    return true;
 }
 
 void statistics_task(void *pvParameters) {
     UBaseType_t queue_items;
     safe_printf("Statistics task started\n");
     while (1) {
-        queue_items = uxQueueMessagesWaiting(xProductQueue);
+        queue_items = msg_bus_waiting(&product_bus);
         safe_printf("\n═══ SYSTEM STATISTICS ═══\n");
         safe_printf("Products Produced: %lu\n", global_stats.produced);
         safe_printf("Products Consumed: %lu\n", global_stats.consumed);
@@ -116,23 +249,63 @@ void statistics_task(void *pvParameters) {
         safe_printf("Queue Backlog:     %d\n", queue_items);
         safe_printf("System Efficiency: %.1f%%\n", global_stats.produced > 0 ? (float)global_stats.consumed / global_stats.produced * 100 : 0);
         printf("Queue: [");
-        for (int i = 0; i < 10; i++) {
+        for (int i = 0; i < PRODUCT_QUEUE_DEPTH; i++) {
             if (i < queue_items) printf("■");
             else printf("□");
         }
         printf("]\n");
+        int parked = 0;
+        for (int i = 0; i < CONSUMER_POOL_MAX; i++) {
+            if (consumers[i].parked) parked++;
+        }
+        safe_printf("Consumers:         %d active, %d parked (min %d, max %d, peak %d)\n",
+                    consumer_pool.active, parked, CONSUMER_POOL_MIN, CONSUMER_POOL_MAX, consumer_pool.peak_active);
+        safe_printf("Scaling Events:    %lu up, %lu down\n",
+                    (unsigned long)consumer_pool.scale_ups, (unsigned long)consumer_pool.scale_downs);
+        msg_pool_print_stats(product_pool);
         safe_printf("═══════════════════════════\n\n");
         vTaskDelay(pdMS_TO_TICKS(5000));
     }
 }
 
 void load_balancer_task(void *pvParameters) {
-    const int MAX_QUEUE_SIZE = 8;
-    safe_printf("Load balancer started\n");
+    int up_checks = 0, down_checks = 0, cooldown = 0;
+    safe_printf("Load balancer started (%d-%d consumers)\n", CONSUMER_POOL_MIN, CONSUMER_POOL_MAX);
     while (1) {
-        UBaseType_t queue_items = uxQueueMessagesWaiting(xProductQueue);
-        if (queue_items > MAX_QUEUE_SIZE) {
-            safe_printf("⚠️  HIGH LOAD DETECTED! Queue size: %d\n", queue_items);
+        vTaskDelay(pdMS_TO_TICKS(SCALE_CHECK_MS));
+        uint32_t queue_items = msg_bus_waiting(&product_bus);
+        uint32_t wait_ms = atomic_exchange_explicit(&consumer_pool.max_wait_ms, 0, memory_order_relaxed);
+
+        bool high = queue_items >= SCALE_UP_BACKLOG || wait_ms >= SCALE_UP_WAIT_MS;
+        bool low = queue_items <= SCALE_DOWN_BACKLOG && wait_ms <= SCALE_DOWN_WAIT_MS;
+        up_checks = high ? up_checks + 1 : 0;
+        down_checks = low ? down_checks + 1 : 0;
+        if (cooldown > 0) {
+            cooldown--;
+            continue;
+        }
+
+        int active = consumer_pool.active;
+        if (up_checks >= SCALE_UP_CHECKS && active < CONSUMER_POOL_MAX) {
+            consumer_pool.active = active + 1;
+            consumer_pool.scale_ups++;
+            if (active + 1 > consumer_pool.peak_active) consumer_pool.peak_active = active + 1;
+            xTaskNotifyGive(consumers[active].handle);
+            safe_printf("📈 Scaling up to %d consumers (backlog %lu, wait %lums)\n",
+                        active + 1, (unsigned long)queue_items, (unsigned long)wait_ms);
+            up_checks = 0;
+            cooldown = SCALE_COOLDOWN_CHECKS;
+        } else if (down_checks >= SCALE_DOWN_CHECKS && active > CONSUMER_POOL_MIN) {
+            // The consumer parks once its current product is done
+            consumer_pool.active = active - 1;
+            consumer_pool.scale_downs++;
+            safe_printf("📉 Scaling down to %d consumers (backlog %lu, wait %lums)\n",
+                        active - 1, (unsigned long)queue_items, (unsigned long)wait_ms);
+            down_checks = 0;
+            cooldown = SCALE_COOLDOWN_CHECKS;
+        } else if (high && active == CONSUMER_POOL_MAX) {
+            safe_printf("⚠️  HIGH LOAD DETECTED at %d consumers! Queue size: %lu\n",
+                        active, (unsigned long)queue_items);
             gpio_set_level(LED_PRODUCER_1, 1);
             gpio_set_level(LED_PRODUCER_2, 1);
             gpio_set_level(LED_PRODUCER_3, 1);
@@ -145,7 +318,322 @@ void load_balancer_task(void *pvParameters) {
             gpio_set_level(LED_CONSUMER_1, 0);
             gpio_set_level(LED_CONSUMER_2, 0);
         }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
+
+// Same round trips, but only a pointer crosses the queue: the producer
+// fills a pool message in place and the receiver reads it in place
+static uint32_t measure_bus_throughput(size_t payload_size) {
+    msg_bus_t bus;
+    msg_pool_t* pool = msg_pool_create("bench", payload_size, 2);
+    if (pool == NULL || !msg_bus_init(&bus, 8)) {
+        if (pool) msg_pool_delete(pool);
+        return 0;
+    }
+    uint64_t start = esp_timer_get_time();
+    for (int i = 0; i < LAYOUT_BENCH_MESSAGES; i++) {
+        uint32_t* msg = msg_alloc(pool);
+        msg[0] = i;
+        msg_bus_send(&bus, msg, 0);
+        msg = msg_bus_receive(&bus, 0);
+        msg_release(msg);
+    }
+    uint64_t elapsed = esp_timer_get_time() - start;
+    msg_bus_deinit(&bus);
+    msg_pool_delete(pool);
+    return elapsed ? (uint32_t)(LAYOUT_BENCH_MESSAGES * 1000000ULL / elapsed) : 0;
+}
+
+static void report_bus_throughput(void) {
+    static const size_t payload_sizes[] = {16, 64, 256, 1024, BUS_BENCH_MAX_PAYLOAD};
+    ESP_LOGI(TAG, "📨 By-value queue vs message bus (%d round trips):", LAYOUT_BENCH_MESSAGES);
+    for (int i = 0; i < sizeof(payload_sizes) / sizeof(payload_sizes[0]); i++) {
+        size_t size = payload_sizes[i];
+        uint32_t by_value = msg_layout_queue_rate(size);
+        uint32_t by_pointer = measure_bus_throughput(size);
+        ESP_LOGI(TAG, "  %4d B: %6lu msg/s by value, %6lu msg/s on the bus (%.1fx)",
+                 (int)size, (unsigned long)by_value, (unsigned long)by_pointer,
+                 by_value ? (float)by_pointer / by_value : 0);
+    }
+}
+
+typedef struct {
+    int batch;                      // 0 = plain xQueueSend/xQueueReceive
+    QueueHandle_t xqueue;
+    batch_queue_t queue;
+    uint64_t start_us;
+    uint64_t elapsed_us;
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+    TaskHandle_t caller;
+    TaskHandle_t producer;
+    TaskHandle_t consumer;
+} batch_bench_t;
+
+// production_time carries an esp_timer stamp in µs here, not ticks
+static void batch_bench_producer(void *pvParameters) {
+    batch_bench_t* bench = pvParameters;
+    product_t products[BATCH_BENCH_MAX];
+    int per_send = bench->batch ? bench->batch : 1;
+
+    for (int sent = 0; sent < BATCH_BENCH_ITEMS; sent += per_send) {
+        int n = BATCH_BENCH_ITEMS - sent < per_send ? BATCH_BENCH_ITEMS - sent : per_send;
+        for (int i = 0; i < n; i++) {
+            products[i].producer_id = 0;
+            products[i].product_id = sent + i;
+            products[i].processing_time_ms = 0;
+            snprintf(products[i].product_name, sizeof(products[i].product_name), "Product-P0-#%d", sent + i);
+            products[i].production_time = (uint32_t)esp_timer_get_time();
+        }
+        if (bench->batch) {
+            queue_send_batch(&bench->queue, products, n, portMAX_DELAY);
+        } else {
+            xQueueSend(bench->xqueue, &products[0], portMAX_DELAY);
+        }
+    }
+    vTaskSuspend(NULL); // Deleted by run_batch_benchmark
+}
+
+static void batch_bench_consumer(void *pvParameters) {
+    batch_bench_t* bench = pvParameters;
+    product_t products[BATCH_BENCH_MAX];
+
+    for (int received = 0; received < BATCH_BENCH_ITEMS; ) {
+        int n;
+        if (bench->batch) {
+            n = queue_receive_batch(&bench->queue, products, bench->batch, portMAX_DELAY);
+        } else {
+            n = xQueueReceive(bench->xqueue, &products[0], portMAX_DELAY) == pdTRUE ? 1 : 0;
+        }
+        uint32_t now = (uint32_t)esp_timer_get_time();
+        for (int i = 0; i < n; i++) {
+            uint32_t latency = now - products[i].production_time;
+            bench->latency_sum_us += latency;
+            if (latency > bench->latency_max_us) bench->latency_max_us = latency;
+        }
+        received += n;
+    }
+    bench->elapsed_us = esp_timer_get_time() - bench->start_us;
+    xTaskNotifyGive(bench->caller);
+    vTaskSuspend(NULL); // Deleted by run_batch_benchmark
+}
+
+static bool run_batch_benchmark(batch_bench_t* bench, int batch) {
+    memset(bench, 0, sizeof(batch_bench_t));
+    bench->batch = batch;
+    bench->caller = xTaskGetCurrentTaskHandle();
+    if (batch) {
+        if (!batch_queue_init(&bench->queue, BATCH_BENCH_DEPTH, sizeof(product_t))) return false;
+    } else {
+        bench->xqueue = xQueueCreate(BATCH_BENCH_DEPTH, sizeof(product_t));
+        if (!bench->xqueue) return false;
+    }
+
+    bench->start_us = esp_timer_get_time();
+    xTaskCreate(batch_bench_consumer, "BatchCons", 3072, bench, 5, &bench->consumer);
+    xTaskCreate(batch_bench_producer, "BatchProd", 3072, bench, 4, &bench->producer);
+    bool done = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(10000)) > 0;
+    if (!done) {
+        ESP_LOGE(TAG, "Batch benchmark (batch %d) did not finish", batch);
+    }
+
+    // Both tasks park instead of exiting; stop both before deleting either
+    // so neither can wake the other through the queue mid-teardown
+    if (bench->producer) vTaskSuspend(bench->producer);
+    if (bench->consumer) vTaskSuspend(bench->consumer);
+    if (bench->producer) vTaskDelete(bench->producer);
+    if (bench->consumer) vTaskDelete(bench->consumer);
+
+    if (batch) {
+        batch_queue_deinit(&bench->queue);
+    } else {
+        vQueueDelete(bench->xqueue);
+    }
+    return done;
+}
+
+static void report_batch_sweep(void) {
+    static const int batch_sizes[] = {0, 1, 2, 4, 8, BATCH_BENCH_MAX};
+    static batch_bench_t bench;
+    ESP_LOGI(TAG, "📦 Batch size sweep (%d products, depth %d):", BATCH_BENCH_ITEMS, BATCH_BENCH_DEPTH);
+    for (int i = 0; i < sizeof(batch_sizes) / sizeof(batch_sizes[0]); i++) {
+        if (!run_batch_benchmark(&bench, batch_sizes[i])) return;
+        // xQueue wakes the consumer for every item it was blocked on
+        char label[12], wakeups[16];
+        if (bench.batch) {
+            snprintf(label, sizeof(label), "batch %2d", bench.batch);
+            snprintf(wakeups, sizeof(wakeups), "%lu", (unsigned long)bench.queue.wakeups);
+        } else {
+            snprintf(label, sizeof(label), "xQueue");
+            snprintf(wakeups, sizeof(wakeups), "per item");
+        }
+        ESP_LOGI(TAG, "  %-8s: %6lu items/s, latency avg %lu µs, max %lu µs, wakeups %s",
+                 label, (unsigned long)(BATCH_BENCH_ITEMS * 1000000ULL / bench.elapsed_us),
+                 (unsigned long)(bench.latency_sum_us / BATCH_BENCH_ITEMS),
+                 (unsigned long)bench.latency_max_us, wakeups);
+    }
+}
+
+typedef enum {
+    WS_DESIGN_SHARED,
+    WS_DESIGN_PER_WORKER,
+    WS_DESIGN_STEALING
+} ws_design_t;
+
+typedef struct {
+    uint32_t submitted_us;
+    uint16_t processing_time_us;
+} ws_bench_job_t;
+
+typedef struct {
+    ws_executor_t executor;
+    ws_design_t design;
+    QueueHandle_t shared;
+    SemaphoreHandle_t finished;
+    ws_bench_job_t jobs[WS_BENCH_JOBS];
+    uint32_t latency_us[WS_BENCH_JOBS];
+    _Atomic uint32_t done;
+    _Atomic uint32_t next_job;
+} ws_bench_t;
+
+static ws_bench_t ws_bench;
+
+static void ws_bench_run_job(void* job, void* ctx) {
+    ws_bench_job_t* j = job;
+    esp_rom_delay_us(j->processing_time_us);
+    uint32_t slot = atomic_fetch_add(&ws_bench.done, 1);
+    ws_bench.latency_us[slot] = (uint32_t)esp_timer_get_time() - j->submitted_us;
+}
+
+// Both queue designs hold every job, so a submit never has to wait
+static void ws_bench_submit(ws_bench_job_t* job) {
+    job->submitted_us = (uint32_t)esp_timer_get_time();
+    if (ws_bench.design == WS_DESIGN_SHARED) {
+        xQueueSend(ws_bench.shared, &job, 0);
+    } else {
+        ws_executor_submit(&ws_bench.executor, job, 0);
+    }
+}
+
+static void ws_bench_tick(void* arg) {
+    uint32_t i = atomic_fetch_add(&ws_bench.next_job, 1);
+    if (i < WS_BENCH_JOBS) ws_bench_submit(&ws_bench.jobs[i]);
+}
+
+static void ws_bench_worker(void *pvParameters) {
+    int index = (int)(intptr_t)pvParameters;
+    if (ws_bench.design == WS_DESIGN_SHARED) {
+        ws_bench_job_t* job;
+        while (xQueueReceive(ws_bench.shared, &job, portMAX_DELAY) == pdTRUE && job != NULL) {
+            ws_bench_run_job(job, NULL);
+        }
+    } else {
+        ws_executor_work(&ws_bench.executor, index);
+    }
+    xSemaphoreGive(ws_bench.finished);
+    vTaskDelete(NULL);
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// gap_us 0 = submit every job at once; results in jobs/s and µs
+static bool run_ws_benchmark(ws_design_t design, uint32_t gap_us, uint32_t* jobs_per_s,
+                             uint32_t* p50_us, uint32_t* p99_us, uint32_t* stolen) {
+    ws_bench.design = design;
+    atomic_store(&ws_bench.done, 0);
+    atomic_store(&ws_bench.next_job, 0);
+    // Every tenth job (spread evenly) is 50x longer than the rest
+    for (int i = 0; i < WS_BENCH_JOBS; i++) {
+        bool long_job = (i * 7919) % 100 < WS_BENCH_LONG_PERCENT;
+        ws_bench.jobs[i].processing_time_us = long_job ? WS_BENCH_LONG_US : WS_BENCH_SHORT_US;
+    }
+
+    ws_bench.finished = xSemaphoreCreateCounting(WS_BENCH_WORKERS, 0);
+    bool ready;
+    if (design == WS_DESIGN_SHARED) {
+        ws_bench.shared = xQueueCreate(WS_BENCH_JOBS + WS_BENCH_WORKERS, sizeof(ws_bench_job_t*));
+        ready = ws_bench.shared != NULL;
+    } else {
+        ready = ws_executor_init(&ws_bench.executor, WS_BENCH_WORKERS, WS_BENCH_INBOX_DEPTH,
+                                 ws_bench_run_job, NULL);
+        ws_bench.executor.stealing = design == WS_DESIGN_STEALING;
+    }
+    if (!ready || !ws_bench.finished) {
+        ESP_LOGE(TAG, "Work-stealing benchmark setup failed");
+        return false;
+    }
+    for (int i = 0; i < WS_BENCH_WORKERS; i++) {
+        xTaskCreatePinnedToCore(ws_bench_worker, "WsWorker", 3072, (void*)(intptr_t)i, 5, NULL, i % portNUM_PROCESSORS);
+    }
+
+    uint64_t start = esp_timer_get_time();
+    if (gap_us == 0) {
+        // Above the workers, so the burst is queued before they drain it
+        UBaseType_t priority = uxTaskPriorityGet(NULL);
+        vTaskPrioritySet(NULL, 6);
+        for (int i = 0; i < WS_BENCH_JOBS; i++) ws_bench_submit(&ws_bench.jobs[i]);
+        vTaskPrioritySet(NULL, priority);
+    } else {
+        esp_timer_handle_t timer;
+        esp_timer_create_args_t timer_args = {.callback = ws_bench_tick, .name = "ws_bench"};
+        esp_timer_create(&timer_args, &timer);
+        esp_timer_start_periodic(timer, gap_us);
+        while (atomic_load(&ws_bench.next_job) < WS_BENCH_JOBS) vTaskDelay(1);
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+    }
+
+    if (design == WS_DESIGN_SHARED) {
+        ws_bench_job_t* stop = NULL;
+        for (int i = 0; i < WS_BENCH_WORKERS; i++) xQueueSend(ws_bench.shared, &stop, portMAX_DELAY);
+    } else {
+        ws_executor_stop(&ws_bench.executor);
+    }
+    bool finished = true;
+    for (int i = 0; i < WS_BENCH_WORKERS; i++) {
+        finished &= xSemaphoreTake(ws_bench.finished, pdMS_TO_TICKS(10000)) == pdTRUE;
+    }
+    if (!finished) {
+        ESP_LOGE(TAG, "Work-stealing benchmark did not finish");
+        return false;
+    }
+    uint64_t elapsed = esp_timer_get_time() - start;
+
+    uint32_t done = atomic_load(&ws_bench.done);
+    qsort(ws_bench.latency_us, done, sizeof(uint32_t), compare_u32);
+    *jobs_per_s = elapsed ? (uint32_t)(done * 1000000ULL / elapsed) : 0;
+    *p50_us = done ? ws_bench.latency_us[done / 2] : 0;
+    *p99_us = done ? ws_bench.latency_us[done * 99 / 100] : 0;
+    *stolen = 0;
+    if (design == WS_DESIGN_SHARED) {
+        vQueueDelete(ws_bench.shared);
+    } else {
+        for (int i = 0; i < WS_BENCH_WORKERS; i++) *stolen += ws_bench.executor.workers[i].stolen;
+        ws_executor_deinit(&ws_bench.executor);
+    }
+    vSemaphoreDelete(ws_bench.finished);
+    return done == WS_BENCH_JOBS;
+}
+
+static void report_work_stealing(void) {
+    static const char* const names[] = {"shared xQueue", "per-worker", "work stealing"};
+    uint32_t mean_us = (WS_BENCH_LONG_PERCENT * WS_BENCH_LONG_US +
+                        (100 - WS_BENCH_LONG_PERCENT) * WS_BENCH_SHORT_US) / 100;
+    uint32_t gap_us = mean_us * 10 / (2 * 7);   // ~70% of two cores
+    ESP_LOGI(TAG, "🧵 Skewed jobs, %d workers (%d%% × %d µs, rest %d µs; paced every %lu µs):",
+             WS_BENCH_WORKERS, WS_BENCH_LONG_PERCENT, WS_BENCH_LONG_US, WS_BENCH_SHORT_US,
+             (unsigned long)gap_us);
+    for (int d = WS_DESIGN_SHARED; d <= WS_DESIGN_STEALING; d++) {
+        uint32_t rate, p50, p99, stolen, unused;
+        if (!run_ws_benchmark(d, 0, &rate, &unused, &unused, &unused)) return;
+        if (!run_ws_benchmark(d, gap_us, &unused, &p50, &p99, &stolen)) return;
+        ESP_LOGI(TAG, "  %-13s: %5lu jobs/s saturated, paced p50 %5lu µs, p99 %6lu µs, stolen %lu",
+                 names[d], (unsigned long)rate, (unsigned long)p50, (unsigned long)p99,
+                 (unsigned long)stolen);
     }
 }
 
@@ -164,21 +652,30 @@ void app_main(void) {
     gpio_set_level(LED_CONSUMER_1, 0);
     gpio_set_level(LED_CONSUMER_2, 0);
     
-    xProductQueue = xQueueCreate(10, sizeof(product_t));
+    msg_layout_report("product_t", sizeof(product_legacy_t), sizeof(product_t));
+    report_bus_throughput();
+    report_batch_sweep();
+    report_work_stealing();
+    product_pool = msg_pool_create("products", sizeof(product_t), PRODUCT_POOL_SIZE);
+#if USE_LOCK_FREE_BUS
+    bool bus_ready = product_pool != NULL && msg_bus_init_lock_free(&product_bus, PRODUCT_QUEUE_DEPTH);
+#else
+    bool bus_ready = product_pool != NULL && msg_bus_init(&product_bus, PRODUCT_QUEUE_DEPTH);
+#endif
     xPrintMutex = xSemaphoreCreateMutex();
 
-    if (xProductQueue != NULL && xPrintMutex != NULL) {
-        ESP_LOGI(TAG, "Queue and mutex created successfully");
+    if (bus_ready && xPrintMutex != NULL) {
+        ESP_LOGI(TAG, "Message bus and mutex created successfully");
         
         static int producer1_id = 1, producer2_id = 2, producer3_id = 3;
-        static int consumer1_id = 1, consumer2_id = 2;
 
         // --- Experiment 1: Balanced System (3 Producers, 2 Consumers) ---
         xTaskCreate(producer_task, "Producer1", 3072, &producer1_id, 3, NULL);
         xTaskCreate(producer_task, "Producer2", 3072, &producer2_id, 3, NULL);
         xTaskCreate(producer_task, "Producer3", 3072, &producer3_id, 3, NULL);
-        xTaskCreate(consumer_task, "Consumer1", 3072, &consumer1_id, 2, NULL);
-        xTaskCreate(consumer_task, "Consumer2", 3072, &consumer2_id, 2, NULL);
+        if (!consumer_pool_start()) {
+            return;
+        }
 
         /* --- Experiment 2: More Producers ---
         // Uncomment the line below to add a 4th producer
@@ -187,8 +684,9 @@ void app_main(void) {
         */
 
         /* --- Experiment 3: Fewer Consumers ---
-        // Comment out the line below to remove the 2nd consumer
-        // xTaskCreate(consumer_task, "Consumer2", 3072, &consumer2_id, 2, NULL);
+        // Set CONSUMER_POOL_MIN and CONSUMER_POOL_MAX to 1 for a single,
+        // fixed consumer, or lower only CONSUMER_POOL_MIN and watch the
+        // load balancer scale up
         */
 
         xTaskCreate(statistics_task, "Statistics", 3072, NULL, 1, NULL);
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "bip_buffer.h"
+
+static const char *TAG = "BIP_BUFFER";
+
+#define BIP_ALIGN       4
+#define NO_RESERVATION  SIZE_MAX
+
+// Each record is a 32-bit payload length followed by the payload
+typedef uint32_t bip_header_t;
+
+size_t bip_record_footprint(size_t len) {
+    return (sizeof(bip_header_t) + len + BIP_ALIGN - 1) & ~(size_t)(BIP_ALIGN - 1);
+}
+
+bool bip_buffer_init(bip_buffer_t* bip, void* storage, size_t size) {
+    if (!bip || !storage || size < bip_record_footprint(1)) {
+        ESP_LOGE(TAG, "❌ Invalid bip buffer parameters");
+        return false;
+    }
+
+    memset(bip, 0, sizeof(bip_buffer_t));
+    bip->buffer = storage;
+    bip->size = size & ~(size_t)(BIP_ALIGN - 1);
+    bip->reserve_offset = NO_RESERVATION;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    bip->lock = unlocked;
+    return true;
+}
+
+// Region B becomes region A once A has been fully consumed
+static void swap_regions(bip_buffer_t* bip) {
+    bip->a_start = 0;
+    bip->a_end = bip->b_end;
+    bip->b_end = 0;
+    bip->b_active = false;
+}
+
+void* bip_reserve(bip_buffer_t* bip, size_t len) {
+    size_t total = bip_record_footprint(len);
+    size_t offset = NO_RESERVATION;
+
+    portENTER_CRITICAL(&bip->lock);
+
+    if (bip->reserve_offset != NO_RESERVATION) {
+        portEXIT_CRITICAL(&bip->lock);
+        ESP_LOGW(TAG, "⚠️ Reservation already pending");
+        return NULL;
+    }
+
+    // Empty buffer: start over at the beginning
+    if (!bip->b_active && bip->a_start == bip->a_end) {
+        bip->a_start = bip->a_end = 0;
+    }
+
+    if (bip->b_active) {
+        if (bip->b_end + total <= bip->a_start) {
+            offset = bip->b_end;
+        }
+    } else if (bip->a_end + total <= bip->size) {
+        offset = bip->a_end;
+    } else if (total <= bip->a_start) {
+        // Not enough room after A; start region B at the front
+        bip->b_active = true;
+        bip->wraps++;
+        offset = 0;
+    }
+
+    if (offset == NO_RESERVATION) {
+        bip->reserve_failures++;
+    } else {
+        bip->reserve_offset = offset;
+        bip->reserve_size = total;
+    }
+
+    portEXIT_CRITICAL(&bip->lock);
+
+    return offset == NO_RESERVATION ? NULL :
+           bip->buffer + offset + sizeof(bip_header_t);
+}
+
+void bip_commit(bip_buffer_t* bip, size_t used) {
+    size_t offset = bip->reserve_offset;
+    if (offset == NO_RESERVATION) return;
+
+    size_t total = bip_record_footprint(used);
+    if (total > bip->reserve_size) {
+        ESP_LOGE(TAG, "❌ Commit of %d bytes exceeds reservation", (int)used);
+        total = bip->reserve_size;
+        used = total - sizeof(bip_header_t);
+    }
+
+    // Header is written before the record becomes visible to the consumer
+    bip_header_t header = used;
+    memcpy(bip->buffer + offset, &header, sizeof(header));
+
+    portENTER_CRITICAL(&bip->lock);
+
+    if (used > 0) {
+        if (bip->b_active && offset == bip->b_end) {
+            bip->b_end += total;
+        } else {
+            bip->a_end += total;
+        }
+
+        bip->records_committed++;
+        bip->bytes_used += total;
+        bip->payload_bytes += used;
+        if (bip->bytes_used > bip->peak_bytes_used) {
+            bip->peak_bytes_used = bip->bytes_used;
+        }
+        if (bip->payload_bytes > bip->peak_payload_bytes) {
+            bip->peak_payload_bytes = bip->payload_bytes;
+        }
+    }
+
+    bip->reserve_offset = NO_RESERVATION;
+    bip->reserve_size = 0;
+
+    portEXIT_CRITICAL(&bip->lock);
+}
+
+const void* bip_read(bip_buffer_t* bip, size_t* len) {
+    const uint8_t* record = NULL;
+    bip_header_t header = 0;
+
+    portENTER_CRITICAL(&bip->lock);
+
+    if (bip->a_start == bip->a_end && bip->b_active) {
+        swap_regions(bip);
+    }
+
+    if (bip->a_start != bip->a_end) {
+        record = bip->buffer + bip->a_start;
+        memcpy(&header, record, sizeof(header));
+    }
+
+    portEXIT_CRITICAL(&bip->lock);
+
+    if (len) *len = record ? header : 0;
+    return record ? record + sizeof(bip_header_t) : NULL;
+}
+
+void bip_release(bip_buffer_t* bip) {
+    portENTER_CRITICAL(&bip->lock);
+
+    if (bip->a_start != bip->a_end) {
+        bip_header_t header;
+        memcpy(&header, bip->buffer + bip->a_start, sizeof(header));
+        size_t total = bip_record_footprint(header);
+
+        bip->a_start += total;
+        bip->records_released++;
+        bip->bytes_used -= total;
+        bip->payload_bytes -= header;
+
+        if (bip->a_start == bip->a_end) {
+            if (bip->b_active) {
+                swap_regions(bip);
+            } else if (bip->reserve_offset == NO_RESERVATION) {
+                bip->a_start = bip->a_end = 0;
+            }
+        }
+    }
+
+    portEXIT_CRITICAL(&bip->lock);
+}
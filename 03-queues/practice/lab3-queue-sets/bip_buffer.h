@@ -0,0 +1,52 @@
+#ifndef BIP_BUFFER_H
+#define BIP_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// Bipartite ring buffer for variable-length records with FIFO lifetime.
+// Data lives in up to two regions: A (being consumed) and B (growing from
+// the start of the buffer once A reaches the end). Every record is
+// contiguous, so both producer and consumer work on it in place.
+//
+// One producer (reserve/commit) and one consumer (read/release).
+
+typedef struct {
+    uint8_t* buffer;
+    size_t size;
+    size_t a_start;
+    size_t a_end;
+    size_t b_end;               // B always starts at 0
+    bool b_active;
+    size_t reserve_offset;      // Pending reservation, SIZE_MAX if none
+    size_t reserve_size;
+    portMUX_TYPE lock;
+
+    // Statistics
+    uint32_t records_committed;
+    uint32_t records_released;
+    uint32_t reserve_failures;
+    uint32_t wraps;
+    size_t bytes_used;          // Including record headers and padding
+    size_t peak_bytes_used;
+    size_t payload_bytes;
+    size_t peak_payload_bytes;
+} bip_buffer_t;
+
+bool bip_buffer_init(bip_buffer_t* bip, void* storage, size_t size);
+
+// Producer: get a contiguous area for a payload of up to len bytes,
+// then publish the first used bytes of it
+void* bip_reserve(bip_buffer_t* bip, size_t len);
+void bip_commit(bip_buffer_t* bip, size_t used);
+
+// Consumer: oldest record (or NULL), released once processed
+const void* bip_read(bip_buffer_t* bip, size_t* len);
+void bip_release(bip_buffer_t* bip);
+
+// Bytes of buffer a payload of len bytes occupies
+size_t bip_record_footprint(size_t len);
+
+#endif
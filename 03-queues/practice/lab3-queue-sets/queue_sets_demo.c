@@ -8,6 +8,11 @@
 #include "esp_log.h"
 #include "driver/gpio.h"
 #include "esp_random.h"
+#include "esp_timer.h"
+#include "bip_buffer.h"
+#include "iqueue.h"
+#include "dispatcher.h"
+#include "msg_layout.h"
 
 static const char *TAG = "QUEUE_SETS";
 
@@ -17,18 +22,47 @@ static const char *TAG = "QUEUE_SETS";
 #define LED_TIMER GPIO_NUM_18
 #define LED_PROCESSOR GPIO_NUM_19
 
-QueueHandle_t xSensorQueue;
-QueueHandle_t xUserQueue;
-QueueHandle_t xNetworkQueue;
+// Network messages are variable-length records in a bip buffer; the queue
+// only carries a pointer to the record so the processor reads it in place
+#define NETWORK_RING_SIZE 512
+#define RING_BENCH_MESSAGES 2000
+
+// The processor drains every ready source per wakeup, up to a per-source
+// budget, instead of handling one event per select. The 200 ms it spends
+// on its LED pulse is now paid once per wakeup rather than per event.
+#define DISPATCH_POLICY DISPATCH_ROUND_ROBIN
+#define DISPATCH_MAX_PER_WAKEUP 16
+#define USER_BUDGET 2
+#define NETWORK_BUDGET 4
+#define TIMER_BUDGET 1
+#define PROCESSOR_PULSE_MS 200
+
+// Sensor readings go through a latest-value mailbox: a slow processor
+// acts on the newest temperature and counts the ones it never saw.
+// The other queues are instrumented: latency, occupancy and blocking
+// show up in the monitor.
+static mailbox_t sensor_mailbox;
+static mailbox_reader_t processor_sensor_reader;
+iqueue_t* xUserQueue;
+iqueue_t* xNetworkQueue;
 SemaphoreHandle_t xTimerSemaphore;
-QueueSetHandle_t xQueueSet;
+static dispatcher_t dispatcher;
 
 typedef struct { int sensor_id; float temperature; float humidity; uint32_t timestamp; } sensor_data_t;
 typedef struct { int button_id; bool pressed; uint32_t duration_ms; } user_input_t;
-typedef struct { char source[20]; char message[100]; int priority; } network_message_t;
+typedef enum { NET_SRC_WIFI, NET_SRC_BLUETOOTH, NET_SRC_LORA, NET_SRC_ETHERNET } network_source_t;
+typedef struct { uint8_t source; uint8_t priority; char message[100]; } network_message_t; // source is a network_source_t
+typedef struct { uint8_t priority; uint8_t source_len; uint16_t message_len; char text[]; } network_record_t; // source then message, no terminators
+typedef struct { char source[20]; char message[100]; int priority; } network_message_legacy_t; // Original layout, kept for the layout benchmark
+_Static_assert(sizeof(network_message_t) <= 104, "network_message_t exceeds its 104-byte budget");
+_Static_assert(sizeof(network_record_t) == 4, "network_record_t header must stay 4 bytes");
+_Static_assert(sizeof(sensor_data_t) <= 16 && sizeof(user_input_t) <= 12, "sensor/user message over budget");
 typedef enum { MSG_SENSOR, MSG_USER, MSG_NETWORK, MSG_TIMER } message_type_t;
-typedef struct { uint32_t sensor_count; uint32_t user_count; uint32_t network_count; uint32_t timer_count; } message_stats_t;
-message_stats_t stats = {0, 0, 0, 0};
+typedef struct { uint32_t sensor_count; uint32_t user_count; uint32_t network_count; uint32_t timer_count; uint32_t network_dropped; } message_stats_t;
+message_stats_t stats = {0, 0, 0, 0, 0};
+
+static uint8_t network_ring_storage[NETWORK_RING_SIZE] __attribute__((aligned(4)));
+static bip_buffer_t network_ring;
 
 void sensor_task(void *pvParameters) {
     sensor_data_t sensor_data;
@@ -39,12 +73,12 @@ void sensor_task(void *pvParameters) {
         sensor_data.temperature = 20.0 + (esp_random() % 200) / 10.0;
         sensor_data.humidity = 30.0 + (esp_random() % 400) / 10.0;
         sensor_data.timestamp = xTaskGetTickCount();
-        if (xQueueSend(xSensorQueue, &sensor_data, pdMS_TO_TICKS(100)) == pdPASS) {
-            ESP_LOGI(TAG, "📊 Sensor: T=%.1f°C, H=%.1f%%", sensor_data.temperature, sensor_data.humidity);
-            gpio_set_level(LED_SENSOR, 1);
-            vTaskDelay(pdMS_TO_TICKS(50));
-            gpio_set_level(LED_SENSOR, 0);
-        }
+        // Always succeeds: an unread reading is replaced, never queued behind
+        uint32_t version = mailbox_write(&sensor_mailbox, &sensor_data);
+        ESP_LOGI(TAG, "📊 Sensor: T=%.1f°C, H=%.1f%% (v%lu)", sensor_data.temperature, sensor_data.humidity, (unsigned long)version);
+        gpio_set_level(LED_SENSOR, 1);
+        vTaskDelay(pdMS_TO_TICKS(50));
+        gpio_set_level(LED_SENSOR, 0);
         vTaskDelay(pdMS_TO_TICKS(2000 + (esp_random() % 3000)));
     }
 }
@@ -56,7 +90,7 @@ void user_input_task(void *pvParameters) {
         user_input.button_id = 1 + (esp_random() % 3);
         user_input.pressed = true;
         user_input.duration_ms = 100 + (esp_random() % 1000);
-        if (xQueueSend(xUserQueue, &user_input, pdMS_TO_TICKS(100)) == pdPASS) {
+        if (iqueue_send(xUserQueue, &user_input, pdMS_TO_TICKS(100))) {
             ESP_LOGI(TAG, "🔘 User: Button %d pressed for %dms", user_input.button_id, user_input.duration_ms);
             gpio_set_level(LED_USER, 1);
             vTaskDelay(pdMS_TO_TICKS(100));
@@ -66,17 +100,44 @@ void user_input_task(void *pvParameters) {
     }
 }
 
+// Builds a record in place; returns false if the ring is full
+static bool network_record_put(bip_buffer_t* ring, const char* source, const char* message, int priority, const network_record_t** out) {
+    size_t source_len = strlen(source), message_len = strlen(message);
+    size_t len = sizeof(network_record_t) + source_len + message_len;
+    network_record_t* rec = bip_reserve(ring, len);
+    if (!rec) return false;
+    rec->priority = priority;
+    rec->source_len = source_len;
+    rec->message_len = message_len;
+    memcpy(rec->text, source, source_len);
+    memcpy(rec->text + source_len, message, message_len);
+    bip_commit(ring, len);
+    if (out) *out = rec;
+    return true;
+}
+
 void network_task(void *pvParameters) {
-    network_message_t network_msg;
+    const network_record_t* rec;
     const char* sources[] = {"WiFi", "Bluetooth", "LoRa", "Ethernet"};
     const char* messages[] = {"Status update", "Config changed", "Alert", "Sync", "Heartbeat"};
     ESP_LOGI(TAG, "Network task started");
     while (1) {
-        strcpy(network_msg.source, sources[esp_random() % 4]);
-        strcpy(network_msg.message, messages[esp_random() % 5]);
-        network_msg.priority = 1 + (esp_random() % 5);
-        if (xQueueSend(xNetworkQueue, &network_msg, pdMS_TO_TICKS(100)) == pdPASS) {
-            ESP_LOGI(TAG, "🌐 Network [%s]: %s (P:%d)", network_msg.source, network_msg.message, network_msg.priority);
+        const char* source = sources[esp_random() % 4];
+        const char* message = messages[esp_random() % 5];
+        int priority = 1 + (esp_random() % 5);
+        // The handler releases the oldest record, so every committed record
+        // must reach the queue. This task is the only sender: a slot that is
+        // free before the commit is still free at the send.
+        if (iqueue_waiting(xNetworkQueue) >= xNetworkQueue->length) {
+            stats.network_dropped++;
+            ESP_LOGW(TAG, "🌐 Network queue full, message dropped (%lu dropped)", (unsigned long)stats.network_dropped);
+        } else if (!network_record_put(&network_ring, source, message, priority, &rec)) {
+            stats.network_dropped++;
+            ESP_LOGW(TAG, "🌐 Network ring full, message dropped (%lu dropped)", (unsigned long)stats.network_dropped);
+        } else if (!iqueue_send(xNetworkQueue, &rec, 0)) {
+            ESP_LOGE(TAG, "🌐 Network queue refused a committed record");
+        } else {
+            ESP_LOGI(TAG, "🌐 Network [%s]: %s (P:%d)", source, message, priority);
             gpio_set_level(LED_NETWORK, 1);
             vTaskDelay(pdMS_TO_TICKS(50));
             gpio_set_level(LED_NETWORK, 0);
@@ -99,38 +160,39 @@ void timer_task(void *pvParameters) {
     }
 }
 
+// Dispatcher handlers, one per queue set member
+static void handle_sensor(const void* item, void* ctx) {
+    const sensor_data_t* sensor_data = item;
+    stats.sensor_count++;
+    uint32_t age_ms = (xTaskGetTickCount() - sensor_data->timestamp) * portTICK_PERIOD_MS;
+    ESP_LOGI(TAG, "→ Processing SENSOR data: T=%.1f°C (v%lu, %lums old, %lu missed so far)", sensor_data->temperature,
+             (unsigned long)processor_sensor_reader.version, (unsigned long)age_ms, (unsigned long)processor_sensor_reader.missed);
+}
+
+static void handle_user(const void* item, void* ctx) {
+    const user_input_t* user_input = item;
+    stats.user_count++;
+    ESP_LOGI(TAG, "→ Processing USER input: Button %d", user_input->button_id);
+}
+
+static void handle_network(const void* item, void* ctx) {
+    const network_record_t* rec = *(const network_record_t* const*)item;
+    stats.network_count++;
+    ESP_LOGI(TAG, "→ Processing NETWORK msg: [%.*s]", rec->source_len, rec->text);
+    bip_release(&network_ring); // Records are consumed in FIFO order
+}
+
+static void handle_timer(const void* item, void* ctx) {
+    stats.timer_count++;
+    ESP_LOGI(TAG, "→ Processing TIMER event");
+}
+
 void processor_task(void *pvParameters) {
-    QueueSetMemberHandle_t xActivatedMember;
-    sensor_data_t sensor_data;
-    user_input_t user_input;
-    network_message_t network_msg;
     ESP_LOGI(TAG, "Processor task started - waiting for events...");
     while (1) {
-        xActivatedMember = xQueueSelectFromSet(xQueueSet, portMAX_DELAY);
-        if (xActivatedMember != NULL) {
+        if (dispatcher_run_once(&dispatcher, portMAX_DELAY) > 0) {
             gpio_set_level(LED_PROCESSOR, 1);
-            if (xActivatedMember == xSensorQueue) {
-                if (xQueueReceive(xSensorQueue, &sensor_data, 0) == pdPASS) {
-                    stats.sensor_count++;
-                    ESP_LOGI(TAG, "→ Processing SENSOR data: T=%.1f°C", sensor_data.temperature);
-                }
-            } else if (xActivatedMember == xUserQueue) {
-                if (xQueueReceive(xUserQueue, &user_input, 0) == pdPASS) {
-                    stats.user_count++;
-                    ESP_LOGI(TAG, "→ Processing USER input: Button %d", user_input.button_id);
-                }
-            } else if (xActivatedMember == xNetworkQueue) {
-                if (xQueueReceive(xNetworkQueue, &network_msg, 0) == pdPASS) {
-                    stats.network_count++;
-                    ESP_LOGI(TAG, "→ Processing NETWORK msg: [%s]", network_msg.source);
-                }
-            } else if (xActivatedMember == xTimerSemaphore) {
-                if (xSemaphoreTake(xTimerSemaphore, 0) == pdPASS) {
-                    stats.timer_count++;
-                    ESP_LOGI(TAG, "→ Processing TIMER event");
-                }
-            }
-            vTaskDelay(pdMS_TO_TICKS(200));
+            vTaskDelay(pdMS_TO_TICKS(PROCESSOR_PULSE_MS));
             gpio_set_level(LED_PROCESSOR, 0);
         }
     }
@@ -141,12 +203,96 @@ void monitor_task(void *pvParameters) {
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(15000));
         ESP_LOGI(TAG, "\n═══ SYSTEM MONITOR ═══");
-        ESP_LOGI(TAG, "  SensorQ: %d/%d | UserQ: %d/%d | NetworkQ: %d/%d", uxQueueMessagesWaiting(xSensorQueue), 5, uxQueueMessagesWaiting(xUserQueue), 3, uxQueueMessagesWaiting(xNetworkQueue), 8);
-        ESP_LOGI(TAG, "  Stats: Sensor:%lu, User:%lu, Network:%lu, Timer:%lu", stats.sensor_count, stats.user_count, stats.network_count, stats.timer_count);
+        iqueue_report_all();
+        dispatcher_report(&dispatcher);
+        ESP_LOGI(TAG, "  Stats: Sensor:%lu, User:%lu, Network:%lu (dropped %lu), Timer:%lu", stats.sensor_count, stats.user_count, stats.network_count, stats.network_dropped, stats.timer_count);
+        // A second reader: snapshots the latest reading without holding up the sensor
+        sensor_data_t latest;
+        uint32_t age_us;
+        uint32_t version = mailbox_read(&sensor_mailbox, &latest, &age_us);
+        ESP_LOGI(TAG, "  Sensor mailbox: v%lu T=%.1f°C (%lums old), writes:%lu, read retries:%lu, processor missed:%lu",
+                 (unsigned long)version, latest.temperature, (unsigned long)(age_us / 1000), (unsigned long)sensor_mailbox.writes,
+                 (unsigned long)sensor_mailbox.read_retries, (unsigned long)processor_sensor_reader.missed);
+        ESP_LOGI(TAG, "  NetRing: %d/%d B used (peak %d B), wraps:%lu, full:%lu", (int)network_ring.bytes_used, NETWORK_RING_SIZE, (int)network_ring.peak_bytes_used, network_ring.wraps, network_ring.reserve_failures);
         ESP_LOGI(TAG, "═══════════════════════\n");
     }
 }
 
+// Short text messages dominate, with an occasional long one
+static size_t bench_message_len(void) {
+    return (esp_random() % 5) ? 8 + (esp_random() % 25) : 33 + (esp_random() % 67);
+}
+
+// Same storage budget for both: fill until full, then drain, repeatedly
+void ring_benchmark_task(void *pvParameters) {
+    static uint8_t bench_storage[NETWORK_RING_SIZE] __attribute__((aligned(4)));
+    static char text[100];
+    network_message_t msg;
+    memset(text, 'x', sizeof(text) - 1);
+
+    int slots = NETWORK_RING_SIZE / sizeof(network_message_t);
+    QueueHandle_t fixed = xQueueCreate(slots, sizeof(network_message_t));
+    bip_buffer_t ring;
+    if (!fixed || !bip_buffer_init(&ring, bench_storage, sizeof(bench_storage))) {
+        ESP_LOGE(TAG, "Ring benchmark setup failed");
+        vTaskDelete(NULL);
+    }
+
+    // Fixed slots: every message occupies a full network_message_t
+    uint32_t sent = 0, held_max = 0, payload_held = 0, payload_max = 0;
+    uint64_t start = esp_timer_get_time();
+    while (sent < RING_BENCH_MESSAGES) {
+        uint32_t held = 0;
+        payload_held = 0;
+        while (sent < RING_BENCH_MESSAGES) {
+            size_t len = bench_message_len();
+            msg.source = NET_SRC_WIFI;
+            memcpy(msg.message, text, len);
+            msg.message[len < sizeof(msg.message) ? len : sizeof(msg.message) - 1] = '\0';
+            msg.priority = 1;
+            if (xQueueSend(fixed, &msg, 0) != pdPASS) break;
+            held++; sent++; payload_held += 4 + len;
+        }
+        if (held > held_max) held_max = held;
+        if (payload_held > payload_max) payload_max = payload_held;
+        while (xQueueReceive(fixed, &msg, 0) == pdPASS) {}
+    }
+    uint64_t fixed_time = esp_timer_get_time() - start;
+    uint32_t fixed_held = held_max, fixed_payload = payload_max;
+
+    // Bip buffer: records only take their own length plus a header
+    sent = 0; held_max = 0; payload_max = 0;
+    start = esp_timer_get_time();
+    while (sent < RING_BENCH_MESSAGES) {
+        uint32_t held = 0;
+        payload_held = 0;
+        while (sent < RING_BENCH_MESSAGES) {
+            size_t len = bench_message_len();
+            text[len] = '\0';
+            bool ok = network_record_put(&ring, "WiFi", text, 1, NULL);
+            text[len] = 'x';
+            if (!ok) break;
+            held++; sent++; payload_held += 4 + len;
+        }
+        if (held > held_max) held_max = held;
+        if (payload_held > payload_max) payload_max = payload_held;
+        size_t len;
+        while (bip_read(&ring, &len) != NULL) bip_release(&ring);
+    }
+    uint64_t ring_time = esp_timer_get_time() - start;
+
+    ESP_LOGI(TAG, "\n═══ RING vs FIXED SLOTS (%d B each, %d msgs) ═══", NETWORK_RING_SIZE, RING_BENCH_MESSAGES);
+    ESP_LOGI(TAG, "  Fixed: %d slots x %d B, max held %lu, utilisation %lu%%, %.1f μs/msg",
+             slots, (int)sizeof(network_message_t), fixed_held, (unsigned long)(fixed_payload * 100 / (slots * sizeof(network_message_t))),
+             (float)fixed_time / RING_BENCH_MESSAGES);
+    ESP_LOGI(TAG, "  Ring:  max held %lu, utilisation %lu%%, wraps %lu, %.1f μs/msg",
+             held_max, payload_max * 100 / NETWORK_RING_SIZE, ring.wraps, (float)ring_time / RING_BENCH_MESSAGES);
+    ESP_LOGI(TAG, "═══════════════════════\n");
+
+    vQueueDelete(fixed);
+    vTaskDelete(NULL);
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "Queue Sets Lab Starting...");
     gpio_set_direction(LED_SENSOR, GPIO_MODE_OUTPUT);
@@ -155,17 +301,21 @@ void app_main(void) {
     gpio_set_direction(LED_TIMER, GPIO_MODE_OUTPUT);
     gpio_set_direction(LED_PROCESSOR, GPIO_MODE_OUTPUT);
 
-    xSensorQueue = xQueueCreate(5, sizeof(sensor_data_t));
-    xUserQueue = xQueueCreate(3, sizeof(user_input_t));
-    xNetworkQueue = xQueueCreate(8, sizeof(network_message_t));
+    bool sensor_ready = mailbox_init(&sensor_mailbox, sizeof(sensor_data_t));
+    xUserQueue = iqueue_create("UserQ", 3, sizeof(user_input_t));
+    msg_layout_report("network_message_t", sizeof(network_message_legacy_t), sizeof(network_message_t));
+    bip_buffer_init(&network_ring, network_ring_storage, sizeof(network_ring_storage));
+    xNetworkQueue = iqueue_create("NetworkQ", 8, sizeof(const network_record_t*));
     xTimerSemaphore = xSemaphoreCreateBinary();
-    xQueueSet = xQueueCreateSet(5 + 3 + 8 + 1);
 
-    if (xQueueSet) {
-        xQueueAddToSet(xSensorQueue, xQueueSet);
-        xQueueAddToSet(xUserQueue, xQueueSet);
-        xQueueAddToSet(xNetworkQueue, xQueueSet);
-        xQueueAddToSet(xTimerSemaphore, xQueueSet);
+    bool ready = sensor_ready && xUserQueue && xNetworkQueue && xTimerSemaphore &&
+                 dispatcher_init(&dispatcher, 1 + 3 + 8 + 1, DISPATCH_POLICY, DISPATCH_MAX_PER_WAKEUP) &&
+                 dispatcher_add_mailbox(&dispatcher, "Sensor", &sensor_mailbox, &processor_sensor_reader, handle_sensor, NULL) &&
+                 dispatcher_add_queue(&dispatcher, "User", xUserQueue, handle_user, NULL, USER_BUDGET) &&
+                 dispatcher_add_queue(&dispatcher, "Network", xNetworkQueue, handle_network, NULL, NETWORK_BUDGET) &&
+                 dispatcher_add_semaphore(&dispatcher, "Timer", xTimerSemaphore, handle_timer, NULL, TIMER_BUDGET);
+
+    if (ready) {
         ESP_LOGI(TAG, "Queue set created successfully");
 
         // --- Experiment 2: Disable a source ---
@@ -176,7 +326,8 @@ void app_main(void) {
         xTaskCreate(network_task, "Network", 2048, NULL, 3, NULL);
         xTaskCreate(timer_task, "Timer", 2048, NULL, 2, NULL);
         xTaskCreate(processor_task, "Processor", 3072, NULL, 4, NULL);
-        xTaskCreate(monitor_task, "Monitor", 2048, NULL, 1, NULL);
+        xTaskCreate(monitor_task, "Monitor", 3072, NULL, 1, NULL);
+        xTaskCreate(ring_benchmark_task, "RingBench", 3072, NULL, 1, NULL);
         ESP_LOGI(TAG, "All tasks created.");
     } else {
         ESP_LOGE(TAG, "Failed to create queue set!");
@@ -2,6 +2,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <math.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
@@ -11,6 +12,9 @@
 #include "esp_random.h"
 #include "esp_timer.h"
 #include "driver/gpio.h"
+#include "msg_bus.h"
+#include "prio_queue.h"
+#include "msg_layout.h"
 
 static const char *TAG = "EVENT_SYNC";
 
@@ -21,6 +25,20 @@ static const char *TAG = "EVENT_SYNC";
 #define LED_PIPELINE_STAGE3 GPIO_NUM_18  // Pipeline stage 3
 #define LED_WORKFLOW_ACTIVE GPIO_NUM_19  // Workflow processing
 
+// Pipeline items travel by pointer and are processed in place; the pool
+// covers a full queue plus one item held by each stage and the generator
+#define PIPELINE_QUEUE_DEPTH    5
+#define PIPELINE_POOL_SIZE      10
+
+// Workflows are taken by priority, with aging so that low priorities are
+// not starved: an item gains one priority level per WORKFLOW_AGING_MS it
+// waits. 0 = the original FIFO queue. Retries keep their submission time.
+#define USE_PRIORITY_WORKFLOWS  1
+#define WORKFLOW_QUEUE_DEPTH    8
+#define WORKFLOW_PRIORITIES     5
+#define WORKFLOW_AGING_MS       5000
+#define WORKFLOW_LATENCY_SAMPLES 128   // ≥100, so p99 is not just the max
+
 // Event Groups for synchronization
 EventGroupHandle_t barrier_events;
 EventGroupHandle_t pipeline_events;
@@ -57,13 +75,28 @@ typedef struct {
     uint64_t timestamp;
 } worker_data_t;
 
+// Timestamps are relative: start_us is the low 32 bits of esp_timer (wraps
+// after ~71 minutes, so only differences are meaningful) and each stage
+// records its start as a millisecond offset from it
+typedef struct {
+    float processing_data[4];
+    uint32_t pipeline_id;
+    uint32_t start_us;
+    uint16_t stage_offset_ms[4];
+    uint8_t stage;
+    uint8_t quality_score;
+} pipeline_data_t;
+
+_Static_assert(sizeof(pipeline_data_t) <= 36, "pipeline_data_t exceeds its 36-byte budget");
+
+// Original layout, kept for the layout benchmark
 typedef struct {
     uint32_t pipeline_id;
     uint32_t stage;
     float processing_data[4];
     uint32_t quality_score;
     uint64_t stage_timestamps[4];
-} pipeline_data_t;
+} pipeline_data_legacy_t;
 
 typedef struct {
     uint32_t workflow_id;
@@ -71,11 +104,17 @@ typedef struct {
     uint32_t priority;
     uint32_t estimated_duration;
     bool requires_approval;
+    uint32_t submitted_ms;          // First submission, kept across retries
 } workflow_item_t;
 
 // Queues for data passing
-QueueHandle_t pipeline_queue;
+msg_bus_t pipeline_bus;
+msg_pool_t* pipeline_pool;
+#if USE_PRIORITY_WORKFLOWS
+prio_queue_t workflow_queue;
+#else
 QueueHandle_t workflow_queue;
+#endif
 
 // Statistics
 typedef struct {
@@ -89,6 +128,76 @@ typedef struct {
 
 static sync_stats_t stats = {0};
 
+// Completion latency (submission to success, retries included) of the
+// most recent workflows of each priority
+typedef struct {
+    uint32_t samples_ms[WORKFLOW_LATENCY_SAMPLES];
+    uint32_t next;
+    uint32_t completed;
+} workflow_latency_t;
+
+static workflow_latency_t workflow_latency[WORKFLOW_PRIORITIES];
+
+static inline uint32_t timer_now_us32(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+// Priority 1..5 maps to class 0..4, 5 being the most urgent
+static bool workflow_submit(const workflow_item_t* workflow, TickType_t timeout) {
+#if USE_PRIORITY_WORKFLOWS
+    return prio_queue_push_since(&workflow_queue, workflow, workflow->priority - 1,
+                                 workflow->submitted_ms, timeout);
+#else
+    return xQueueSend(workflow_queue, workflow, timeout) == pdTRUE;
+#endif
+}
+
+static bool workflow_take(workflow_item_t* workflow, TickType_t timeout) {
+#if USE_PRIORITY_WORKFLOWS
+    return prio_queue_pop(&workflow_queue, workflow, NULL, NULL, timeout);
+#else
+    return xQueueReceive(workflow_queue, workflow, timeout) == pdTRUE;
+#endif
+}
+
+static void record_workflow_latency(const workflow_item_t* workflow) {
+    workflow_latency_t* latency = &workflow_latency[workflow->priority - 1];
+    latency->samples_ms[latency->next] = prio_queue_now_ms() - workflow->submitted_ms;
+    latency->next = (latency->next + 1) % WORKFLOW_LATENCY_SAMPLES;
+    latency->completed++;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report_workflow_latency(void) {
+    ESP_LOGI(TAG, "Workflow latency (last %d per priority):", WORKFLOW_LATENCY_SAMPLES);
+    for (int p = WORKFLOW_PRIORITIES - 1; p >= 0; p--) {
+        workflow_latency_t* latency = &workflow_latency[p];
+        uint32_t completed = latency->completed;
+        uint32_t n = completed < WORKFLOW_LATENCY_SAMPLES ? completed : WORKFLOW_LATENCY_SAMPLES;
+        if (n == 0) {
+            ESP_LOGI(TAG, "  P%d: no completions", p + 1);
+            continue;
+        }
+        // Only this task reports, so the sort buffer stays off its stack
+        static uint32_t sorted[WORKFLOW_LATENCY_SAMPLES];
+        memcpy(sorted, latency->samples_ms, n * sizeof(uint32_t));
+        qsort(sorted, n, sizeof(uint32_t), compare_u32);
+        // Nearest rank: the smallest sample with at least q% at or below it
+        ESP_LOGI(TAG, "  P%d: %4lu done  p50 %6lu ms  p99 %6lu ms  max %6lu ms",
+                 p + 1, (unsigned long)completed, (unsigned long)sorted[(n * 50 + 99) / 100 - 1],
+                 (unsigned long)sorted[(n * 99 + 99) / 100 - 1], (unsigned long)sorted[n - 1]);
+    }
+#if USE_PRIORITY_WORKFLOWS
+    ESP_LOGI(TAG, "  Queued: %d, taken ahead of a more urgent item by aging: %lu",
+             prio_queue_count(&workflow_queue), (unsigned long)workflow_queue.aged_pops);
+#endif
+}
+
 // Barrier Synchronization Tasks
 void barrier_worker_task(void *pvParameters) {
     uint32_t worker_id = (uint32_t)pvParameters;
@@ -181,16 +290,15 @@ void pipeline_stage_task(void *pvParameters) {
         if (bits & prev_stage_bit) {
             gpio_set_level(stage_leds[stage_id], 1);
             
-            pipeline_data_t pipeline_data;
-            
-            // Get data from queue if available
-            if (xQueueReceive(pipeline_queue, &pipeline_data, pdMS_TO_TICKS(100)) == pdTRUE) {
+            // Get data from queue if available; this stage owns it until it is passed on
+            pipeline_data_t* pipeline_data = msg_bus_receive(&pipeline_bus, pdMS_TO_TICKS(100));
+            if (pipeline_data != NULL) {
                 ESP_LOGI(TAG, "📦 Stage %lu: Processing pipeline ID %lu", 
-                         stage_id, pipeline_data.pipeline_id);
+                         stage_id, pipeline_data->pipeline_id);
                 
                 // Record processing start time
-                pipeline_data.stage_timestamps[stage_id] = esp_timer_get_time();
-                pipeline_data.stage = stage_id;
+                pipeline_data->stage_offset_ms[stage_id] = (timer_now_us32() - pipeline_data->start_us) / 1000;
+                pipeline_data->stage = stage_id;
                 
                 // Simulate stage-specific processing
                 uint32_t processing_time = 500 + (esp_random() % 1000);
@@ -199,54 +307,59 @@ void pipeline_stage_task(void *pvParameters) {
                     case 0: // Input stage
                         ESP_LOGI(TAG, "📥 Stage %lu: Data input and validation", stage_id);
                         for (int i = 0; i < 4; i++) {
-                            pipeline_data.processing_data[i] = (esp_random() % 1000) / 10.0;
+                            pipeline_data->processing_data[i] = (esp_random() % 1000) / 10.0;
                         }
-                        pipeline_data.quality_score = 70 + (esp_random() % 30);
+                        pipeline_data->quality_score = 70 + (esp_random() % 30);
                         break;
                         
                     case 1: // Processing stage
                         ESP_LOGI(TAG, "⚙️ Stage %lu: Data processing and transformation", stage_id);
                         for (int i = 0; i < 4; i++) {
-                            pipeline_data.processing_data[i] *= 1.1; // Apply processing
+                            pipeline_data->processing_data[i] *= 1.1; // Apply processing
                         }
-                        pipeline_data.quality_score += (esp_random() % 20) - 10; // ±10
+                        pipeline_data->quality_score += (esp_random() % 20) - 10; // ±10
                         break;
                         
                     case 2: // Filtering stage
                         ESP_LOGI(TAG, "🔍 Stage %lu: Data filtering and validation", stage_id);
                         float avg = 0;
                         for (int i = 0; i < 4; i++) {
-                            avg += pipeline_data.processing_data[i];
+                            avg += pipeline_data->processing_data[i];
                         }
                         avg /= 4.0;
-                        ESP_LOGI(TAG, "Average value: %.2f, Quality: %lu", 
-                                avg, pipeline_data.quality_score);
+                        ESP_LOGI(TAG, "Average value: %.2f, Quality: %d", 
+                                avg, pipeline_data->quality_score);
                         break;
                         
                     case 3: // Output stage
                         ESP_LOGI(TAG, "📤 Stage %lu: Data output and delivery", stage_id);
                         stats.pipeline_completions++;
                         
-                        uint64_t total_time = esp_timer_get_time() - 
-                                            pipeline_data.stage_timestamps[0];
+                        uint32_t total_time = timer_now_us32() - pipeline_data->start_us;
                         stats.total_processing_time += total_time;
                         
-                        ESP_LOGI(TAG, "✅ Pipeline %lu completed in %llu ms (Quality: %lu)", 
-                                pipeline_data.pipeline_id, total_time / 1000, 
-                                pipeline_data.quality_score);
+                        ESP_LOGI(TAG, "✅ Pipeline %lu completed in %lu ms (Quality: %d)", 
+                                pipeline_data->pipeline_id, total_time / 1000, 
+                                pipeline_data->quality_score);
+                        ESP_LOGI(TAG, "   Stage starts: %d / %d / %d / %d ms", 
+                                pipeline_data->stage_offset_ms[0], pipeline_data->stage_offset_ms[1],
+                                pipeline_data->stage_offset_ms[2], pipeline_data->stage_offset_ms[3]);
                         break;
                 }
                 
                 vTaskDelay(pdMS_TO_TICKS(processing_time));
                 
-                // Pass data to next stage
+                // Pass data to next stage; the last stage is done with it
                 if (stage_id < 3) {
-                    if (xQueueSend(pipeline_queue, &pipeline_data, pdMS_TO_TICKS(100)) == pdTRUE) {
+                    if (msg_bus_send(&pipeline_bus, pipeline_data, pdMS_TO_TICKS(100))) {
                         xEventGroupSetBits(pipeline_events, stage_complete_bit);
                         ESP_LOGI(TAG, "➡️ Stage %lu: Data passed to next stage", stage_id);
                     } else {
                         ESP_LOGW(TAG, "⚠️ Stage %lu: Queue full, data lost", stage_id);
+                        msg_release(pipeline_data);
                     }
+                } else {
+                    msg_release(pipeline_data);
                 }
                 
             } else {
@@ -262,8 +375,7 @@ void pipeline_stage_task(void *pvParameters) {
             ESP_LOGI(TAG, "🔄 Stage %lu: Pipeline reset detected", stage_id);
             xEventGroupClearBits(pipeline_events, PIPELINE_RESET_BIT);
             // Clear any remaining data
-            pipeline_data_t dummy;
-            while (xQueueReceive(pipeline_queue, &dummy, 0) == pdTRUE);
+            msg_bus_drain(&pipeline_bus);
         }
     }
 }
@@ -275,18 +387,26 @@ void pipeline_data_generator_task(void *pvParameters) {
     ESP_LOGI(TAG, "🏭 Pipeline data generator started");
     
     while (1) {
-        pipeline_data_t data = {0};
-        data.pipeline_id = ++pipeline_id;
-        data.stage = 0;
-        data.stage_timestamps[0] = esp_timer_get_time();
+        pipeline_data_t* data = msg_alloc(pipeline_pool);
+        ++pipeline_id;
         
-        ESP_LOGI(TAG, "🚀 Generating pipeline data ID: %lu", pipeline_id);
-        
-        if (xQueueSend(pipeline_queue, &data, pdMS_TO_TICKS(1000)) == pdTRUE) {
-            xEventGroupSetBits(pipeline_events, DATA_AVAILABLE_BIT);
-            ESP_LOGI(TAG, "✅ Pipeline data %lu injected", pipeline_id);
+        if (data == NULL) {
+            ESP_LOGW(TAG, "⚠️ Pipeline pool exhausted, data %lu dropped", pipeline_id);
         } else {
-            ESP_LOGW(TAG, "⚠️ Pipeline queue full, data %lu dropped", pipeline_id);
+            memset(data, 0, sizeof(pipeline_data_t));
+            data->pipeline_id = pipeline_id;
+            data->stage = 0;
+            data->start_us = timer_now_us32();
+            
+            ESP_LOGI(TAG, "🚀 Generating pipeline data ID: %lu", pipeline_id);
+            
+            if (msg_bus_send(&pipeline_bus, data, pdMS_TO_TICKS(1000))) {
+                xEventGroupSetBits(pipeline_events, DATA_AVAILABLE_BIT);
+                ESP_LOGI(TAG, "✅ Pipeline data %lu injected", pipeline_id);
+            } else {
+                ESP_LOGW(TAG, "⚠️ Pipeline queue full, data %lu dropped", pipeline_id);
+                msg_release(data);
+            }
         }
         
         // Generate data at random intervals
@@ -303,7 +423,7 @@ void workflow_manager_task(void *pvParameters) {
         workflow_item_t workflow;
         
         // Wait for workflow requests
-        if (xQueueReceive(workflow_queue, &workflow, portMAX_DELAY) == pdTRUE) {
+        if (workflow_take(&workflow, portMAX_DELAY)) {
             ESP_LOGI(TAG, "📝 New workflow: ID %lu - %s (Priority: %lu)", 
                      workflow.workflow_id, workflow.description, workflow.priority);
             
@@ -352,13 +472,14 @@ void workflow_manager_task(void *pvParameters) {
                     
                     xEventGroupSetBits(workflow_events, WORKFLOW_DONE_BIT);
                     stats.workflow_completions++;
+                    record_workflow_latency(&workflow);
                     
                 } else {
                     ESP_LOGW(TAG, "⚠️ Workflow %lu quality check failed (%lu%%), retrying...", 
                              workflow.workflow_id, quality);
                     
-                    // Re-queue for retry
-                    if (xQueueSend(workflow_queue, &workflow, 0) != pdTRUE) {
+                    // Re-queue for retry; it keeps its age and so its place
+                    if (!workflow_submit(&workflow, 0)) {
                         ESP_LOGE(TAG, "❌ Failed to re-queue workflow %lu", workflow.workflow_id);
                     }
                 }
@@ -469,7 +590,8 @@ void workflow_generator_task(void *pvParameters) {
                  workflow.description, workflow.workflow_id, workflow.priority,
                  workflow.requires_approval ? "Required" : "Not Required");
         
-        if (xQueueSend(workflow_queue, &workflow, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        workflow.submitted_ms = prio_queue_now_ms();
+        if (!workflow_submit(&workflow, pdMS_TO_TICKS(1000))) {
             ESP_LOGW(TAG, "⚠️ Workflow queue full, dropping workflow %lu", workflow.workflow_id);
         }
         
@@ -501,6 +623,8 @@ void statistics_monitor_task(void *pvParameters) {
         
         ESP_LOGI(TAG, "Free heap:             %d bytes", esp_get_free_heap_size());
         ESP_LOGI(TAG, "System uptime:         %llu ms", esp_timer_get_time() / 1000);
+        msg_pool_print_stats(pipeline_pool);
+        report_workflow_latency();
         ESP_LOGI(TAG, "═══════════════════════════════════════\n");
         
         // Event group status
@@ -538,11 +662,20 @@ void app_main(void) {
         return;
     }
     
+    msg_layout_report("pipeline_data_t", sizeof(pipeline_data_legacy_t), sizeof(pipeline_data_t));
+    
     // Create Queues
-    pipeline_queue = xQueueCreate(5, sizeof(pipeline_data_t));
-    workflow_queue = xQueueCreate(8, sizeof(workflow_item_t));
+    pipeline_pool = msg_pool_create("pipeline", sizeof(pipeline_data_t), PIPELINE_POOL_SIZE);
+    bool pipeline_ready = pipeline_pool && msg_bus_init(&pipeline_bus, PIPELINE_QUEUE_DEPTH);
+#if USE_PRIORITY_WORKFLOWS
+    bool workflow_ready = prio_queue_init(&workflow_queue, WORKFLOW_QUEUE_DEPTH, sizeof(workflow_item_t),
+                                          WORKFLOW_PRIORITIES, WORKFLOW_AGING_MS);
+#else
+    workflow_queue = xQueueCreate(WORKFLOW_QUEUE_DEPTH, sizeof(workflow_item_t));
+    bool workflow_ready = workflow_queue != NULL;
+#endif
     
-    if (!pipeline_queue || !workflow_queue) {
+    if (!pipeline_ready || !workflow_ready) {
         ESP_LOGE(TAG, "Failed to create queues!");
         return;
     }
@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "prio_queue.h"
+
+static const char *TAG = "PRIO_Q";
+
+uint32_t prio_queue_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+bool prio_queue_init(prio_queue_t* queue, uint16_t capacity, size_t item_size,
+                     uint8_t classes, uint32_t aging_ms) {
+    if (classes == 0 || classes > PRIO_QUEUE_MAX_CLASSES || capacity == 0 || capacity >= PRIO_QUEUE_NONE) {
+        ESP_LOGE(TAG, "Invalid queue: %d classes, capacity %d", classes, capacity);
+        return false;
+    }
+    memset(queue, 0, sizeof(prio_queue_t));
+    queue->items = malloc((size_t)capacity * item_size);
+    queue->since_ms = malloc(capacity * sizeof(uint32_t));
+    queue->next = malloc(capacity * sizeof(uint16_t));
+    queue->filled = xSemaphoreCreateCounting(capacity, 0);
+    queue->empty = xSemaphoreCreateCounting(capacity, capacity);
+    if (!queue->items || !queue->since_ms || !queue->next || !queue->filled || !queue->empty) {
+        ESP_LOGE(TAG, "Failed to allocate priority queue");
+        free(queue->items);
+        free(queue->since_ms);
+        free(queue->next);
+        if (queue->filled) vSemaphoreDelete(queue->filled);
+        if (queue->empty) vSemaphoreDelete(queue->empty);
+        return false;
+    }
+
+    queue->capacity = capacity;
+    queue->classes = classes;
+    queue->item_size = item_size;
+    queue->aging_ms = aging_ms;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    queue->lock = unlocked;
+
+    for (int c = 0; c < PRIO_QUEUE_MAX_CLASSES; c++) {
+        queue->heads[c] = PRIO_QUEUE_NONE;
+        queue->tails[c] = PRIO_QUEUE_NONE;
+    }
+    for (int i = 0; i < capacity; i++) {
+        queue->next[i] = i + 1 < capacity ? i + 1 : PRIO_QUEUE_NONE;
+    }
+    queue->free_head = 0;
+    return true;
+}
+
+// Keeps each class ordered by since_ms, so its head is always the item
+// that has waited longest. New items go to the tail without a walk;
+// retries carrying an older since_ms are placed among their peers.
+static void insert_by_age(prio_queue_t* queue, uint8_t cls, uint16_t node) {
+    uint32_t since_ms = queue->since_ms[node];
+    uint16_t tail = queue->tails[cls];
+    if (tail == PRIO_QUEUE_NONE || (int32_t)(since_ms - queue->since_ms[tail]) >= 0) {
+        queue->next[node] = PRIO_QUEUE_NONE;
+        if (tail == PRIO_QUEUE_NONE) {
+            queue->heads[cls] = node;
+        } else {
+            queue->next[tail] = node;
+        }
+        queue->tails[cls] = node;
+        return;
+    }
+
+    // Before the first item that is younger; the tail is, so one exists
+    uint16_t prev = PRIO_QUEUE_NONE;
+    uint16_t cur = queue->heads[cls];
+    while ((int32_t)(since_ms - queue->since_ms[cur]) >= 0) {
+        prev = cur;
+        cur = queue->next[cur];
+    }
+    queue->next[node] = cur;
+    if (prev == PRIO_QUEUE_NONE) {
+        queue->heads[cls] = node;
+    } else {
+        queue->next[prev] = node;
+    }
+}
+
+bool prio_queue_push_since(prio_queue_t* queue, const void* item, uint8_t cls,
+                           uint32_t since_ms, TickType_t timeout) {
+    if (cls >= queue->classes) cls = queue->classes - 1;
+    if (xSemaphoreTake(queue->empty, timeout) != pdTRUE) {
+        return false;
+    }
+
+    portENTER_CRITICAL(&queue->lock);
+    uint16_t node = queue->free_head;
+    queue->free_head = queue->next[node];
+    memcpy(queue->items + node * queue->item_size, item, queue->item_size);
+    queue->since_ms[node] = since_ms;
+    insert_by_age(queue, cls, node);
+    queue->counts[cls]++;
+    queue->pushed[cls]++;
+    portEXIT_CRITICAL(&queue->lock);
+
+    xSemaphoreGive(queue->filled);
+    return true;
+}
+
+bool prio_queue_push(prio_queue_t* queue, const void* item, uint8_t cls, TickType_t timeout) {
+    return prio_queue_push_since(queue, item, cls, prio_queue_now_ms(), timeout);
+}
+
+// Best head by class × aging_ms + waited; ties go to the more urgent class
+static int select_class(prio_queue_t* queue, uint32_t now) {
+    int best = -1;
+    uint64_t best_score = 0;
+    for (int c = queue->classes - 1; c >= 0; c--) {
+        uint16_t head = queue->heads[c];
+        if (head == PRIO_QUEUE_NONE) continue;
+        uint32_t waited = now - queue->since_ms[head];
+        uint64_t score = queue->aging_ms ? (uint64_t)c * queue->aging_ms + waited : (uint64_t)c;
+        if (best < 0 || score > best_score) {
+            best = c;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+bool prio_queue_pop(prio_queue_t* queue, void* out, uint8_t* cls_out,
+                    uint32_t* waited_ms_out, TickType_t timeout) {
+    if (xSemaphoreTake(queue->filled, timeout) != pdTRUE) {
+        return false;
+    }
+    uint32_t now = prio_queue_now_ms();
+
+    portENTER_CRITICAL(&queue->lock);
+    int cls = select_class(queue, now);
+    uint16_t node = queue->heads[cls];
+    queue->heads[cls] = queue->next[node];
+    if (queue->heads[cls] == PRIO_QUEUE_NONE) {
+        queue->tails[cls] = PRIO_QUEUE_NONE;
+    }
+    for (int c = cls + 1; c < queue->classes; c++) {
+        if (queue->counts[c] > 0) {
+            queue->aged_pops++;
+            break;
+        }
+    }
+    queue->counts[cls]--;
+    queue->popped[cls]++;
+    memcpy(out, queue->items + node * queue->item_size, queue->item_size);
+    uint32_t waited = now - queue->since_ms[node];
+    queue->next[node] = queue->free_head;
+    queue->free_head = node;
+    portEXIT_CRITICAL(&queue->lock);
+
+    xSemaphoreGive(queue->empty);
+    if (cls_out) *cls_out = cls;
+    if (waited_ms_out) *waited_ms_out = waited;
+    return true;
+}
+
+uint16_t prio_queue_count(prio_queue_t* queue) {
+    uint16_t total = 0;
+    portENTER_CRITICAL(&queue->lock);
+    for (int c = 0; c < queue->classes; c++) {
+        total += queue->counts[c];
+    }
+    portEXIT_CRITICAL(&queue->lock);
+    return total;
+}
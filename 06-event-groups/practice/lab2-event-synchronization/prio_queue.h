@@ -0,0 +1,64 @@
+#ifndef PRIO_QUEUE_H
+#define PRIO_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Bounded priority work queue with aging. Items sit in one FIFO per
+// priority class (all classes share one node pool), and pop takes the
+// head with the best score: class × aging_ms + time waited. An item
+// therefore gains one class for every aging_ms it waits, and a steady
+// stream of urgent work cannot starve the low classes. Within a class
+// items are ordered by their aging origin (FIFO for plain pushes). Push
+// blocks while the queue is full, pop while empty.
+
+#define PRIO_QUEUE_MAX_CLASSES  8
+#define PRIO_QUEUE_NONE         0xFFFF
+
+typedef struct {
+    uint8_t* items;
+    uint32_t* since_ms;             // Aging origin of each node
+    uint16_t* next;
+    uint16_t free_head;
+    uint16_t heads[PRIO_QUEUE_MAX_CLASSES];
+    uint16_t tails[PRIO_QUEUE_MAX_CLASSES];
+    uint16_t counts[PRIO_QUEUE_MAX_CLASSES];
+    uint16_t capacity;
+    uint8_t classes;                // Class classes-1 is the most urgent
+    size_t item_size;
+    uint32_t aging_ms;              // 0 = strict priority
+    portMUX_TYPE lock;
+    SemaphoreHandle_t filled;       // Counting: items available
+    SemaphoreHandle_t empty;        // Counting: free nodes
+
+    // Statistics
+    uint32_t pushed[PRIO_QUEUE_MAX_CLASSES];
+    uint32_t popped[PRIO_QUEUE_MAX_CLASSES];
+    uint32_t aged_pops;             // Taken ahead of a more urgent class
+} prio_queue_t;
+
+bool prio_queue_init(prio_queue_t* queue, uint16_t capacity, size_t item_size,
+                     uint8_t classes, uint32_t aging_ms);
+
+// Ages from now
+bool prio_queue_push(prio_queue_t* queue, const void* item, uint8_t cls, TickType_t timeout);
+
+// Ages from since_ms (esp_timer milliseconds), e.g. the original
+// submission time of a retried item so it keeps the age it earned and
+// goes back ahead of younger items of its class
+bool prio_queue_push_since(prio_queue_t* queue, const void* item, uint8_t cls,
+                           uint32_t since_ms, TickType_t timeout);
+
+// cls_out and waited_ms_out may be NULL
+bool prio_queue_pop(prio_queue_t* queue, void* out, uint8_t* cls_out,
+                    uint32_t* waited_ms_out, TickType_t timeout);
+
+uint16_t prio_queue_count(prio_queue_t* queue);
+
+// Clock used for aging and since_ms
+uint32_t prio_queue_now_ms(void);
+
+#endif
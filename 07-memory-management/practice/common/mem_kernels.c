@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mem_kernels.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_timer.h"
+
+static uint64_t mk_now_ns(void) {
+    return (uint64_t)esp_timer_get_time() * 1000;
+}
+#else
+#include <time.h>
+
+static uint64_t mk_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+#if MK_USE_AVX2 || MK_USE_SSE2
+#include <immintrin.h>
+#endif
+
+// Keeps the reference versions byte-at-a-time at -O2/-O3
+#if defined(__GNUC__) && !defined(__clang__)
+#define MK_NO_VECTORIZE __attribute__((optimize("no-tree-vectorize")))
+#else
+#define MK_NO_VECTORIZE
+#endif
+
+// Native-width word that may alias the caller's buffers
+typedef uintptr_t __attribute__((may_alias)) mk_word_t;
+typedef uint32_t __attribute__((may_alias)) mk_u32_t;
+
+#define WORD_BYTES sizeof(mk_word_t)
+
+static inline uint8_t pattern_byte(uint32_t pattern, size_t offset) {
+    return (uint8_t)(pattern >> (8 * (offset & 3)));
+}
+
+// Pattern as seen by a word starting at byte `offset` of the buffer
+static inline uint32_t pattern_at(uint32_t pattern, size_t offset) {
+    unsigned shift = 8 * (offset & 3);
+    return shift ? (pattern >> shift) | (pattern << (32 - shift)) : pattern;
+}
+
+static inline mk_word_t word_pattern(uint32_t pattern, size_t offset) {
+    mk_word_t w = pattern_at(pattern, offset);
+    if (WORD_BYTES == 8) {
+        w |= (w << 16) << 16;
+    }
+    return w;
+}
+
+// ═══ Scalar reference ═══
+
+MK_NO_VECTORIZE
+void mk_fill32_scalar(void* dst, uint32_t pattern, size_t bytes) {
+    uint8_t* d = dst;
+    for (size_t i = 0; i < bytes; i++) {
+        d[i] = pattern_byte(pattern, i);
+    }
+}
+
+MK_NO_VECTORIZE
+bool mk_verify32_scalar(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset) {
+    const uint8_t* s = src;
+    for (size_t i = 0; i < bytes; i++) {
+        if (s[i] != pattern_byte(pattern, i)) {
+            if (bad_offset) *bad_offset = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+MK_NO_VECTORIZE
+uint32_t mk_checksum32_scalar(const void* src, size_t bytes) {
+    const uint8_t* s = src;
+    uint32_t sum = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        sum += (uint32_t)s[i] << (8 * (i & 3));
+    }
+    return sum;
+}
+
+MK_NO_VECTORIZE
+size_t mk_compare_scalar(const void* a, const void* b, size_t bytes) {
+    const uint8_t* pa = a;
+    const uint8_t* pb = b;
+    for (size_t i = 0; i < bytes; i++) {
+        if (pa[i] != pb[i]) return i;
+    }
+    return bytes;
+}
+
+#if defined(MK_FORCE_SCALAR)
+
+void mk_fill32(void* dst, uint32_t pattern, size_t bytes) {
+    mk_fill32_scalar(dst, pattern, bytes);
+}
+
+bool mk_verify32(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset) {
+    return mk_verify32_scalar(src, pattern, bytes, bad_offset);
+}
+
+uint32_t mk_checksum32(const void* src, size_t bytes) {
+    return mk_checksum32_scalar(src, bytes);
+}
+
+size_t mk_compare(const void* a, const void* b, size_t bytes) {
+    return mk_compare_scalar(a, b, bytes);
+}
+
+#elif MK_USE_AVX2 || MK_USE_SSE2
+
+// ═══ SIMD (host) ═══
+// Unaligned loads/stores throughout; 16/32-byte steps keep the pattern phase
+
+#if MK_USE_AVX2
+typedef __m256i mk_vec_t;
+#define VEC_BYTES           32
+#define VEC_ALL_EQUAL       0xFFFFFFFFu
+#define vec_set1(p)         _mm256_set1_epi32((int)(p))
+#define vec_load(p)         _mm256_loadu_si256((const __m256i*)(p))
+#define vec_store(p, v)     _mm256_storeu_si256((__m256i*)(p), (v))
+#define vec_add32(a, b)     _mm256_add_epi32((a), (b))
+#define vec_eq_mask(a, b)   ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8((a), (b))))
+#define vec_zero()          _mm256_setzero_si256()
+#else
+typedef __m128i mk_vec_t;
+#define VEC_BYTES           16
+#define VEC_ALL_EQUAL       0xFFFFu
+#define vec_set1(p)         _mm_set1_epi32((int)(p))
+#define vec_load(p)         _mm_loadu_si128((const __m128i*)(p))
+#define vec_store(p, v)     _mm_storeu_si128((__m128i*)(p), (v))
+#define vec_add32(a, b)     _mm_add_epi32((a), (b))
+#define vec_eq_mask(a, b)   ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8((a), (b))))
+#define vec_zero()          _mm_setzero_si128()
+#endif
+
+void mk_fill32(void* dst, uint32_t pattern, size_t bytes) {
+    uint8_t* d = dst;
+    mk_vec_t v = vec_set1(pattern);
+    size_t i = 0;
+
+    for (; i + 4 * VEC_BYTES <= bytes; i += 4 * VEC_BYTES) {
+        vec_store(d + i, v);
+        vec_store(d + i + VEC_BYTES, v);
+        vec_store(d + i + 2 * VEC_BYTES, v);
+        vec_store(d + i + 3 * VEC_BYTES, v);
+    }
+    for (; i + VEC_BYTES <= bytes; i += VEC_BYTES) {
+        vec_store(d + i, v);
+    }
+    for (; i < bytes; i++) {
+        d[i] = pattern_byte(pattern, i);
+    }
+}
+
+bool mk_verify32(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset) {
+    const uint8_t* s = src;
+    mk_vec_t v = vec_set1(pattern);
+    size_t i = 0;
+
+    for (; i + VEC_BYTES <= bytes; i += VEC_BYTES) {
+        uint32_t mask = vec_eq_mask(vec_load(s + i), v);
+        if (mask != VEC_ALL_EQUAL) {
+            if (bad_offset) *bad_offset = i + __builtin_ctz(~mask);
+            return false;
+        }
+    }
+    for (; i < bytes; i++) {
+        if (s[i] != pattern_byte(pattern, i)) {
+            if (bad_offset) *bad_offset = i;
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t mk_checksum32(const void* src, size_t bytes) {
+    const uint8_t* s = src;
+    mk_vec_t acc0 = vec_zero(), acc1 = vec_zero();
+    size_t i = 0;
+
+    for (; i + 2 * VEC_BYTES <= bytes; i += 2 * VEC_BYTES) {
+        acc0 = vec_add32(acc0, vec_load(s + i));
+        acc1 = vec_add32(acc1, vec_load(s + i + VEC_BYTES));
+    }
+    acc0 = vec_add32(acc0, acc1);
+
+    uint32_t lanes[VEC_BYTES / 4];
+    vec_store(lanes, acc0);
+    uint32_t sum = 0;
+    for (int l = 0; l < VEC_BYTES / 4; l++) {
+        sum += lanes[l];
+    }
+    for (; i < bytes; i++) {
+        sum += (uint32_t)s[i] << (8 * (i & 3));
+    }
+    return sum;
+}
+
+size_t mk_compare(const void* a, const void* b, size_t bytes) {
+    const uint8_t* pa = a;
+    const uint8_t* pb = b;
+    size_t i = 0;
+
+    for (; i + VEC_BYTES <= bytes; i += VEC_BYTES) {
+        uint32_t mask = vec_eq_mask(vec_load(pa + i), vec_load(pb + i));
+        if (mask != VEC_ALL_EQUAL) {
+            return i + __builtin_ctz(~mask);
+        }
+    }
+    for (; i < bytes; i++) {
+        if (pa[i] != pb[i]) return i;
+    }
+    return bytes;
+}
+
+#else
+
+// ═══ Word-wide (with PIE fill on ESP32-S3) ═══
+
+static size_t head_bytes(const void* p, size_t bytes, size_t align) {
+    size_t head = (align - ((uintptr_t)p & (align - 1))) & (align - 1);
+    return head < bytes ? head : bytes;
+}
+
+#if MK_USE_PIE
+// Broadcasts the 32-bit pattern into q0 and stores 16 bytes per step.
+// dst must be 16-byte aligned; PIE ignores the low address bits.
+static void pie_fill_blocks(uint8_t* dst, uint32_t pattern, size_t blocks) {
+    uint32_t broadcast_src[4] __attribute__((aligned(16))) = {pattern};
+    const uint32_t* src = broadcast_src;
+
+    __asm__ volatile(
+        "ee.vldbc.32     q0, %2\n"
+        "1:\n"
+        "ee.vst.128.ip   q0, %0, 16\n"
+        "addi            %1, %1, -1\n"
+        "bnez            %1, 1b\n"
+        : "+r"(dst), "+r"(blocks)
+        : "r"(src)
+        : "memory");
+}
+#endif
+
+void mk_fill32(void* dst, uint32_t pattern, size_t bytes) {
+    uint8_t* d = dst;
+    size_t i = 0;
+
+#if MK_USE_PIE
+    size_t head = head_bytes(d, bytes, 16);
+    for (; i < head; i++) {
+        d[i] = pattern_byte(pattern, i);
+    }
+    size_t blocks = (bytes - i) / 16;
+    if (blocks > 0) {
+        pie_fill_blocks(d + i, pattern_at(pattern, i), blocks);
+        i += blocks * 16;
+    }
+#else
+    size_t head = head_bytes(d, bytes, WORD_BYTES);
+    for (; i < head; i++) {
+        d[i] = pattern_byte(pattern, i);
+    }
+    mk_word_t w = word_pattern(pattern, i);
+    for (; i + 4 * WORD_BYTES <= bytes; i += 4 * WORD_BYTES) {
+        mk_word_t* p = (mk_word_t*)(d + i);
+        p[0] = w;
+        p[1] = w;
+        p[2] = w;
+        p[3] = w;
+    }
+    for (; i + WORD_BYTES <= bytes; i += WORD_BYTES) {
+        *(mk_word_t*)(d + i) = w;
+    }
+#endif
+
+    for (; i < bytes; i++) {
+        d[i] = pattern_byte(pattern, i);
+    }
+}
+
+bool mk_verify32(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset) {
+    const uint8_t* s = src;
+    size_t i = 0;
+    size_t head = head_bytes(s, bytes, WORD_BYTES);
+
+    for (; i < head; i++) {
+        if (s[i] != pattern_byte(pattern, i)) goto mismatch;
+    }
+
+    mk_word_t w = word_pattern(pattern, i);
+    for (; i + WORD_BYTES <= bytes; i += WORD_BYTES) {
+        if (*(const mk_word_t*)(s + i) != w) break;
+    }
+
+    // Tail, or the word that failed
+    for (; i < bytes; i++) {
+        if (s[i] != pattern_byte(pattern, i)) goto mismatch;
+    }
+    return true;
+
+mismatch:
+    if (bad_offset) *bad_offset = i;
+    return false;
+}
+
+uint32_t mk_checksum32(const void* src, size_t bytes) {
+    const uint8_t* s = src;
+
+    // Word sums only line up with the buffer start when it is 4-aligned
+    if ((uintptr_t)s & 3) {
+        return mk_checksum32_scalar(src, bytes);
+    }
+
+    const mk_u32_t* words = (const mk_u32_t*)s;
+    size_t count = bytes / 4;
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        s0 += words[i];
+        s1 += words[i + 1];
+        s2 += words[i + 2];
+        s3 += words[i + 3];
+    }
+    for (; i < count; i++) {
+        s0 += words[i];
+    }
+
+    uint32_t sum = s0 + s1 + s2 + s3;
+    for (size_t b = count * 4; b < bytes; b++) {
+        sum += (uint32_t)s[b] << (8 * (b & 3));
+    }
+    return sum;
+}
+
+size_t mk_compare(const void* a, const void* b, size_t bytes) {
+    const uint8_t* pa = a;
+    const uint8_t* pb = b;
+    size_t i = 0;
+
+    // Word compare only when both share the same misalignment
+    if ((((uintptr_t)pa ^ (uintptr_t)pb) & (WORD_BYTES - 1)) == 0) {
+        size_t head = head_bytes(pa, bytes, WORD_BYTES);
+        for (; i < head; i++) {
+            if (pa[i] != pb[i]) return i;
+        }
+        for (; i + WORD_BYTES <= bytes; i += WORD_BYTES) {
+            if (*(const mk_word_t*)(pa + i) != *(const mk_word_t*)(pb + i)) break;
+        }
+    }
+
+    for (; i < bytes; i++) {
+        if (pa[i] != pb[i]) return i;
+    }
+    return bytes;
+}
+
+#endif
+
+// ═══ Benchmark ═══
+
+static volatile uint32_t mk_sink;
+
+static void print_rate(const char* kernel, const char* backend, size_t bytes, int passes, uint64_t ns) {
+    double gbps = ns ? (double)bytes * passes / ns : 0;
+    printf("%s,%s,%u,%.3f\n", kernel, backend, (unsigned)bytes, gbps);
+}
+
+void mk_run_benchmark(void* buf, size_t bytes, int passes) {
+    uint8_t* a = buf;
+    uint8_t* b = a + bytes;
+    const uint32_t pattern = 0xA5C3F00F;
+    uint64_t start;
+
+    printf("kernel,backend,bytes,gb_per_s\n");
+
+    for (int impl = 0; impl < 2; impl++) {
+        const char* name = impl ? MK_BACKEND_NAME : "scalar";
+        void (*fill)(void*, uint32_t, size_t) = impl ? mk_fill32 : mk_fill32_scalar;
+        bool (*verify)(const void*, uint32_t, size_t, size_t*) = impl ? mk_verify32 : mk_verify32_scalar;
+        uint32_t (*checksum)(const void*, size_t) = impl ? mk_checksum32 : mk_checksum32_scalar;
+        size_t (*compare)(const void*, const void*, size_t) = impl ? mk_compare : mk_compare_scalar;
+
+        start = mk_now_ns();
+        for (int p = 0; p < passes; p++) {
+            fill(a, pattern + p, bytes);
+        }
+        print_rate("fill", name, bytes, passes, mk_now_ns() - start);
+
+        uint32_t ok = 0;
+        start = mk_now_ns();
+        for (int p = 0; p < passes; p++) {
+            ok += verify(a, pattern + passes - 1, bytes, NULL);
+        }
+        print_rate("verify", name, bytes, passes, mk_now_ns() - start);
+
+        uint32_t sum = 0;
+        start = mk_now_ns();
+        for (int p = 0; p < passes; p++) {
+            sum += checksum(a, bytes);
+        }
+        print_rate("checksum", name, bytes, passes, mk_now_ns() - start);
+
+        memcpy(b, a, bytes);
+        size_t same = 0;
+        start = mk_now_ns();
+        for (int p = 0; p < passes; p++) {
+            same += compare(a, b, bytes);
+        }
+        print_rate("compare", name, bytes, passes, mk_now_ns() - start);
+
+        mk_sink = ok + sum + (uint32_t)same;
+    }
+}
+
+#ifndef ESP_PLATFORM
+// Host build: gcc -O2 -mavx2 -o mem_kernels mem_kernels.c && ./mem_kernels [kb]
+int main(int argc, char** argv) {
+    size_t bytes = (argc > 1 ? strtoul(argv[1], NULL, 10) : 256) * 1024;
+    void* buf = malloc(2 * bytes);
+    if (!buf) return 1;
+    int passes = (int)(((size_t)1 << 30) / bytes);
+    mk_run_benchmark(buf, bytes, passes > 0 ? passes : 1);
+    free(buf);
+    return 0;
+}
+#endif
@@ -0,0 +1,62 @@
+#ifndef MEM_KERNELS_H
+#define MEM_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+// Fill / verify / checksum / compare kernels for memory test patterns.
+// A 32-bit pattern is laid out little-endian from the start of the buffer,
+// so byte i holds (pattern >> (8 * (i % 4))) & 0xFF whatever the alignment.
+//
+// The backend is chosen at build time:
+//   AVX2 or SSE2 on the host (from the compiler's -m flags)
+//   PIE 128-bit stores for fill on ESP32-S3, word-wide for the rest
+//   word-wide (native register width) everywhere else
+// Define MK_FORCE_WORD or MK_FORCE_SCALAR to override.
+
+#if defined(MK_FORCE_SCALAR)
+#define MK_BACKEND_NAME "scalar"
+#elif defined(MK_FORCE_WORD)
+#define MK_BACKEND_NAME "word"
+#elif defined(__AVX2__)
+#define MK_USE_AVX2 1
+#define MK_BACKEND_NAME "avx2"
+#elif defined(__SSE2__)
+#define MK_USE_SSE2 1
+#define MK_BACKEND_NAME "sse2"
+#elif defined(CONFIG_IDF_TARGET_ESP32S3) && CONFIG_IDF_TARGET_ESP32S3
+#define MK_USE_PIE 1
+#define MK_BACKEND_NAME "pie"
+#else
+#define MK_BACKEND_NAME "word"
+#endif
+
+void mk_fill32(void* dst, uint32_t pattern, size_t bytes);
+
+// True if every byte matches; otherwise *bad_offset (if given) is the first mismatch
+bool mk_verify32(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset);
+
+// Sum of the little-endian 32-bit words (tail zero-padded); detects
+// corruption cheaply, not a CRC
+uint32_t mk_checksum32(const void* src, size_t bytes);
+
+// Offset of the first differing byte, or bytes if equal
+size_t mk_compare(const void* a, const void* b, size_t bytes);
+
+// Byte-at-a-time reference versions, always built
+void mk_fill32_scalar(void* dst, uint32_t pattern, size_t bytes);
+bool mk_verify32_scalar(const void* src, uint32_t pattern, size_t bytes, size_t* bad_offset);
+uint32_t mk_checksum32_scalar(const void* src, size_t bytes);
+size_t mk_compare_scalar(const void* a, const void* b, size_t bytes);
+
+// GB/s of each kernel, scalar vs selected backend, printed as CSV:
+//   kernel,backend,bytes,gb_per_s
+// buf must hold 2 * bytes (compare uses both halves)
+void mk_run_benchmark(void* buf, size_t bytes, int passes);
+
+#endif
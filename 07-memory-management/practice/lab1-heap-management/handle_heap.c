@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "handle_heap.h"
+
+static const char *TAG = "HANDLE_HEAP";
+
+#define HANDLE_ALIGN        8
+#define HANDLE_FREE         0xFFFF
+#define HANDLE_BLOCK_MAGIC  0x4842      // "HB"
+#define HANDLE_MIN_SPLIT    (sizeof(handle_block_t) + HANDLE_ALIGN)
+
+// Header in front of every block; blocks are laid out back to back from
+// base to top so the arena can be walked in address order.
+typedef struct {
+    uint32_t size;      // Total block size including this header
+    uint16_t handle;    // Handle table index, HANDLE_FREE for holes
+    uint16_t magic;
+} handle_block_t;
+
+typedef struct {
+    uint8_t* data;
+    uint32_t size;
+    uint16_t generation;
+    uint8_t pin_count;
+    bool in_use;
+} handle_entry_t;
+
+struct handle_heap {
+    const char* name;
+    uint8_t* base;
+    uint8_t* top;       // End of the last block
+    uint8_t* end;
+    size_t used_bytes;
+
+    handle_entry_t table[HANDLE_TABLE_SIZE];
+
+    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t compaction_done;
+    TaskHandle_t compactor;
+
+    handle_heap_stats_t stats;
+};
+
+static inline handle_block_t* block_at(uint8_t* p) {
+    return (handle_block_t*)p;
+}
+
+static inline size_t block_total(size_t payload) {
+    return (payload + sizeof(handle_block_t) + HANDLE_ALIGN - 1) & ~(size_t)(HANDLE_ALIGN - 1);
+}
+
+static handle_entry_t* lookup_entry(handle_heap_t* heap, mem_handle_t handle) {
+    uint32_t index = (handle & 0xFFFF) - 1;
+    if (index >= HANDLE_TABLE_SIZE) return NULL;
+
+    handle_entry_t* entry = &heap->table[index];
+    if (!entry->in_use || entry->generation != (handle >> 16)) return NULL;
+    return entry;
+}
+
+// Merge any holes that directly follow the hole at p
+static void coalesce_holes(handle_heap_t* heap, uint8_t* p) {
+    handle_block_t* hole = block_at(p);
+    while (p + hole->size < heap->top &&
+           block_at(p + hole->size)->handle == HANDLE_FREE) {
+        hole->size += block_at(p + hole->size)->size;
+    }
+}
+
+static void write_hole(uint8_t* p, size_t size) {
+    handle_block_t* hole = block_at(p);
+    hole->size = size;
+    hole->handle = HANDLE_FREE;
+    hole->magic = HANDLE_BLOCK_MAGIC;
+}
+
+// First fit over holes, then bump from top (call with mutex held)
+static uint8_t* carve_block(handle_heap_t* heap, size_t need) {
+    uint8_t* p = heap->base;
+
+    while (p < heap->top) {
+        handle_block_t* block = block_at(p);
+
+        if (block->handle == HANDLE_FREE) {
+            coalesce_holes(heap, p);
+            if (p + block->size == heap->top) {
+                heap->top = p;  // Trailing hole folds back into the top range
+                break;
+            }
+            if (block->size >= need) {
+                if (block->size - need >= HANDLE_MIN_SPLIT) {
+                    write_hole(p + need, block->size - need);
+                    block->size = need;
+                }
+                return p;
+            }
+        }
+        p += block->size;
+    }
+
+    if ((size_t)(heap->end - heap->top) >= need) {
+        p = heap->top;
+        heap->top += need;
+        block_at(p)->size = need;
+        return p;
+    }
+
+    return NULL;
+}
+
+static size_t largest_free_locked(handle_heap_t* heap) {
+    size_t largest = heap->end - heap->top;
+    size_t run = 0;
+
+    for (uint8_t* p = heap->base; p < heap->top; p += block_at(p)->size) {
+        if (block_at(p)->handle == HANDLE_FREE) {
+            run += block_at(p)->size;
+            if (run > largest) largest = run;
+        } else {
+            run = 0;
+        }
+    }
+    return largest;
+}
+
+// Counts the attempt under the mutex. A failed first try sets *compact if
+// compaction may help (allowed, and enough bytes free overall); any other
+// failure is final and counted as one.
+static mem_handle_t try_alloc(handle_heap_t* heap, size_t size, bool first_try,
+                              bool can_compact, bool* compact) {
+    mem_handle_t handle = MEM_HANDLE_INVALID;
+    *compact = false;
+
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+    if (first_try) heap->stats.alloc_attempts++;
+
+    int index = -1;
+    for (int i = 0; i < HANDLE_TABLE_SIZE; i++) {
+        if (!heap->table[i].in_use) {
+            index = i;
+            break;
+        }
+    }
+
+    uint8_t* p = (index >= 0) ? carve_block(heap, block_total(size)) : NULL;
+    if (p) {
+        handle_block_t* block = block_at(p);
+        block->handle = index;
+        block->magic = HANDLE_BLOCK_MAGIC;
+
+        handle_entry_t* entry = &heap->table[index];
+        entry->data = p + sizeof(handle_block_t);
+        entry->size = size;
+        entry->pin_count = 0;
+        entry->in_use = true;
+
+        heap->used_bytes += block->size;
+        heap->stats.live_handles++;
+        handle = ((mem_handle_t)entry->generation << 16) | (index + 1);
+        if (first_try) {
+            heap->stats.alloc_first_try++;
+        } else {
+            heap->stats.alloc_after_compaction++;
+        }
+    } else {
+        size_t free_bytes = heap->stats.capacity - heap->used_bytes;
+        *compact = first_try && can_compact && free_bytes >= block_total(size);
+        if (!*compact) heap->stats.alloc_failures++;
+    }
+
+    xSemaphoreGive(heap->mutex);
+    return handle;
+}
+
+handle_heap_t* handle_heap_create(const char* name, size_t size, uint32_t caps) {
+    handle_heap_t* heap = heap_caps_calloc(1, sizeof(handle_heap_t), MALLOC_CAP_INTERNAL);
+    if (!heap) return NULL;
+
+    size = size & ~(size_t)(HANDLE_ALIGN - 1);
+    heap->base = heap_caps_malloc(size, caps);
+    heap->mutex = xSemaphoreCreateMutex();
+    heap->compaction_done = xSemaphoreCreateBinary();
+
+    if (!heap->base || !heap->mutex || !heap->compaction_done) {
+        ESP_LOGE(TAG, "Failed to create %s handle heap (%d bytes)", name, (int)size);
+        if (heap->base) heap_caps_free(heap->base);
+        if (heap->mutex) vSemaphoreDelete(heap->mutex);
+        if (heap->compaction_done) vSemaphoreDelete(heap->compaction_done);
+        heap_caps_free(heap);
+        return NULL;
+    }
+
+    heap->name = name;
+    heap->top = heap->base;
+    heap->end = heap->base + size;
+    heap->stats.capacity = size;
+
+    ESP_LOGI(TAG, "✅ %s handle heap: %d bytes, %d handles", name, (int)size, HANDLE_TABLE_SIZE);
+    return heap;
+}
+
+mem_handle_t handle_heap_alloc(handle_heap_t* heap, size_t size, TickType_t timeout) {
+    if (!heap || size == 0) return MEM_HANDLE_INVALID;
+
+    bool compact;
+    mem_handle_t handle = try_alloc(heap, size, true, heap->compactor && timeout > 0, &compact);
+    if (handle != MEM_HANDLE_INVALID || !compact) {
+        return handle;
+    }
+
+    // Enough space overall but not contiguous: let the compactor run
+    xSemaphoreTake(heap->compaction_done, 0);
+    xTaskNotifyGive(heap->compactor);
+    if (xSemaphoreTake(heap->compaction_done, timeout) == pdTRUE) {
+        return try_alloc(heap, size, false, false, &compact);
+    }
+
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+    heap->stats.alloc_failures++;
+    xSemaphoreGive(heap->mutex);
+    return MEM_HANDLE_INVALID;
+}
+
+bool handle_heap_free(handle_heap_t* heap, mem_handle_t handle) {
+    if (!heap) return false;
+
+    bool result = false;
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+
+    handle_entry_t* entry = lookup_entry(heap, handle);
+    if (!entry) {
+        ESP_LOGW(TAG, "⚠️ Freeing stale handle 0x%08lX", (unsigned long)handle);
+    } else if (entry->pin_count > 0) {
+        ESP_LOGE(TAG, "🚨 Handle 0x%08lX freed while pinned!", (unsigned long)handle);
+    } else {
+        uint8_t* p = entry->data - sizeof(handle_block_t);
+        handle_block_t* block = block_at(p);
+
+        block->handle = HANDLE_FREE;
+        heap->used_bytes -= block->size;
+        if (p + block->size == heap->top) {
+            heap->top = p;
+        }
+
+        entry->in_use = false;
+        entry->data = NULL;
+        entry->generation++;
+        heap->stats.live_handles--;
+        result = true;
+    }
+
+    xSemaphoreGive(heap->mutex);
+    return result;
+}
+
+void* handle_pin(handle_heap_t* heap, mem_handle_t handle) {
+    if (!heap) return NULL;
+
+    void* ptr = NULL;
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+
+    handle_entry_t* entry = lookup_entry(heap, handle);
+    if (entry && entry->pin_count < UINT8_MAX) {
+        entry->pin_count++;
+        ptr = entry->data;
+    }
+
+    xSemaphoreGive(heap->mutex);
+    return ptr;
+}
+
+void handle_unpin(handle_heap_t* heap, mem_handle_t handle) {
+    if (!heap) return;
+
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+
+    handle_entry_t* entry = lookup_entry(heap, handle);
+    if (entry && entry->pin_count > 0) {
+        entry->pin_count--;
+    }
+
+    xSemaphoreGive(heap->mutex);
+}
+
+size_t handle_size(handle_heap_t* heap, mem_handle_t handle) {
+    if (!heap) return 0;
+
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+    handle_entry_t* entry = lookup_entry(heap, handle);
+    size_t size = entry ? entry->size : 0;
+    xSemaphoreGive(heap->mutex);
+
+    return size;
+}
+
+// Moves at most one block; returns false when the pass is complete
+static bool compact_step(handle_heap_t* heap, size_t* cursor) {
+    uint8_t* p = heap->base + *cursor;
+
+    // Find the next hole
+    while (p < heap->top && block_at(p)->handle != HANDLE_FREE) {
+        p += block_at(p)->size;
+    }
+    if (p >= heap->top) return false;
+
+    coalesce_holes(heap, p);
+    size_t hole_size = block_at(p)->size;
+    uint8_t* next = p + hole_size;
+
+    if (next >= heap->top) {
+        heap->top = p;
+        return false;
+    }
+
+    handle_block_t* block = block_at(next);
+    handle_entry_t* entry = &heap->table[block->handle];
+
+    if (entry->pin_count > 0) {
+        // Pinned blocks stay put; continue after them
+        heap->stats.pinned_skips++;
+        *cursor = (next + block->size) - heap->base;
+        return true;
+    }
+
+    size_t block_size = block->size;
+    memmove(p, next, block_size);
+    entry->data = p + sizeof(handle_block_t);
+    write_hole(p + block_size, hole_size);
+
+    heap->stats.blocks_moved++;
+    heap->stats.bytes_moved += block_size;
+    *cursor = (p + block_size) - heap->base;
+    return true;
+}
+
+void handle_heap_compact(handle_heap_t* heap) {
+    if (!heap) return;
+
+    size_t cursor = 0;
+    bool more = true;
+
+    while (more) {
+        xSemaphoreTake(heap->mutex, portMAX_DELAY);
+        uint64_t start = esp_timer_get_time();
+        more = compact_step(heap, &cursor);
+        heap->stats.compaction_time_us += esp_timer_get_time() - start;
+        xSemaphoreGive(heap->mutex);
+
+        // Let pinning tasks in between moves
+        taskYIELD();
+    }
+
+    heap->stats.compactions++;
+}
+
+void handle_heap_compactor_task(void *pvParameters) {
+    handle_heap_t* heap = (handle_heap_t*)pvParameters;
+    heap->compactor = xTaskGetCurrentTaskHandle();
+
+    ESP_LOGI(TAG, "🧹 Compactor for %s started", heap->name);
+
+    while (1) {
+        // Run on demand from a failed allocation, or periodically when idle
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(5000));
+
+        xSemaphoreTake(heap->mutex, portMAX_DELAY);
+        bool fragmented = largest_free_locked(heap) < heap->stats.capacity - heap->used_bytes;
+        xSemaphoreGive(heap->mutex);
+
+        if (fragmented) {
+            handle_heap_compact(heap);
+        }
+        xSemaphoreGive(heap->compaction_done);
+    }
+}
+
+void handle_heap_get_stats(handle_heap_t* heap, handle_heap_stats_t* stats) {
+    if (!heap || !stats) return;
+
+    xSemaphoreTake(heap->mutex, portMAX_DELAY);
+    *stats = heap->stats;
+    stats->used_bytes = heap->used_bytes;
+    stats->largest_free = largest_free_locked(heap);
+    xSemaphoreGive(heap->mutex);
+}
+
+void handle_heap_print_stats(handle_heap_t* heap) {
+    if (!heap) return;
+
+    handle_heap_stats_t s;
+    handle_heap_get_stats(heap, &s);
+
+    ESP_LOGI(TAG, "\n🧹 ═══ HANDLE HEAP (%s) ═══", heap->name);
+    ESP_LOGI(TAG, "Used / Capacity:      %d / %d bytes (%d handles)",
+             (int)s.used_bytes, (int)s.capacity, (int)s.live_handles);
+    ESP_LOGI(TAG, "Largest Free Range:   %d bytes", (int)s.largest_free);
+    ESP_LOGI(TAG, "Alloc Attempts:       %lu", (unsigned long)s.alloc_attempts);
+    ESP_LOGI(TAG, "  First Try:          %lu", (unsigned long)s.alloc_first_try);
+    ESP_LOGI(TAG, "  After Compaction:   %lu", (unsigned long)s.alloc_after_compaction);
+    ESP_LOGI(TAG, "  Failed:             %lu", (unsigned long)s.alloc_failures);
+    ESP_LOGI(TAG, "Compactions:          %lu (%lu blocks moved, %lu pinned skips)",
+             (unsigned long)s.compactions, (unsigned long)s.blocks_moved,
+             (unsigned long)s.pinned_skips);
+    if (s.compaction_time_us > 0) {
+        ESP_LOGI(TAG, "Compaction Throughput: %.1f KB/s (%llu bytes in %llu μs)",
+                 (s.bytes_moved / 1024.0) / (s.compaction_time_us / 1000000.0),
+                 s.bytes_moved, s.compaction_time_us);
+    }
+    ESP_LOGI(TAG, "═══════════════════════════════");
+}
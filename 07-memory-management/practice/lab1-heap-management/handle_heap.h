@@ -0,0 +1,52 @@
+#ifndef HANDLE_HEAP_H
+#define HANDLE_HEAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// Relocatable blocks addressed through handles. A pointer is only valid
+// between handle_pin() and handle_unpin(); unpinned blocks may be moved
+// by the compactor to merge free holes into one contiguous range.
+
+#define HANDLE_TABLE_SIZE   64
+#define MEM_HANDLE_INVALID  0
+
+typedef uint32_t mem_handle_t;
+typedef struct handle_heap handle_heap_t;
+
+typedef struct {
+    size_t capacity;
+    size_t used_bytes;
+    size_t largest_free;        // Largest contiguous free range
+    size_t live_handles;
+    uint32_t alloc_attempts;
+    uint32_t alloc_first_try;   // Succeeded without compaction
+    uint32_t alloc_after_compaction;
+    uint32_t alloc_failures;
+    uint32_t compactions;
+    uint32_t blocks_moved;
+    uint32_t pinned_skips;      // Blocks left in place because they were pinned
+    uint64_t bytes_moved;
+    uint64_t compaction_time_us;
+} handle_heap_stats_t;
+
+handle_heap_t* handle_heap_create(const char* name, size_t size, uint32_t caps);
+
+// Waits up to timeout for the compactor when the heap is fragmented
+mem_handle_t handle_heap_alloc(handle_heap_t* heap, size_t size, TickType_t timeout);
+bool handle_heap_free(handle_heap_t* heap, mem_handle_t handle);
+
+void* handle_pin(handle_heap_t* heap, mem_handle_t handle);
+void handle_unpin(handle_heap_t* heap, mem_handle_t handle);
+size_t handle_size(handle_heap_t* heap, mem_handle_t handle);
+
+// Runs a full compaction pass, releasing the lock between block moves
+void handle_heap_compact(handle_heap_t* heap);
+void handle_heap_compactor_task(void *pvParameters);
+
+void handle_heap_get_stats(handle_heap_t* heap, handle_heap_stats_t* stats);
+void handle_heap_print_stats(handle_heap_t* heap);
+
+#endif
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -10,7 +11,14 @@
 #include "esp_heap_caps.h"
 #include "esp_timer.h"
 #include "esp_system.h"
+#include "esp_cpu.h"
 #include "driver/gpio.h"
+#include "tlsf_heap.h"
+#include "handle_heap.h"
+#include "mem_kernels.h"
+#include "task_heap.h"
+#include "heap_snapshot.h"
+#include "mem_telemetry.h"
 
 static const char *TAG = "HEAP_MGMT";
 
@@ -27,16 +35,56 @@ static const char *TAG = "HEAP_MGMT";
 #define FRAGMENTATION_THRESHOLD 0.3      // 30% fragmentation
 #define MAX_ALLOCATIONS         100
 
+// TLSF backend for tracked_malloc (deterministic O(1) allocation)
+#define USE_TLSF_BACKEND            1
+#define TLSF_INTERNAL_REGION_SIZE   (48 * 1024)
+#define TLSF_SPIRAM_REGION_SIZE     (256 * 1024)
+#define TLSF_BENCH_ITERATIONS       2000
+
+// Opt-in relocatable (handle-based) heap with background compaction
+#define USE_HANDLE_HEAP             1
+#define HANDLE_HEAP_SPIRAM_SIZE     (256 * 1024)
+#define HANDLE_HEAP_INTERNAL_SIZE   (96 * 1024)
+#define HANDLE_FRAG_SCALE           2     // Size multiplier for fragmentation blocks
+
+// Per-task accounting: quotas for the stress test, top-N in the monitor
+#define STRESS_SOFT_QUOTA           (12 * 1024)
+#define STRESS_HARD_QUOTA           (16 * 1024)
+#define TASK_HEAP_REPORT_TOP        5
+
+// Leak detection by snapshot diff: a call site is a suspect once its live
+// bytes have grown over this many consecutive monitor cycles
+#define LEAK_GROWTH_STREAK          3
+#define SNAPSHOT_CHUNK_SLOTS        16    // Slots copied per memory_mutex hold
+#define STREAM_HEAP_SNAPSHOTS       1     // Print HSNAP lines for host-side diffing
+
+// Free-memory time series; the sample period sets every rollup resolution
+#define TELEMETRY_PERIOD_MS         1000
+#define TELEMETRY_PRIORITY          3
+#define STREAM_TELEMETRY            1     // Print MTEL lines
+#define TELEMETRY_EXPORT_EVERY      6     // Monitor cycles between exports
+
 // Memory allocation tracking
 typedef struct {
     void* ptr;
     size_t size;
     uint32_t caps;
     const char* description;
+    void* caller;               // Return address into the allocating code
     uint64_t timestamp;
     bool is_active;
 } memory_allocation_t;
 
+// Prefix on every tracked block so tracked_free can credit the owning
+// task without a lookup; keeps the payload pointer-aligned
+typedef struct {
+    uint32_t size;
+    uint16_t account;
+    uint16_t magic;
+} alloc_header_t;
+
+#define ALLOC_HEADER_MAGIC  0xA11C
+
 // Memory statistics
 typedef struct {
     uint32_t total_allocations;
@@ -55,6 +103,17 @@ static memory_allocation_t allocations[MAX_ALLOCATIONS];
 static memory_stats_t stats = {0};
 static SemaphoreHandle_t memory_mutex;
 static bool memory_monitoring_enabled = true;
+static handle_heap_t* relocatable_heap = NULL;
+
+// Large allocation success rate (general heap vs handle heap)
+static uint32_t large_attempts = 0;
+static uint32_t large_successes = 0;
+
+// Previous and current leak-detection snapshots, swapped every cycle
+static heap_snapshot_t leak_snapshots[2];
+static heap_snapshot_delta_t leak_deltas[HEAP_SNAPSHOT_MAX_DELTAS];
+static int leak_snapshot_current = 0;
+static uint32_t leak_snapshot_id = 0;
 
 // Memory monitoring functions
 int find_free_allocation_slot(void) {
@@ -75,8 +134,52 @@ int find_allocation_by_ptr(void* ptr) {
     return -1;
 }
 
+// Strip the call-window bits Xtensa keeps in the top of return addresses
+static inline void* caller_address(void* return_address) {
+#ifdef __XTENSA__
+    return (void*)(((uintptr_t)return_address & 0x3FFFFFFF) | 0x40000000);
+#else
+    return return_address;
+#endif
+}
+
 void* tracked_malloc(size_t size, uint32_t caps, const char* description) {
-    void* ptr = heap_caps_malloc(size, caps);
+    void* ptr = NULL;
+    void* caller = caller_address(__builtin_return_address(0));
+    uint16_t account;
+    
+    // Quota check is lock-free and happens before touching the allocator
+    if (!task_heap_charge(size, &account)) {
+        if (memory_monitoring_enabled && memory_mutex &&
+            xSemaphoreTake(memory_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+            stats.allocation_failures++;
+            xSemaphoreGive(memory_mutex);
+        }
+        ESP_LOGW(TAG, "🚫 %s over heap quota: %d bytes denied (%s)",
+                 pcTaskGetName(NULL), (int)size, description);
+        return NULL;
+    }
+    
+    size_t total = size + sizeof(alloc_header_t);
+    alloc_header_t* header = NULL;
+#if USE_TLSF_BACKEND
+    // Serve from a TLSF region with matching caps; fall back to the general heap
+    tlsf_heap_t* tlsf = tlsf_heap_for_caps(caps);
+    if (tlsf) {
+        header = tlsf_heap_malloc(tlsf, total);
+    }
+    if (!header)
+#endif
+    header = heap_caps_malloc(total, caps);
+    
+    if (header) {
+        header->size = size;
+        header->account = account;
+        header->magic = ALLOC_HEADER_MAGIC;
+        ptr = header + 1;
+    } else {
+        task_heap_uncharge(account, size);
+    }
     
     if (memory_monitoring_enabled && memory_mutex) {
         if (xSemaphoreTake(memory_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
@@ -87,6 +190,7 @@ void* tracked_malloc(size_t size, uint32_t caps, const char* description) {
                     allocations[slot].size = size;
                     allocations[slot].caps = caps;
                     allocations[slot].description = description;
+                    allocations[slot].caller = caller;
                     allocations[slot].timestamp = esp_timer_get_time();
                     allocations[slot].is_active = true;
                     
@@ -139,7 +243,22 @@ void tracked_free(void* ptr, const char* description) {
         }
     }
     
-    heap_caps_free(ptr);
+    alloc_header_t* header = (alloc_header_t*)ptr - 1;
+    if (header->magic != ALLOC_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "❌ %p was not allocated by tracked_malloc (%s)", ptr, description);
+        return;
+    }
+    header->magic = 0;
+    task_heap_uncharge(header->account, header->size);
+    
+#if USE_TLSF_BACKEND
+    tlsf_heap_t* tlsf = tlsf_heap_from_ptr(header);
+    if (tlsf) {
+        tlsf_heap_free(tlsf, header);
+        return;
+    }
+#endif
+    heap_caps_free(header);
 }
 
 // Memory analysis functions
@@ -233,42 +352,86 @@ void print_allocation_summary(void) {
     }
 }
 
+// Copies the table a chunk at a time so memory_mutex is never held for
+// the whole walk; grouping happens outside the lock. An allocation freed
+// and replaced in an already-copied slot during the walk is missed.
+static bool capture_heap_snapshot(heap_snapshot_t* snap) {
+    memory_allocation_t chunk[SNAPSHOT_CHUNK_SLOTS];
+    
+    heap_snapshot_begin(snap, leak_snapshot_id++, esp_timer_get_time());
+    for (int base = 0; base < MAX_ALLOCATIONS; base += SNAPSHOT_CHUNK_SLOTS) {
+        int n = MAX_ALLOCATIONS - base;
+        if (n > SNAPSHOT_CHUNK_SLOTS) n = SNAPSHOT_CHUNK_SLOTS;
+        
+        if (xSemaphoreTake(memory_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+            snap->complete = false;
+            continue;
+        }
+        memcpy(chunk, &allocations[base], n * sizeof(memory_allocation_t));
+        xSemaphoreGive(memory_mutex);
+        
+        for (int i = 0; i < n; i++) {
+            if (chunk[i].is_active) {
+                heap_snapshot_add(snap, (uintptr_t)chunk[i].caller, chunk[i].description, chunk[i].size);
+            }
+        }
+    }
+    return snap->complete;
+}
+
 void detect_memory_leaks(void) {
     if (!memory_mutex) return;
     
-    if (xSemaphoreTake(memory_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
-        uint64_t current_time = esp_timer_get_time();
+    heap_snapshot_t* previous = &leak_snapshots[leak_snapshot_current];
+    heap_snapshot_t* current = &leak_snapshots[leak_snapshot_current ^ 1];
+    bool have_previous = previous->timestamp_us != 0;
+    
+    ESP_LOGI(TAG, "\n🔍 ═══ MEMORY LEAK DETECTION ═══");
+    
+    if (!capture_heap_snapshot(current)) {
+        // A partial snapshot would look like shrinkage; keep the old baseline
+        ESP_LOGW(TAG, "⚠️ Snapshot %lu incomplete, skipping diff", (unsigned long)current->id);
+        return;
+    }
+    if (current->dropped > 0) {
+        ESP_LOGW(TAG, "⚠️ %d allocations did not fit in the snapshot", current->dropped);
+    }
+#if STREAM_HEAP_SNAPSHOTS
+    heap_snapshot_print(current);
+#endif
+    
+    if (have_previous) {
+        int count = heap_snapshot_diff(previous, current, leak_deltas, HEAP_SNAPSHOT_MAX_DELTAS);
         int leak_count = 0;
         size_t leaked_bytes = 0;
         
-        ESP_LOGI(TAG, "
-🔍 ═══ MEMORY LEAK DETECTION ═══");
-        
-        for (int i = 0; i < MAX_ALLOCATIONS; i++) {
-            if (allocations[i].is_active) {
-                uint64_t age_ms = (current_time - allocations[i].timestamp) / 1000;
-                
-                // Consider allocations older than 30 seconds as potential leaks
-                if (age_ms > 30000) {
-                    ESP_LOGW(TAG, "POTENTIAL LEAK: %d bytes at %p (%s) - Age: %llu ms",
-                             (int)allocations[i].size, allocations[i].ptr,
-                             allocations[i].description, age_ms);
-                    leak_count++;
-                    leaked_bytes += allocations[i].size;
-                }
+        if (count > 0) {
+            ESP_LOGI(TAG, "Changes since snapshot %lu:", (unsigned long)previous->id);
+            heap_snapshot_print_diff(leak_deltas, count);
+        }
+        for (int i = 0; i < current->group_count; i++) {
+            heap_snapshot_group_t* group = &current->groups[i];
+            if (group->growth_streak >= LEAK_GROWTH_STREAK) {
+                ESP_LOGW(TAG, "POTENTIAL LEAK: %s at %p - %d blocks, %lu bytes, grew %d cycles in a row",
+                         group->tag, (void*)group->site, group->count,
+                         (unsigned long)group->bytes, group->growth_streak);
+                leak_count++;
+                leaked_bytes += group->bytes;
             }
         }
         
         if (leak_count > 0) {
-            ESP_LOGW(TAG, "Found %d potential leaks totaling %d bytes", leak_count, (int)leaked_bytes);
+            ESP_LOGW(TAG, "Found %d growing call sites holding %d bytes", leak_count, (int)leaked_bytes);
             gpio_set_level(LED_MEMORY_ERROR, 1);
         } else {
             ESP_LOGI(TAG, "No memory leaks detected");
             gpio_set_level(LED_MEMORY_ERROR, 0);
         }
-        
-        xSemaphoreGive(memory_mutex);
+    } else {
+        ESP_LOGI(TAG, "Baseline snapshot %lu: %d call-site groups", (unsigned long)current->id, current->group_count);
     }
+    
+    leak_snapshot_current ^= 1;
 }
 
 // Test tasks
@@ -377,7 +540,9 @@ void large_allocation_test_task(void *pvParameters) {
             large_ptr = tracked_malloc(large_size, MALLOC_CAP_SPIRAM, "LargeSPIRAM");
         }
         
+        large_attempts++;
         if (large_ptr) {
+            large_successes++;
             ESP_LOGI(TAG, "🐘 Large allocation successful: %p", large_ptr);
             
             // Test memory access performance
@@ -398,12 +563,79 @@ void large_allocation_test_task(void *pvParameters) {
             analyze_memory_status();
         }
         
+#if USE_HANDLE_HEAP
+        if (relocatable_heap) {
+            // Same request scaled to 25-75% of the handle heap, so the result
+            // reflects fragmentation rather than capacity
+            handle_heap_stats_t hs;
+            handle_heap_get_stats(relocatable_heap, &hs);
+            size_t handle_request = (large_size * hs.capacity) / 200000;
+            
+            mem_handle_t handle = handle_heap_alloc(relocatable_heap, handle_request,
+                                                    pdMS_TO_TICKS(2000));
+            if (handle != MEM_HANDLE_INVALID) {
+                void* ptr = handle_pin(relocatable_heap, handle);
+                memset(ptr, 0xFF, handle_request);
+                handle_unpin(relocatable_heap, handle);
+                
+                ESP_LOGI(TAG, "🐘 Handle allocation successful: %d bytes", (int)handle_request);
+                vTaskDelay(pdMS_TO_TICKS(1000));
+                handle_heap_free(relocatable_heap, handle);
+            } else {
+                ESP_LOGW(TAG, "🐘 Handle allocation of %d bytes failed (largest free %d)",
+                         (int)handle_request, (int)hs.largest_free);
+            }
+        }
+#endif
+        
         vTaskDelay(pdMS_TO_TICKS(15000)); // Wait 15 seconds before next attempt
     }
 }
 
+// Keeps the handle heap fragmented: same sizes as memory_pool_test_task, but
+// only every other block is released per cycle so holes stay behind
+void handle_fragmentation_task(void *pvParameters) {
+    ESP_LOGI(TAG, "🧩 Handle heap fragmentation test started");
+    
+    const size_t pool_sizes[] = {64, 128, 256, 512, 1024};
+    mem_handle_t handles[5][10] = {{MEM_HANDLE_INVALID}};
+    uint32_t cycle = 0;
+    
+    while (1) {
+        for (int size_idx = 0; size_idx < 5; size_idx++) {
+            for (int i = 0; i < 10; i++) {
+                if (handles[size_idx][i] == MEM_HANDLE_INVALID) {
+                    size_t size = pool_sizes[size_idx] * HANDLE_FRAG_SCALE;
+                    handles[size_idx][i] = handle_heap_alloc(relocatable_heap, size, 0);
+                    
+                    void* ptr = handle_pin(relocatable_heap, handles[size_idx][i]);
+                    if (ptr) {
+                        memset(ptr, 0x55 + size_idx, size);
+                        handle_unpin(relocatable_heap, handles[size_idx][i]);
+                    }
+                }
+            }
+        }
+        
+        vTaskDelay(pdMS_TO_TICKS(5000));
+        
+        for (int size_idx = 0; size_idx < 5; size_idx++) {
+            for (int i = (cycle % 2); i < 10; i += 2) {
+                if (handles[size_idx][i] != MEM_HANDLE_INVALID) {
+                    handle_heap_free(relocatable_heap, handles[size_idx][i]);
+                    handles[size_idx][i] = MEM_HANDLE_INVALID;
+                }
+            }
+        }
+        
+        cycle++;
+        vTaskDelay(pdMS_TO_TICKS(8000));
+    }
+}
+
 void memory_monitor_task(void *pvParameters) {
     ESP_LOGI(TAG, "📊 Memory monitor started");
+    int cycle = 0;
     
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(10000)); // Check every 10 seconds
@@ -411,6 +643,24 @@ void memory_monitor_task(void *pvParameters) {
         analyze_memory_status();
         print_allocation_summary();
         detect_memory_leaks();
+        task_heap_print_top(TASK_HEAP_REPORT_TOP);
+        mem_telemetry_print_summary();
+#if STREAM_TELEMETRY
+        if (++cycle % TELEMETRY_EXPORT_EVERY == 0) {
+            mem_telemetry_export(1);
+        }
+#endif
+#if USE_TLSF_BACKEND
+        tlsf_heap_print_stats_all();
+#endif
+#if USE_HANDLE_HEAP
+        handle_heap_print_stats(relocatable_heap);
+#endif
+        if (large_attempts > 0) {
+            ESP_LOGI(TAG, "Large alloc success:  %lu/%lu (%.0f%%) via heap_caps",
+                     large_successes, large_attempts,
+                     (large_successes * 100.0) / large_attempts);
+        }
         
         // Check heap integrity
         if (!heap_caps_check_integrity_all(true)) {
@@ -458,31 +708,122 @@ void heap_integrity_test_task(void *pvParameters) {
             
             // Sequential write test
             for (int i = 0; i < 100; i++) {
-                memset(test_buf, i & 0xFF, test_size);
+                mk_fill32(test_buf, 0x01010101u * (i & 0xFF), test_size);
             }
             
             uint64_t write_time = esp_timer_get_time() - start;
             start = esp_timer_get_time();
             
             // Sequential read test
-            volatile uint8_t checksum = 0;
+            volatile uint32_t checksum = 0;
             for (int i = 0; i < 100; i++) {
-                uint8_t* buf = (uint8_t*)test_buf;
-                for (size_t j = 0; j < test_size; j++) {
-                    checksum += buf[j];
-                }
+                checksum += mk_checksum32(test_buf, test_size);
             }
             
             uint64_t read_time = esp_timer_get_time() - start;
             
-            ESP_LOGI(TAG, "🔍 Performance: Write %llu μs, Read %llu μs", 
-                     write_time, read_time);
+            ESP_LOGI(TAG, "🔍 Performance: Write %llu μs, Read %llu μs (%s kernels)", 
+                     write_time, read_time, MK_BACKEND_NAME);
+            
+            // Kernel throughput, scalar vs selected backend (CSV)
+            mk_run_benchmark(test_buf, test_size / 2, 100);
             
             tracked_free(test_buf, "PerfTest");
         }
     }
 }
 
+// TLSF vs default heap latency benchmark
+typedef void* (*bench_alloc_fn)(size_t size, uint32_t caps);
+typedef void (*bench_free_fn)(void* ptr);
+
+static uint32_t bench_alloc_cycles[TLSF_BENCH_ITERATIONS];
+static uint32_t bench_free_cycles[TLSF_BENCH_ITERATIONS];
+
+static void* bench_tlsf_malloc(size_t size, uint32_t caps) {
+    tlsf_heap_t* heap = tlsf_heap_for_caps(caps);
+    return heap ? tlsf_heap_malloc(heap, size) : NULL;
+}
+
+static void bench_tlsf_free(void* ptr) {
+    tlsf_heap_free(tlsf_heap_from_ptr(ptr), ptr);
+}
+
+static int compare_cycles(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report_latency(const char* name, const char* op, uint32_t* cycles, int count) {
+    if (count == 0) return;
+    
+    qsort(cycles, count, sizeof(uint32_t), compare_cycles);
+    ESP_LOGI(TAG, "  %-8s %-5s median %6lu  p99 %6lu  worst %6lu cycles (%d ops)",
+             name, op, (unsigned long)cycles[count / 2],
+             (unsigned long)cycles[(count * 99) / 100],
+             (unsigned long)cycles[count - 1], count);
+}
+
+// Replays the memory_stress_test_task pattern (100-2100 bytes, up to 20 live,
+// INTERNAL/DEFAULT caps) back to back with a fixed seed so both allocators
+// see the same request sequence.
+void run_latency_benchmark(const char* name, bench_alloc_fn alloc_fn, bench_free_fn free_fn) {
+    void* ptrs[20] = {NULL};
+    int live = 0;
+    int alloc_ops = 0;
+    int free_ops = 0;
+    uint32_t seed = 0x13579BDF;
+    
+    for (int i = 0; i < TLSF_BENCH_ITERATIONS; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t r = seed >> 8;
+        
+        if (live == 0 || (live < 20 && (r & 1))) {
+            size_t size = 100 + ((r >> 1) % 2000);
+            uint32_t caps = ((r >> 12) & 1) ? MALLOC_CAP_INTERNAL : MALLOC_CAP_DEFAULT;
+            
+            uint32_t start = esp_cpu_get_cycle_count();
+            void* ptr = alloc_fn(size, caps);
+            bench_alloc_cycles[alloc_ops++] = esp_cpu_get_cycle_count() - start;
+            
+            if (ptr) {
+                memset(ptr, 0xAA, size);
+                ptrs[live++] = ptr;
+            }
+        } else {
+            int index = (r >> 1) % live;
+            
+            uint32_t start = esp_cpu_get_cycle_count();
+            free_fn(ptrs[index]);
+            bench_free_cycles[free_ops++] = esp_cpu_get_cycle_count() - start;
+            
+            ptrs[index] = ptrs[--live];
+        }
+    }
+    
+    while (live > 0) {
+        free_fn(ptrs[--live]);
+    }
+    
+    report_latency(name, "alloc", bench_alloc_cycles, alloc_ops);
+    report_latency(name, "free", bench_free_cycles, free_ops);
+}
+
+void tlsf_benchmark_task(void *pvParameters) {
+    ESP_LOGI(TAG, "⏱️ TLSF latency benchmark started");
+    
+    while (1) {
+        vTaskDelay(pdMS_TO_TICKS(60000)); // Benchmark every 60 seconds
+        
+        ESP_LOGI(TAG, "\n⏱️ ═══ ALLOCATION LATENCY (%d ops) ═══", TLSF_BENCH_ITERATIONS);
+        run_latency_benchmark("heap_caps", heap_caps_malloc, heap_caps_free);
+        run_latency_benchmark("TLSF", bench_tlsf_malloc, bench_tlsf_free);
+        
+        tlsf_heap_print_stats_all();
+    }
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "🚀 Heap Management Lab Starting...");
     
@@ -510,6 +851,31 @@ void app_main(void) {
     // Initialize allocation tracking
     memset(allocations, 0, sizeof(allocations));
     
+#if USE_TLSF_BACKEND
+    // One TLSF instance per capability class
+    if (!tlsf_heap_create_with_caps("TLSF-Internal", TLSF_INTERNAL_REGION_SIZE,
+                                    MALLOC_CAP_INTERNAL | MALLOC_CAP_DEFAULT | MALLOC_CAP_8BIT)) {
+        ESP_LOGW(TAG, "TLSF internal heap unavailable, using default heap");
+    }
+    if (heap_caps_get_free_size(MALLOC_CAP_SPIRAM) > TLSF_SPIRAM_REGION_SIZE) {
+        tlsf_heap_create_with_caps("TLSF-SPIRAM", TLSF_SPIRAM_REGION_SIZE,
+                                   MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+#endif
+    
+#if USE_HANDLE_HEAP
+    if (heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) > HANDLE_HEAP_SPIRAM_SIZE) {
+        relocatable_heap = handle_heap_create("Relocatable", HANDLE_HEAP_SPIRAM_SIZE, MALLOC_CAP_SPIRAM);
+    } else {
+        relocatable_heap = handle_heap_create("Relocatable", HANDLE_HEAP_INTERNAL_SIZE, MALLOC_CAP_INTERNAL);
+    }
+#endif
+    
+    mem_telemetry_add_region("internal", MALLOC_CAP_INTERNAL, CRITICAL_MEMORY_THRESHOLD);
+    mem_telemetry_add_region("spiram", MALLOC_CAP_SPIRAM, 0);
+    mem_telemetry_add_region("dma", MALLOC_CAP_DMA, 0);
+    mem_telemetry_start(TELEMETRY_PERIOD_MS, TELEMETRY_PRIORITY);
+    
     ESP_LOGI(TAG, "Memory tracking system initialized");
     
     // Initial memory analysis
@@ -530,10 +896,23 @@ void app_main(void) {
     ESP_LOGI(TAG, "Creating memory test tasks...");
     
     xTaskCreate(memory_monitor_task, "MemMonitor", 4096, NULL, 6, NULL);
-    xTaskCreate(memory_stress_test_task, "StressTest", 3072, NULL, 5, NULL);
+    TaskHandle_t stress_task = NULL;
+    xTaskCreate(memory_stress_test_task, "StressTest", 3072, NULL, 5, &stress_task);
+    if (stress_task) {
+        task_heap_set_quota(stress_task, STRESS_SOFT_QUOTA, STRESS_HARD_QUOTA);
+    }
     xTaskCreate(memory_pool_test_task, "PoolTest", 3072, NULL, 5, NULL);
     xTaskCreate(large_allocation_test_task, "LargeAlloc", 2048, NULL, 4, NULL);
     xTaskCreate(heap_integrity_test_task, "IntegrityTest", 3072, NULL, 3, NULL);
+#if USE_TLSF_BACKEND
+    xTaskCreate(tlsf_benchmark_task, "TLSFBench", 3072, NULL, 2, NULL);
+#endif
+#if USE_HANDLE_HEAP
+    if (relocatable_heap) {
+        xTaskCreate(handle_heap_compactor_task, "Compactor", 2048, relocatable_heap, 1, NULL);
+        xTaskCreate(handle_fragmentation_task, "HandleFrag", 2048, NULL, 5, NULL);
+    }
+#endif
     
     ESP_LOGI(TAG, "All tasks created successfully");
     
@@ -553,6 +932,8 @@ void app_main(void) {
     ESP_LOGI(TAG, "  • Fragmentation Analysis");
     ESP_LOGI(TAG, "  • Heap Integrity Checking");
     ESP_LOGI(TAG, "  • Memory Performance Testing");
+    ESP_LOGI(TAG, "  • TLSF O(1) Allocator Backend");
+    ESP_LOGI(TAG, "  • Relocatable Handles with Compaction");
     
     ESP_LOGI(TAG, "Heap Management System operational!");
 }
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "heap_snapshot.h"
+
+uint8_t heap_snapshot_size_class(size_t size) {
+    uint8_t size_class = 0;
+    while (size > 1) {
+        size >>= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+void heap_snapshot_begin(heap_snapshot_t* snap, uint32_t id, uint64_t timestamp_us) {
+    snap->id = id;
+    snap->timestamp_us = timestamp_us;
+    snap->group_count = 0;
+    snap->dropped = 0;
+    snap->complete = true;
+}
+
+// Commas would break the streamed line format
+static void copy_tag(char* dst, const char* src) {
+    int i = 0;
+    if (src) {
+        for (; i < HEAP_SNAPSHOT_TAG_LEN - 1 && src[i]; i++) {
+            dst[i] = (src[i] == ',' || src[i] == '\n') ? '_' : src[i];
+        }
+    }
+    dst[i] = '\0';
+}
+
+static heap_snapshot_group_t* find_group(heap_snapshot_group_t* groups, int count,
+                                         uintptr_t site, uint8_t size_class) {
+    for (int i = 0; i < count; i++) {
+        if (groups[i].site == site && groups[i].size_class == size_class) {
+            return &groups[i];
+        }
+    }
+    return NULL;
+}
+
+void heap_snapshot_add(heap_snapshot_t* snap, uintptr_t site, const char* tag, size_t size) {
+    uint8_t size_class = heap_snapshot_size_class(size);
+    heap_snapshot_group_t* group = find_group(snap->groups, snap->group_count, site, size_class);
+
+    if (!group) {
+        if (snap->group_count >= HEAP_SNAPSHOT_MAX_GROUPS) {
+            snap->dropped++;
+            return;
+        }
+        group = &snap->groups[snap->group_count++];
+        group->site = site;
+        copy_tag(group->tag, tag);
+        group->size_class = size_class;
+        group->growth_streak = 0;
+        group->count = 0;
+        group->bytes = 0;
+    }
+    group->count++;
+    group->bytes += size;
+}
+
+static int compare_deltas(const void* a, const void* b) {
+    int32_t da = ((const heap_snapshot_delta_t*)a)->bytes_delta;
+    int32_t db = ((const heap_snapshot_delta_t*)b)->bytes_delta;
+    return (db > da) - (db < da);
+}
+
+int heap_snapshot_diff(const heap_snapshot_t* before, heap_snapshot_t* after,
+                       heap_snapshot_delta_t* out, int max) {
+    int count = 0;
+
+    for (int i = 0; i < after->group_count; i++) {
+        heap_snapshot_group_t* group = &after->groups[i];
+        const heap_snapshot_group_t* old = find_group((heap_snapshot_group_t*)before->groups,
+                                                      before->group_count,
+                                                      group->site, group->size_class);
+        int32_t count_delta = group->count - (old ? old->count : 0);
+        int32_t bytes_delta = (int32_t)group->bytes - (int32_t)(old ? old->bytes : 0);
+
+        if (bytes_delta > 0) {
+            uint8_t streak = old ? old->growth_streak : 0;
+            group->growth_streak = streak < UINT8_MAX ? streak + 1 : streak;
+        } else {
+            group->growth_streak = 0;
+        }
+
+        if ((count_delta || bytes_delta) && count < max) {
+            heap_snapshot_delta_t* d = &out[count++];
+            d->site = group->site;
+            memcpy(d->tag, group->tag, HEAP_SNAPSHOT_TAG_LEN);
+            d->size_class = group->size_class;
+            d->growth_streak = group->growth_streak;
+            d->count_delta = count_delta;
+            d->bytes_delta = bytes_delta;
+        }
+    }
+
+    // Groups that disappeared entirely
+    for (int i = 0; i < before->group_count && count < max; i++) {
+        const heap_snapshot_group_t* old = &before->groups[i];
+        if (find_group(after->groups, after->group_count, old->site, old->size_class)) continue;
+
+        heap_snapshot_delta_t* d = &out[count++];
+        d->site = old->site;
+        memcpy(d->tag, old->tag, HEAP_SNAPSHOT_TAG_LEN);
+        d->size_class = old->size_class;
+        d->growth_streak = 0;
+        d->count_delta = -(int32_t)old->count;
+        d->bytes_delta = -(int32_t)old->bytes;
+    }
+
+    qsort(out, count, sizeof(heap_snapshot_delta_t), compare_deltas);
+    return count;
+}
+
+void heap_snapshot_print(const heap_snapshot_t* snap) {
+    for (int i = 0; i < snap->group_count; i++) {
+        const heap_snapshot_group_t* g = &snap->groups[i];
+        printf("HSNAP,%lu,0x%08lx,%s,%u,%u,%lu\n",
+               (unsigned long)snap->id, (unsigned long)g->site, g->tag,
+               (unsigned)g->size_class, (unsigned)g->count, (unsigned long)g->bytes);
+    }
+}
+
+void heap_snapshot_print_diff(const heap_snapshot_delta_t* deltas, int count) {
+    printf("%-10s %-15s %-12s %7s %9s %6s\n", "Site", "Tag", "Size class", "Count", "Bytes", "Streak");
+    for (int i = 0; i < count; i++) {
+        const heap_snapshot_delta_t* d = &deltas[i];
+        unsigned long low = 1UL << d->size_class;
+        printf("0x%08lx %-15s %5lu-%-6lu %+7ld %+9ld %6u\n",
+               (unsigned long)d->site, d->tag, low, 2 * low - 1,
+               (long)d->count_delta, (long)d->bytes_delta, (unsigned)d->growth_streak);
+    }
+    if (count == 0) {
+        printf("No change\n");
+    }
+}
+
+#ifndef ESP_PLATFORM
+// Rebuilds snapshots from HSNAP lines anywhere in a log; other lines are
+// skipped. Diffs id_a against id_b, or the first snapshot against the last.
+static heap_snapshot_t snap_a, snap_b, snap_scratch;
+static heap_snapshot_delta_t deltas[HEAP_SNAPSHOT_MAX_DELTAS];
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 4) {
+        fprintf(stderr, "usage: %s log [id_a id_b]\n", argv[0]);
+        return 1;
+    }
+    FILE* in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    long want_a = argc == 4 ? strtol(argv[2], NULL, 10) : -1;
+    long want_b = argc == 4 ? strtol(argv[3], NULL, 10) : -1;
+    bool have_a = false, have_b = false;
+    heap_snapshot_t* current = NULL;
+    char line[256];
+
+    while (fgets(line, sizeof(line), in)) {
+        char* row = strstr(line, "HSNAP,");
+        if (!row) continue;
+
+        unsigned long id, site, bytes;
+        unsigned size_class, count;
+        char tag[HEAP_SNAPSHOT_TAG_LEN];
+        if (sscanf(row, "HSNAP,%lu,%lx,%15[^,],%u,%u,%lu",
+                   &id, &site, tag, &size_class, &count, &bytes) != 6) {
+            continue;
+        }
+
+        if (!current || current->id != id) {
+            if (!have_a && (want_a < 0 || want_a == (long)id)) {
+                current = &snap_a;
+                have_a = true;
+            } else if (want_b < 0 || want_b == (long)id) {
+                current = &snap_b;
+                have_b = true;
+            } else {
+                current = &snap_scratch;
+            }
+            heap_snapshot_begin(current, id, 0);
+        }
+        if (current->group_count < HEAP_SNAPSHOT_MAX_GROUPS) {
+            heap_snapshot_group_t* g = &current->groups[current->group_count++];
+            g->site = site;
+            copy_tag(g->tag, tag);
+            g->size_class = size_class;
+            g->growth_streak = 0;
+            g->count = count;
+            g->bytes = bytes;
+        }
+    }
+    fclose(in);
+
+    if (!have_a || !have_b) {
+        fprintf(stderr, "Need two snapshots in %s\n", argv[1]);
+        return 1;
+    }
+    printf("Snapshot %lu -> %lu\n", (unsigned long)snap_a.id, (unsigned long)snap_b.id);
+    int n = heap_snapshot_diff(&snap_a, &snap_b, deltas, HEAP_SNAPSHOT_MAX_DELTAS);
+    heap_snapshot_print_diff(deltas, n);
+    return 0;
+}
+#endif
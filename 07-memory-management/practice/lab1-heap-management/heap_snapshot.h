@@ -0,0 +1,64 @@
+#ifndef HEAP_SNAPSHOT_H
+#define HEAP_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Compact snapshot of live tracked allocations, grouped by call site and
+// power-of-two size class. Two snapshots diffed against each other show
+// which sites are growing; a site that grows over several consecutive
+// snapshots is a leak suspect, however old its buffers are.
+//
+// Snapshots stream out as log lines:
+//   HSNAP,id,site,tag,size_class,count,bytes
+// and the same file builds for the host to diff them from a captured log:
+//   gcc -O2 -o heap_snapshot heap_snapshot.c && ./heap_snapshot monitor.log [id_a id_b]
+// Sites are return addresses; resolve them with addr2line against the ELF.
+
+#define HEAP_SNAPSHOT_MAX_GROUPS    32
+#define HEAP_SNAPSHOT_TAG_LEN       16
+#define HEAP_SNAPSHOT_MAX_DELTAS    (2 * HEAP_SNAPSHOT_MAX_GROUPS)
+
+typedef struct {
+    uintptr_t site;
+    char tag[HEAP_SNAPSHOT_TAG_LEN];    // Allocation description
+    uint8_t size_class;                 // floor(log2(size))
+    uint8_t growth_streak;              // Consecutive snapshots this group grew in
+    uint16_t count;
+    uint32_t bytes;
+} heap_snapshot_group_t;
+
+typedef struct {
+    uint32_t id;
+    uint64_t timestamp_us;
+    uint16_t group_count;
+    uint16_t dropped;                   // Allocations that found no free group
+    bool complete;                      // False if part of the walk was skipped
+    heap_snapshot_group_t groups[HEAP_SNAPSHOT_MAX_GROUPS];
+} heap_snapshot_t;
+
+typedef struct {
+    uintptr_t site;
+    char tag[HEAP_SNAPSHOT_TAG_LEN];
+    uint8_t size_class;
+    uint8_t growth_streak;
+    int32_t count_delta;
+    int32_t bytes_delta;
+} heap_snapshot_delta_t;
+
+uint8_t heap_snapshot_size_class(size_t size);
+
+void heap_snapshot_begin(heap_snapshot_t* snap, uint32_t id, uint64_t timestamp_us);
+void heap_snapshot_add(heap_snapshot_t* snap, uintptr_t site, const char* tag, size_t size);
+
+// Groups whose count or bytes changed, largest byte growth first. Growth
+// streaks are carried from before into after. Returns the number written;
+// out needs HEAP_SNAPSHOT_MAX_DELTAS entries to never truncate.
+int heap_snapshot_diff(const heap_snapshot_t* before, heap_snapshot_t* after,
+                       heap_snapshot_delta_t* out, int max);
+
+void heap_snapshot_print(const heap_snapshot_t* snap);
+void heap_snapshot_print_diff(const heap_snapshot_delta_t* deltas, int count);
+
+#endif
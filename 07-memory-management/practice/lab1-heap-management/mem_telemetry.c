@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "mem_telemetry.h"
+
+static const char *TAG = "MEM_TELEM";
+
+// Samples per level-0 bucket, then level-0 buckets per level-1 bucket, ...
+static const uint8_t level_factors[MEM_TELEMETRY_LEVELS] = {10, 6, 10};
+
+typedef struct {
+    mem_rollup_t buckets[MEM_TELEMETRY_BUCKETS];
+    uint16_t head;                  // Next slot to write
+    uint16_t count;
+
+    // Bucket being accumulated
+    uint64_t sum;
+    uint32_t min;
+    uint32_t max;
+    uint32_t largest_min;
+    uint8_t pending;
+} mem_level_t;
+
+typedef struct {
+    const char* name;
+    uint32_t caps;
+    uint32_t critical_bytes;
+
+    mem_sample_t raw[MEM_TELEMETRY_RAW_SAMPLES];
+    uint16_t raw_head;
+    uint16_t raw_count;
+    mem_level_t levels[MEM_TELEMETRY_LEVELS];
+
+    float slope;                    // Bytes per second
+    uint32_t seconds_to_critical;
+    uint32_t alerts;
+    bool alerting;
+} mem_series_t;
+
+static mem_series_t series[MEM_TELEMETRY_MAX_REGIONS];
+static int region_count = 0;
+static uint32_t sample_period_ms = 1000;
+static portMUX_TYPE telemetry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+bool mem_telemetry_add_region(const char* name, uint32_t caps, uint32_t critical_bytes) {
+    if (region_count >= MEM_TELEMETRY_MAX_REGIONS) {
+        ESP_LOGE(TAG, "Too many telemetry regions");
+        return false;
+    }
+    if (heap_caps_get_total_size(caps) == 0) {
+        ESP_LOGI(TAG, "Skipping %s (no memory with these caps)", name);
+        return false;
+    }
+    mem_series_t* s = &series[region_count++];
+    memset(s, 0, sizeof(mem_series_t));
+    s->name = name;
+    s->caps = caps;
+    s->critical_bytes = critical_bytes;
+    return true;
+}
+
+uint32_t mem_telemetry_level_period_s(int level) {
+    uint32_t samples = 1;
+    for (int l = 0; l <= level && l < MEM_TELEMETRY_LEVELS; l++) {
+        samples *= level_factors[l];
+    }
+    return samples * sample_period_ms / 1000;
+}
+
+// Folds one value (a sample or a finished lower-level bucket) into a level;
+// returns true and fills done when the level's bucket completes
+static bool level_add(mem_level_t* level, int factor, uint32_t mean, uint32_t min,
+                      uint32_t max, uint32_t largest_min, mem_rollup_t* done) {
+    if (level->pending == 0) {
+        level->sum = 0;
+        level->min = UINT32_MAX;
+        level->max = 0;
+        level->largest_min = UINT32_MAX;
+    }
+    level->sum += mean;
+    if (min < level->min) level->min = min;
+    if (max > level->max) level->max = max;
+    if (largest_min < level->largest_min) level->largest_min = largest_min;
+    if (++level->pending < factor) return false;
+
+    done->free_mean = level->sum / factor;
+    done->free_min = level->min;
+    done->free_max = level->max;
+    done->largest_min = level->largest_min;
+    level->pending = 0;
+
+    level->buckets[level->head] = *done;
+    level->head = (level->head + 1) % MEM_TELEMETRY_BUCKETS;
+    if (level->count < MEM_TELEMETRY_BUCKETS) level->count++;
+    return true;
+}
+
+// Least-squares slope over the newest level-0 bucket means, in integers
+// until the final division so byte-sized values keep their precision
+static float level0_slope(const mem_level_t* level, uint32_t bucket_s) {
+    int n = level->count < MEM_TELEMETRY_SLOPE_WINDOW ? level->count : MEM_TELEMETRY_SLOPE_WINDOW;
+    if (n < 3 || bucket_s == 0) return 0;
+
+    int64_t sx = 0, sy = 0, sxy = 0, sxx = 0;
+    int start = (level->head - n + MEM_TELEMETRY_BUCKETS) % MEM_TELEMETRY_BUCKETS;
+    uint32_t base = level->buckets[start].free_mean;
+    for (int i = 0; i < n; i++) {
+        int64_t y = (int64_t)level->buckets[(start + i) % MEM_TELEMETRY_BUCKETS].free_mean - base;
+        sx += i;
+        sy += y;
+        sxy += i * y;
+        sxx += i * i;
+    }
+    int64_t denominator = n * sxx - sx * sx;
+    return (float)(n * sxy - sx * sy) / denominator / bucket_s;
+}
+
+// Alerts on the rising edge; clears once the prediction is back beyond
+// twice the horizon so a noisy slope does not flap. Returns 1 when an
+// alert is raised, -1 when it clears.
+static int update_trend(mem_series_t* s, uint32_t free_bytes) {
+    s->slope = level0_slope(&s->levels[0], mem_telemetry_level_period_s(0));
+    s->seconds_to_critical = 0;
+    if (s->slope < 0 && free_bytes > s->critical_bytes) {
+        s->seconds_to_critical = (free_bytes - s->critical_bytes) / -s->slope;
+    }
+    if (s->critical_bytes == 0) return 0;
+
+    bool soon = s->slope < 0 &&
+                (free_bytes <= s->critical_bytes || s->seconds_to_critical < MEM_TELEMETRY_HORIZON_S);
+    bool clear = s->slope >= 0 || s->seconds_to_critical > 2 * MEM_TELEMETRY_HORIZON_S;
+
+    if (soon && !s->alerting) {
+        s->alerting = true;
+        s->alerts++;
+        return 1;
+    }
+    if (clear && s->alerting) {
+        s->alerting = false;
+        return -1;
+    }
+    return 0;
+}
+
+static void record_sample(mem_series_t* s) {
+    mem_sample_t sample = {
+        .free_bytes = heap_caps_get_free_size(s->caps),
+        .largest_block = heap_caps_get_largest_free_block(s->caps),
+        .min_ever = heap_caps_get_minimum_free_size(s->caps),
+    };
+    int alert = 0;
+
+    portENTER_CRITICAL(&telemetry_lock);
+    s->raw[s->raw_head] = sample;
+    s->raw_head = (s->raw_head + 1) % MEM_TELEMETRY_RAW_SAMPLES;
+    if (s->raw_count < MEM_TELEMETRY_RAW_SAMPLES) s->raw_count++;
+
+    mem_rollup_t bucket;
+    uint32_t v = sample.free_bytes;
+    bool done = level_add(&s->levels[0], level_factors[0], v, v, v, sample.largest_block, &bucket);
+    if (done) {
+        alert = update_trend(s, sample.free_bytes);
+    }
+    for (int l = 1; l < MEM_TELEMETRY_LEVELS && done; l++) {
+        done = level_add(&s->levels[l], level_factors[l], bucket.free_mean, bucket.free_min,
+                         bucket.free_max, bucket.largest_min, &bucket);
+    }
+    portEXIT_CRITICAL(&telemetry_lock);
+
+    // Logging is not allowed inside the critical section
+    if (alert > 0) {
+        ESP_LOGW(TAG, "📉 %s shrinking %.0f B/s: critical (%lu B) in ~%lu s",
+                 s->name, -s->slope, (unsigned long)s->critical_bytes,
+                 (unsigned long)s->seconds_to_critical);
+    } else if (alert < 0) {
+        ESP_LOGI(TAG, "📈 %s trend recovered", s->name);
+    }
+}
+
+static void sampler_task(void *pvParameters) {
+    ESP_LOGI(TAG, "📡 Telemetry sampler started (%lu ms, %d regions)",
+             (unsigned long)sample_period_ms, region_count);
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (1) {
+        for (int r = 0; r < region_count; r++) {
+            record_sample(&series[r]);
+        }
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sample_period_ms));
+    }
+}
+
+bool mem_telemetry_start(uint32_t period_ms, uint32_t priority) {
+    if (period_ms == 0 || region_count == 0) return false;
+    sample_period_ms = period_ms;
+    if (xTaskCreate(sampler_task, "MemTelemetry", 2560, NULL, priority, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create telemetry sampler");
+        return false;
+    }
+    return true;
+}
+
+int mem_telemetry_get_rollups(int region, int level, mem_rollup_t* out, int max) {
+    if (region < 0 || region >= region_count || level < 0 || level >= MEM_TELEMETRY_LEVELS) {
+        return 0;
+    }
+    const mem_level_t* lv = &series[region].levels[level];
+
+    portENTER_CRITICAL(&telemetry_lock);
+    int count = lv->count < max ? lv->count : max;
+    int start = (lv->head - count + MEM_TELEMETRY_BUCKETS) % MEM_TELEMETRY_BUCKETS;
+    for (int i = 0; i < count; i++) {
+        out[i] = lv->buckets[(start + i) % MEM_TELEMETRY_BUCKETS];
+    }
+    portEXIT_CRITICAL(&telemetry_lock);
+    return count;
+}
+
+bool mem_telemetry_get_trend(int region, mem_trend_t* out) {
+    if (region < 0 || region >= region_count) return false;
+    const mem_series_t* s = &series[region];
+
+    portENTER_CRITICAL(&telemetry_lock);
+    out->name = s->name;
+    memset(&out->latest, 0, sizeof(out->latest));
+    if (s->raw_count > 0) {
+        out->latest = s->raw[(s->raw_head + MEM_TELEMETRY_RAW_SAMPLES - 1) % MEM_TELEMETRY_RAW_SAMPLES];
+    }
+    out->slope_bytes_per_s = s->slope;
+    out->seconds_to_critical = s->seconds_to_critical;
+    out->alerts = s->alerts;
+    out->alerting = s->alerting;
+    portEXIT_CRITICAL(&telemetry_lock);
+    return true;
+}
+
+void mem_telemetry_print_summary(void) {
+    ESP_LOGI(TAG, "\n📡 ═══ MEMORY TELEMETRY ═══");
+    for (int r = 0; r < region_count; r++) {
+        mem_trend_t trend;
+        mem_telemetry_get_trend(r, &trend);
+        ESP_LOGI(TAG, "%-8s free %lu, largest %lu, min ever %lu, slope %+.1f B/s%s",
+                 trend.name, (unsigned long)trend.latest.free_bytes,
+                 (unsigned long)trend.latest.largest_block, (unsigned long)trend.latest.min_ever,
+                 trend.slope_bytes_per_s, trend.alerting ? " 🚨 critical predicted" : "");
+
+        for (int l = 0; l < MEM_TELEMETRY_LEVELS; l++) {
+            mem_rollup_t buckets[MEM_TELEMETRY_BUCKETS];
+            int n = mem_telemetry_get_rollups(r, l, buckets, MEM_TELEMETRY_BUCKETS);
+            if (n == 0) continue;
+            mem_rollup_t last = buckets[n - 1];
+            ESP_LOGI(TAG, "  %5lus: mean %lu, min %lu, max %lu, largest ≥ %lu (%d buckets)",
+                     (unsigned long)mem_telemetry_level_period_s(l), (unsigned long)last.free_mean,
+                     (unsigned long)last.free_min, (unsigned long)last.free_max,
+                     (unsigned long)last.largest_min, n);
+        }
+    }
+}
+
+void mem_telemetry_export(int level) {
+    mem_rollup_t buckets[MEM_TELEMETRY_BUCKETS];
+
+    for (int r = 0; r < region_count; r++) {
+        int n = mem_telemetry_get_rollups(r, level, buckets, MEM_TELEMETRY_BUCKETS);
+        if (n == 0) continue;
+
+        printf("MTEL,%s,%d,%lu,%d,%lu", series[r].name, level,
+               (unsigned long)mem_telemetry_level_period_s(level), n,
+               (unsigned long)buckets[0].free_mean);
+        int64_t previous = buckets[0].free_mean;
+        for (int i = 0; i < n; i++) {
+            const mem_rollup_t* b = &buckets[i];
+            printf(",%ld/%lu/%lu/%lu", (long)((int64_t)b->free_mean - previous),
+                   (unsigned long)(b->free_mean - b->free_min),
+                   (unsigned long)(b->free_max - b->free_mean),
+                   (unsigned long)(b->free_mean > b->largest_min ? b->free_mean - b->largest_min : 0));
+            previous = b->free_mean;
+        }
+        printf("\n");
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef MEM_TELEMETRY_H
+#define MEM_TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Heap telemetry time series. A sampler task records free bytes, largest
+// free block and minimum-ever free per region into a raw ring, and folds
+// the samples into min/max/mean rollups at three resolutions (with the
+// default 1 s period: 10 s, 1 min and 10 min buckets). A least-squares
+// slope over recent level-0 buckets predicts when a region will reach its
+// critical threshold, and alerts once while that is within the horizon.
+
+#define MEM_TELEMETRY_MAX_REGIONS   3
+#define MEM_TELEMETRY_RAW_SAMPLES   32
+#define MEM_TELEMETRY_LEVELS        3
+#define MEM_TELEMETRY_BUCKETS       24      // Per level
+#define MEM_TELEMETRY_SLOPE_WINDOW  12      // Level-0 buckets in the slope fit
+#define MEM_TELEMETRY_HORIZON_S     600     // Alert if critical is predicted sooner
+
+typedef struct {
+    uint32_t free_bytes;
+    uint32_t largest_block;
+    uint32_t min_ever;
+} mem_sample_t;
+
+typedef struct {
+    uint32_t free_min;
+    uint32_t free_max;
+    uint32_t free_mean;
+    uint32_t largest_min;
+} mem_rollup_t;
+
+typedef struct {
+    const char* name;
+    mem_sample_t latest;
+    float slope_bytes_per_s;        // Negative while free memory shrinks
+    uint32_t seconds_to_critical;   // 0 if not shrinking
+    uint32_t alerts;
+    bool alerting;
+} mem_trend_t;
+
+// Regions are added before mem_telemetry_start; critical_bytes is the
+// free level the prediction aims at (0 = no alerts)
+bool mem_telemetry_add_region(const char* name, uint32_t caps, uint32_t critical_bytes);
+bool mem_telemetry_start(uint32_t period_ms, uint32_t priority);
+
+// Bucket period of a level in seconds
+uint32_t mem_telemetry_level_period_s(int level);
+
+// Oldest first; returns the number of buckets copied
+int mem_telemetry_get_rollups(int region, int level, mem_rollup_t* out, int max);
+bool mem_telemetry_get_trend(int region, mem_trend_t* out);
+
+void mem_telemetry_print_summary(void);
+
+// One line per region, bucket means delta-encoded against the previous one:
+//   MTEL,region,level,period_s,count,first_mean,d/lo/hi/frag,...
+// with lo = mean - min, hi = max - mean, frag = mean - smallest largest-block
+void mem_telemetry_export(int level);
+
+#endif
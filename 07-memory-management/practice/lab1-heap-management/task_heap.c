@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "task_heap.h"
+
+static const char *TAG = "TASK_HEAP";
+
+#define TASK_ACCOUNT_OVERFLOW   (TASK_ACCOUNT_SLOTS - 1)
+
+// Slots are claimed in order by CAS on owner and never released, so a
+// lookup can stop at the first unclaimed slot. The name is written after
+// the claim, so readers check named before trusting it.
+typedef struct {
+    _Atomic(TaskHandle_t) owner;
+    char name[TASK_ACCOUNT_NAME_LEN];
+    atomic_bool named;
+    atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t soft_limit;
+    atomic_size_t hard_limit;
+    atomic_uint allocs;
+    atomic_uint frees;
+    atomic_uint denied;
+    atomic_uint soft_crossings;
+} task_account_t;
+
+static task_account_t accounts[TASK_ACCOUNT_SLOTS] = {
+    [TASK_ACCOUNT_OVERFLOW] = { .name = "(other)", .named = true },
+};
+
+static void account_set_name(task_account_t* acc, TaskHandle_t task) {
+    const char* name = pcTaskGetName(task);
+    strncpy(acc->name, name ? name : "?", TASK_ACCOUNT_NAME_LEN - 1);
+    acc->name[TASK_ACCOUNT_NAME_LEN - 1] = '\0';
+    atomic_store_explicit(&acc->named, true, memory_order_release);
+}
+
+static const char* account_name(task_account_t* acc) {
+    return atomic_load_explicit(&acc->named, memory_order_acquire) ? acc->name : "?";
+}
+
+// Linear scan over at most 15 handles; cheaper than a TLS slot lookup and
+// leaves the thread-local pointers to pthread and the application
+static uint16_t account_for_task(TaskHandle_t task) {
+    for (uint16_t i = 0; i < TASK_ACCOUNT_OVERFLOW; i++) {
+        TaskHandle_t owner = atomic_load_explicit(&accounts[i].owner, memory_order_acquire);
+        if (owner == task) return i;
+        if (owner != NULL) continue;
+
+        TaskHandle_t expected = NULL;
+        if (atomic_compare_exchange_strong_explicit(&accounts[i].owner, &expected, task,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            account_set_name(&accounts[i], task);
+            return i;
+        }
+        if (expected == task) return i;     // Claimed for us by task_heap_set_quota
+    }
+    return TASK_ACCOUNT_OVERFLOW;
+}
+
+static void update_peak(task_account_t* acc, size_t live) {
+    size_t peak = atomic_load_explicit(&acc->peak_bytes, memory_order_relaxed);
+    while (live > peak &&
+           !atomic_compare_exchange_weak_explicit(&acc->peak_bytes, &peak, live,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+bool task_heap_charge(size_t size, uint16_t* account) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint16_t index = task ? account_for_task(task) : TASK_ACCOUNT_OVERFLOW;
+    task_account_t* acc = &accounts[index];
+
+    size_t hard = atomic_load_explicit(&acc->hard_limit, memory_order_relaxed);
+    size_t soft = atomic_load_explicit(&acc->soft_limit, memory_order_relaxed);
+
+    // Charge first, roll back if that overshot: two racing allocations can
+    // never both get past the hard limit
+    size_t before = atomic_fetch_add_explicit(&acc->live_bytes, size, memory_order_relaxed);
+    size_t after = before + size;
+    if (hard && after > hard) {
+        atomic_fetch_sub_explicit(&acc->live_bytes, size, memory_order_relaxed);
+        atomic_fetch_add_explicit(&acc->denied, 1, memory_order_relaxed);
+        *account = TASK_ACCOUNT_NONE;
+        return false;
+    }
+
+    atomic_fetch_add_explicit(&acc->allocs, 1, memory_order_relaxed);
+    update_peak(acc, after);
+
+    if (soft && before < soft && after >= soft) {
+        atomic_fetch_add_explicit(&acc->soft_crossings, 1, memory_order_relaxed);
+        ESP_LOGW(TAG, "⚠️ %s crossed its soft quota: %d/%d bytes",
+                 account_name(acc), (int)after, (int)soft);
+    }
+
+    *account = index;
+    return true;
+}
+
+void task_heap_uncharge(uint16_t account, size_t size) {
+    if (account >= TASK_ACCOUNT_SLOTS) return;
+    atomic_fetch_sub_explicit(&accounts[account].live_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&accounts[account].frees, 1, memory_order_relaxed);
+}
+
+void task_heap_set_quota(TaskHandle_t task, size_t soft_limit, size_t hard_limit) {
+    if (!task) return;
+
+    uint16_t index = account_for_task(task);
+    if (index == TASK_ACCOUNT_OVERFLOW) {
+        ESP_LOGE(TAG, "❌ No account slot left for %s", pcTaskGetName(task));
+        return;
+    }
+
+    atomic_store_explicit(&accounts[index].soft_limit, soft_limit, memory_order_relaxed);
+    atomic_store_explicit(&accounts[index].hard_limit, hard_limit, memory_order_relaxed);
+    ESP_LOGI(TAG, "Quota for %s: soft %d, hard %d bytes",
+             account_name(&accounts[index]), (int)soft_limit, (int)hard_limit);
+}
+
+int task_heap_get_top(task_heap_stats_t* out, int max) {
+    task_heap_stats_t snapshot[TASK_ACCOUNT_SLOTS];
+    int count = 0;
+
+    // Counters are read one by one, so a row may mix values from either
+    // side of a concurrent allocation; good enough for a report
+    for (int i = 0; i < TASK_ACCOUNT_SLOTS; i++) {
+        task_account_t* acc = &accounts[i];
+        if (!atomic_load_explicit(&acc->named, memory_order_acquire)) {
+            continue;   // Unclaimed, or claimed and the name not written yet
+        }
+        uint32_t allocs = atomic_load_explicit(&acc->allocs, memory_order_relaxed);
+        uint32_t denied = atomic_load_explicit(&acc->denied, memory_order_relaxed);
+        if (allocs == 0 && denied == 0) continue;
+
+        task_heap_stats_t* s = &snapshot[count++];
+        memcpy(s->name, acc->name, TASK_ACCOUNT_NAME_LEN);
+        s->live_bytes = atomic_load_explicit(&acc->live_bytes, memory_order_relaxed);
+        s->peak_bytes = atomic_load_explicit(&acc->peak_bytes, memory_order_relaxed);
+        s->soft_limit = atomic_load_explicit(&acc->soft_limit, memory_order_relaxed);
+        s->hard_limit = atomic_load_explicit(&acc->hard_limit, memory_order_relaxed);
+        s->allocs = allocs;
+        s->frees = atomic_load_explicit(&acc->frees, memory_order_relaxed);
+        s->denied = denied;
+        s->soft_crossings = atomic_load_explicit(&acc->soft_crossings, memory_order_relaxed);
+    }
+
+    // Insertion sort by live bytes, largest first
+    for (int i = 1; i < count; i++) {
+        task_heap_stats_t key = snapshot[i];
+        int j = i - 1;
+        while (j >= 0 && snapshot[j].live_bytes < key.live_bytes) {
+            snapshot[j + 1] = snapshot[j];
+            j--;
+        }
+        snapshot[j + 1] = key;
+    }
+
+    if (count > max) count = max;
+    memcpy(out, snapshot, count * sizeof(task_heap_stats_t));
+    return count;
+}
+
+void task_heap_print_top(int n) {
+    task_heap_stats_t top[TASK_ACCOUNT_SLOTS];
+    if (n > TASK_ACCOUNT_SLOTS) n = TASK_ACCOUNT_SLOTS;
+    int count = task_heap_get_top(top, n);
+
+    ESP_LOGI(TAG, "\n👥 ═══ TOP %d TASKS BY LIVE HEAP ═══", n);
+    ESP_LOGI(TAG, "%-15s %8s %8s %8s %7s %7s %6s", "Task", "Live", "Peak", "Hard", "Allocs", "Frees", "Denied");
+    for (int i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "%-15s %8d %8d %8d %7lu %7lu %6lu%s",
+                 top[i].name, (int)top[i].live_bytes, (int)top[i].peak_bytes, (int)top[i].hard_limit,
+                 (unsigned long)top[i].allocs, (unsigned long)top[i].frees, (unsigned long)top[i].denied,
+                 top[i].soft_limit && top[i].live_bytes >= top[i].soft_limit ? " ⚠️ over soft" : "");
+    }
+    if (count == 0) {
+        ESP_LOGI(TAG, "No task allocations recorded");
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef TASK_HEAP_H
+#define TASK_HEAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Per-task heap accounting. Each task gets an account the first time it
+// allocates; charges and credits are atomic, so the fast path never takes
+// a lock. A hard quota makes the task's allocations fail before reaching
+// the allocator; a soft quota only warns when crossed.
+
+#define TASK_ACCOUNT_SLOTS      16      // Last slot collects tasks that did not fit
+#define TASK_ACCOUNT_NAME_LEN   16
+#define TASK_ACCOUNT_NONE       0xFFFF
+
+typedef struct {
+    char name[TASK_ACCOUNT_NAME_LEN];
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t soft_limit;          // 0 = none
+    size_t hard_limit;          // 0 = none
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t denied;            // Failed fast on the hard quota
+    uint32_t soft_crossings;
+} task_heap_stats_t;
+
+// Charge size bytes to the calling task. Returns false (nothing charged)
+// if it would exceed the task's hard quota.
+bool task_heap_charge(size_t size, uint16_t* account);
+
+// Undo a charge: on free, or when the allocator itself failed
+void task_heap_uncharge(uint16_t account, size_t size);
+
+void task_heap_set_quota(TaskHandle_t task, size_t soft_limit, size_t hard_limit);
+
+// Snapshot of up to max accounts, largest live_bytes first; returns count
+int task_heap_get_top(task_heap_stats_t* out, int max);
+void task_heap_print_top(int n);
+
+#endif
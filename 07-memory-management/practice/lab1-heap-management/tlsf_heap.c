@@ -0,0 +1,594 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_cpu.h"
+#include "tlsf_heap.h"
+
+static const char *TAG = "TLSF";
+
+// Block sizes are multiples of the pointer size, like heap_caps_malloc
+#if UINTPTR_MAX > 0xFFFFFFFFu
+#define TLSF_ALIGN_LOG2     3
+#else
+#define TLSF_ALIGN_LOG2     2
+#endif
+#define TLSF_ALIGN_SIZE     (1u << TLSF_ALIGN_LOG2)
+
+// Second level splits every power-of-two range into 16 lists
+#define TLSF_SL_LOG2        4
+#define TLSF_SL_COUNT       (1u << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT       (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_MAX         24   // Largest block is 16 MB
+#define TLSF_FL_COUNT       (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+#define TLSF_SMALL_BLOCK    (1u << TLSF_FL_SHIFT)
+
+#define TLSF_BLOCK_FREE     0x1u
+#define TLSF_PREV_FREE      0x2u
+#define TLSF_FLAG_MASK      (TLSF_BLOCK_FREE | TLSF_PREV_FREE)
+
+#define TLSF_HEAP_MAGIC     0x544C5346  // "TLSF"
+
+// Integrity walk holds the lock for this many blocks at a time and starts
+// over if the heap changed in between, giving up after a few restarts
+#define TLSF_CHECK_CHUNK    32
+#define TLSF_CHECK_RESTARTS 4
+
+// Block header. prev_phys overlaps the last word of the previous block's
+// payload and is only valid while that block is free; the free-list links
+// overlap this block's own payload and are only valid while it is free.
+typedef struct tlsf_block {
+    struct tlsf_block* prev_phys;
+    size_t size;                    // Payload size | flags
+    struct tlsf_block* next_free;
+    struct tlsf_block* prev_free;
+} tlsf_block_t;
+
+#define TLSF_HEADER_OVERHEAD (sizeof(size_t))
+#define TLSF_START_OFFSET    (offsetof(tlsf_block_t, size) + sizeof(size_t))
+#define TLSF_BLOCK_MIN       (sizeof(tlsf_block_t) - sizeof(tlsf_block_t*))
+#define TLSF_BLOCK_MAX       ((size_t)1 << TLSF_FL_MAX)
+
+struct tlsf_heap {
+    uint32_t magic;
+    const char* name;
+    uint32_t caps;
+    bool owns_region;
+
+    uint8_t* region;
+    size_t region_size;
+    uint8_t* pool_start;            // First block payload
+    uint8_t* pool_end;              // Sentinel block payload
+
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t* blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+
+    tlsf_heap_stats_t stats;
+    uint32_t generation;            // Bumped by every malloc/free that changes the blocks
+    portMUX_TYPE lock;
+};
+
+static tlsf_heap_t* registered_heaps[TLSF_MAX_HEAPS];
+static portMUX_TYPE registry_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Bit scan helpers (map to NSAU on Xtensa)
+static inline int tlsf_ffs(uint32_t word) {
+    return word ? __builtin_ctz(word) : -1;
+}
+
+static inline int tlsf_fls(size_t size) {
+    uint32_t word = (uint32_t)size;
+    return word ? 31 - __builtin_clz(word) : -1;
+}
+
+// Block helpers
+static inline size_t block_size(const tlsf_block_t* block) {
+    return block->size & ~(size_t)TLSF_FLAG_MASK;
+}
+
+static inline void block_set_size(tlsf_block_t* block, size_t size) {
+    block->size = size | (block->size & TLSF_FLAG_MASK);
+}
+
+static inline bool block_is_free(const tlsf_block_t* block) {
+    return (block->size & TLSF_BLOCK_FREE) != 0;
+}
+
+static inline bool block_is_prev_free(const tlsf_block_t* block) {
+    return (block->size & TLSF_PREV_FREE) != 0;
+}
+
+static inline void* block_to_ptr(const tlsf_block_t* block) {
+    return (uint8_t*)block + TLSF_START_OFFSET;
+}
+
+static inline tlsf_block_t* block_from_ptr(const void* ptr) {
+    return (tlsf_block_t*)((uint8_t*)ptr - TLSF_START_OFFSET);
+}
+
+static inline tlsf_block_t* block_next(const tlsf_block_t* block) {
+    return (tlsf_block_t*)((uint8_t*)block_to_ptr(block) + block_size(block) - TLSF_HEADER_OVERHEAD);
+}
+
+static inline tlsf_block_t* block_link_next(tlsf_block_t* block) {
+    tlsf_block_t* next = block_next(block);
+    next->prev_phys = block;
+    return next;
+}
+
+static inline void block_mark_free(tlsf_block_t* block) {
+    tlsf_block_t* next = block_link_next(block);
+    next->size |= TLSF_PREV_FREE;
+    block->size |= TLSF_BLOCK_FREE;
+}
+
+static inline void block_mark_used(tlsf_block_t* block) {
+    tlsf_block_t* next = block_next(block);
+    next->size &= ~(size_t)TLSF_PREV_FREE;
+    block->size &= ~(size_t)TLSF_BLOCK_FREE;
+}
+
+// Size to (fl, sl) mapping
+static inline void mapping_insert(size_t size, int* fl, int* sl) {
+    if (size < TLSF_SMALL_BLOCK) {
+        *fl = 0;
+        *sl = (int)(size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+    } else {
+        int bit = tlsf_fls(size);
+        *sl = (int)((size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT);
+        *fl = bit - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+// Round up so any block in the chosen list is large enough (good-fit)
+static inline void mapping_search(size_t size, int* fl, int* sl) {
+    if (size >= TLSF_SMALL_BLOCK) {
+        size += ((size_t)1 << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static inline size_t adjust_request_size(size_t size) {
+    if (size == 0 || size >= TLSF_BLOCK_MAX) {
+        return 0;
+    }
+    size_t aligned = (size + TLSF_ALIGN_SIZE - 1) & ~(size_t)(TLSF_ALIGN_SIZE - 1);
+    return aligned < TLSF_BLOCK_MIN ? TLSF_BLOCK_MIN : aligned;
+}
+
+// Free list management
+static void remove_free_block(tlsf_heap_t* heap, tlsf_block_t* block, int fl, int sl) {
+    tlsf_block_t* prev = block->prev_free;
+    tlsf_block_t* next = block->next_free;
+
+    if (next) next->prev_free = prev;
+    if (prev) prev->next_free = next;
+
+    if (heap->blocks[fl][sl] == block) {
+        heap->blocks[fl][sl] = next;
+        if (!next) {
+            heap->sl_bitmap[fl] &= ~(1u << sl);
+            if (!heap->sl_bitmap[fl]) {
+                heap->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+static void insert_free_block(tlsf_heap_t* heap, tlsf_block_t* block, int fl, int sl) {
+    tlsf_block_t* current = heap->blocks[fl][sl];
+    block->next_free = current;
+    block->prev_free = NULL;
+    if (current) current->prev_free = block;
+
+    heap->blocks[fl][sl] = block;
+    heap->fl_bitmap |= (1u << fl);
+    heap->sl_bitmap[fl] |= (1u << sl);
+}
+
+static void block_remove(tlsf_heap_t* heap, tlsf_block_t* block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    remove_free_block(heap, block, fl, sl);
+}
+
+static void block_insert(tlsf_heap_t* heap, tlsf_block_t* block) {
+    int fl, sl;
+    mapping_insert(block_size(block), &fl, &sl);
+    insert_free_block(heap, block, fl, sl);
+}
+
+static tlsf_block_t* search_suitable_block(tlsf_heap_t* heap, int* fl, int* sl) {
+    uint32_t sl_map = heap->sl_bitmap[*fl] & (~0u << *sl);
+
+    if (!sl_map) {
+        // No block in this first-level range; take the next larger one
+        uint32_t fl_map = heap->fl_bitmap & (~0u << (*fl + 1));
+        if (!fl_map) {
+            return NULL;
+        }
+        *fl = tlsf_ffs(fl_map);
+        sl_map = heap->sl_bitmap[*fl];
+    }
+
+    *sl = tlsf_ffs(sl_map);
+    return heap->blocks[*fl][*sl];
+}
+
+// Split and merge
+static tlsf_block_t* block_split(tlsf_block_t* block, size_t size) {
+    tlsf_block_t* remaining = (tlsf_block_t*)((uint8_t*)block_to_ptr(block) + size - TLSF_HEADER_OVERHEAD);
+    size_t remain_size = block_size(block) - (size + TLSF_HEADER_OVERHEAD);
+
+    remaining->size = remain_size;
+    block_set_size(block, size);
+    block_mark_free(remaining);
+    return remaining;
+}
+
+static tlsf_block_t* block_absorb(tlsf_block_t* prev, tlsf_block_t* block) {
+    prev->size += block_size(block) + TLSF_HEADER_OVERHEAD;
+    block_link_next(prev);
+    return prev;
+}
+
+static tlsf_block_t* merge_prev(tlsf_heap_t* heap, tlsf_block_t* block) {
+    if (block_is_prev_free(block)) {
+        tlsf_block_t* prev = block->prev_phys;
+        block_remove(heap, prev);
+        block = block_absorb(prev, block);
+    }
+    return block;
+}
+
+static tlsf_block_t* merge_next(tlsf_heap_t* heap, tlsf_block_t* block) {
+    tlsf_block_t* next = block_next(block);
+    if (block_is_free(next)) {
+        block_remove(heap, next);
+        block = block_absorb(block, next);
+    }
+    return block;
+}
+
+static void block_trim_free(tlsf_heap_t* heap, tlsf_block_t* block, size_t size) {
+    if (block_size(block) >= size + sizeof(tlsf_block_t)) {
+        tlsf_block_t* remaining = block_split(block, size);
+        block_link_next(block);
+        remaining->size |= TLSF_PREV_FREE;
+        block_insert(heap, remaining);
+    }
+}
+
+// Registry
+static void register_heap(tlsf_heap_t* heap) {
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < TLSF_MAX_HEAPS; i++) {
+        if (!registered_heaps[i]) {
+            registered_heaps[i] = heap;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+static void unregister_heap(tlsf_heap_t* heap) {
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < TLSF_MAX_HEAPS; i++) {
+        if (registered_heaps[i] == heap) {
+            registered_heaps[i] = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+}
+
+// Public API
+tlsf_heap_t* tlsf_heap_create(const char* name, void* region, size_t size, uint32_t caps) {
+    if (!region) return NULL;
+
+    uintptr_t start = (uintptr_t)region;
+    uintptr_t end = start + size;
+    uintptr_t control = (start + TLSF_ALIGN_SIZE - 1) & ~(uintptr_t)(TLSF_ALIGN_SIZE - 1);
+    uintptr_t pool = (control + sizeof(tlsf_heap_t) + TLSF_ALIGN_SIZE - 1) &
+                     ~(uintptr_t)(TLSF_ALIGN_SIZE - 1);
+
+    // Pool holds one big free block plus the zero-size sentinel
+    if (pool >= end || end - pool < 2 * TLSF_HEADER_OVERHEAD + TLSF_BLOCK_MIN) {
+        ESP_LOGE(TAG, "Region too small for %s heap (%d bytes)", name, (int)size);
+        return NULL;
+    }
+
+    size_t pool_bytes = ((end - pool) - 2 * TLSF_HEADER_OVERHEAD) & ~(size_t)(TLSF_ALIGN_SIZE - 1);
+    if (pool_bytes >= TLSF_BLOCK_MAX) {
+        pool_bytes = TLSF_BLOCK_MAX - TLSF_ALIGN_SIZE;
+    }
+
+    tlsf_heap_t* heap = (tlsf_heap_t*)control;
+    memset(heap, 0, sizeof(tlsf_heap_t));
+    heap->magic = TLSF_HEAP_MAGIC;
+    heap->name = name;
+    heap->caps = caps;
+    heap->region = (uint8_t*)region;
+    heap->region_size = size;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    heap->lock = unlocked;
+
+    // First block header starts one word before the pool; its prev_phys
+    // field is never touched because PREV_FREE is clear.
+    tlsf_block_t* block = (tlsf_block_t*)(pool - TLSF_HEADER_OVERHEAD);
+    block->size = pool_bytes;
+    block->size |= TLSF_BLOCK_FREE;
+    block_insert(heap, block);
+
+    tlsf_block_t* sentinel = block_link_next(block);
+    sentinel->size = 0 | TLSF_PREV_FREE;
+
+    heap->pool_start = block_to_ptr(block);
+    heap->pool_end = block_to_ptr(sentinel);
+
+    heap->stats.name = name;
+    heap->stats.caps = caps;
+    // Every block costs its payload plus one size word; the extra word
+    // here is the sentinel's header
+    heap->stats.region_size = pool_bytes + TLSF_HEADER_OVERHEAD;
+    heap->stats.free_bytes = pool_bytes + TLSF_HEADER_OVERHEAD;
+
+    register_heap(heap);
+
+    ESP_LOGI(TAG, "✅ %s heap: %d usable bytes at %p (caps 0x%08lX)",
+             name, (int)pool_bytes, heap->pool_start, (unsigned long)caps);
+    return heap;
+}
+
+tlsf_heap_t* tlsf_heap_create_with_caps(const char* name, size_t size, uint32_t caps) {
+    void* region = heap_caps_malloc(size, caps);
+    if (!region) {
+        ESP_LOGE(TAG, "Failed to reserve %d bytes for %s heap", (int)size, name);
+        return NULL;
+    }
+
+    tlsf_heap_t* heap = tlsf_heap_create(name, region, size, caps);
+    if (!heap) {
+        heap_caps_free(region);
+        return NULL;
+    }
+
+    heap->owns_region = true;
+    return heap;
+}
+
+void tlsf_heap_destroy(tlsf_heap_t* heap) {
+    if (!heap || heap->magic != TLSF_HEAP_MAGIC) return;
+
+    unregister_heap(heap);
+    heap->magic = 0;
+
+    if (heap->owns_region) {
+        heap_caps_free(heap->region);
+    }
+}
+
+void* tlsf_heap_malloc(tlsf_heap_t* heap, size_t size) {
+    if (!heap) return NULL;
+
+    size_t adjusted = adjust_request_size(size);
+    void* result = NULL;
+
+    portENTER_CRITICAL(&heap->lock);
+    uint32_t start = esp_cpu_get_cycle_count();
+
+    if (adjusted) {
+        int fl, sl;
+        mapping_search(adjusted, &fl, &sl);
+
+        if (fl < TLSF_FL_COUNT) {
+            tlsf_block_t* block = search_suitable_block(heap, &fl, &sl);
+            if (block) {
+                remove_free_block(heap, block, fl, sl);
+                block_trim_free(heap, block, adjusted);
+                block_mark_used(block);
+                result = block_to_ptr(block);
+                heap->generation++;
+            }
+        }
+    }
+
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    if (result) {
+        size_t used = block_size(block_from_ptr(result)) + TLSF_HEADER_OVERHEAD;
+        heap->stats.alloc_count++;
+        heap->stats.used_bytes += used;
+        heap->stats.free_bytes -= used;
+        if (heap->stats.used_bytes > heap->stats.peak_used_bytes) {
+            heap->stats.peak_used_bytes = heap->stats.used_bytes;
+        }
+    } else {
+        heap->stats.alloc_failures++;
+    }
+    heap->stats.alloc_cycles_total += cycles;
+    if (cycles > heap->stats.alloc_cycles_max) {
+        heap->stats.alloc_cycles_max = cycles;
+    }
+    portEXIT_CRITICAL(&heap->lock);
+
+    return result;
+}
+
+void tlsf_heap_free(tlsf_heap_t* heap, void* ptr) {
+    if (!heap || !ptr) return;
+
+    if (!tlsf_heap_owns(heap, ptr)) {
+        ESP_LOGE(TAG, "🚨 %p does not belong to %s heap!", ptr, heap->name);
+        return;
+    }
+
+    tlsf_block_t* block = block_from_ptr(ptr);
+
+    portENTER_CRITICAL(&heap->lock);
+    if (block_is_free(block)) {
+        portEXIT_CRITICAL(&heap->lock);
+        ESP_LOGE(TAG, "🚨 Double free of %p in %s heap!", ptr, heap->name);
+        return;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    size_t used = block_size(block) + TLSF_HEADER_OVERHEAD;
+
+    block_mark_free(block);
+    block = merge_prev(heap, block);
+    block = merge_next(heap, block);
+    block_insert(heap, block);
+    heap->generation++;
+
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+
+    heap->stats.free_count++;
+    heap->stats.used_bytes -= used;
+    heap->stats.free_bytes += used;
+    heap->stats.free_cycles_total += cycles;
+    if (cycles > heap->stats.free_cycles_max) {
+        heap->stats.free_cycles_max = cycles;
+    }
+    portEXIT_CRITICAL(&heap->lock);
+}
+
+size_t tlsf_heap_block_size(const void* ptr) {
+    return ptr ? block_size(block_from_ptr(ptr)) : 0;
+}
+
+bool tlsf_heap_owns(const tlsf_heap_t* heap, const void* ptr) {
+    return heap && heap->magic == TLSF_HEAP_MAGIC &&
+           (const uint8_t*)ptr >= heap->pool_start &&
+           (const uint8_t*)ptr < heap->pool_end;
+}
+
+tlsf_heap_t* tlsf_heap_for_caps(uint32_t caps) {
+    tlsf_heap_t* found = NULL;
+
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < TLSF_MAX_HEAPS; i++) {
+        tlsf_heap_t* heap = registered_heaps[i];
+        if (heap && (heap->caps & caps) == caps) {
+            found = heap;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+
+    return found;
+}
+
+tlsf_heap_t* tlsf_heap_from_ptr(const void* ptr) {
+    tlsf_heap_t* found = NULL;
+
+    portENTER_CRITICAL(&registry_lock);
+    for (int i = 0; i < TLSF_MAX_HEAPS; i++) {
+        if (tlsf_heap_owns(registered_heaps[i], ptr)) {
+            found = registered_heaps[i];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&registry_lock);
+
+    return found;
+}
+
+void tlsf_heap_get_stats(tlsf_heap_t* heap, tlsf_heap_stats_t* stats) {
+    if (!heap || !stats) return;
+
+    portENTER_CRITICAL(&heap->lock);
+    *stats = heap->stats;
+    portEXIT_CRITICAL(&heap->lock);
+}
+
+void tlsf_heap_reset_worst_case(tlsf_heap_t* heap) {
+    if (!heap) return;
+
+    portENTER_CRITICAL(&heap->lock);
+    heap->stats.alloc_cycles_max = 0;
+    heap->stats.free_cycles_max = 0;
+    portEXIT_CRITICAL(&heap->lock);
+}
+
+// Walks every physical block; O(n), meant for monitor tasks only. The lock
+// is taken per chunk so allocations on other cores are never held off for
+// the whole walk.
+bool tlsf_heap_check_integrity(tlsf_heap_t* heap) {
+    if (!heap || heap->magic != TLSF_HEAP_MAGIC) return false;
+
+    for (int attempt = 0; attempt <= TLSF_CHECK_RESTARTS; attempt++) {
+        bool ok = true;
+        bool prev_free = false;
+        bool changed = false;
+        bool done = false;
+        tlsf_block_t* block = NULL;
+        uint32_t generation = 0;
+
+        while (ok && !done && !changed) {
+            portENTER_CRITICAL(&heap->lock);
+            if (!block) {
+                block = block_from_ptr(heap->pool_start);
+                generation = heap->generation;
+            } else if (heap->generation != generation) {
+                changed = true;   // Our position may have been merged away
+            }
+            for (int n = 0; !changed && n < TLSF_CHECK_CHUNK; n++) {
+                if ((uint8_t*)block_to_ptr(block) >= heap->pool_end) {
+                    ok = (uint8_t*)block_to_ptr(block) == heap->pool_end;
+                    done = true;
+                    break;
+                }
+                if (block_is_prev_free(block) != prev_free ||
+                    (prev_free && block_is_free(block))) {
+                    ok = false;   // Flags out of sync or two adjacent free blocks
+                    break;
+                }
+                prev_free = block_is_free(block);
+                block = block_next(block);
+            }
+            portEXIT_CRITICAL(&heap->lock);
+        }
+
+        if (!ok) {
+            ESP_LOGE(TAG, "❌ %s heap: block chain corrupted near %p", heap->name, block);
+            return false;
+        }
+        if (done) return true;
+    }
+
+    ESP_LOGW(TAG, "%s heap changed during %d integrity walks, check skipped",
+             heap->name, TLSF_CHECK_RESTARTS + 1);
+    return true;
+}
+
+void tlsf_heap_print_stats_all(void) {
+    ESP_LOGI(TAG, "\n⏱️ ═══ TLSF HEAP STATISTICS ═══");
+
+    for (int i = 0; i < TLSF_MAX_HEAPS; i++) {
+        tlsf_heap_t* heap = registered_heaps[i];
+        if (!heap) continue;
+
+        tlsf_heap_stats_t s;
+        tlsf_heap_get_stats(heap, &s);
+
+        ESP_LOGI(TAG, "%s heap (caps 0x%08lX):", s.name, (unsigned long)s.caps);
+        ESP_LOGI(TAG, "  Used / Free:      %d / %d bytes (peak %d)",
+                 (int)s.used_bytes, (int)s.free_bytes, (int)s.peak_used_bytes);
+        ESP_LOGI(TAG, "  Allocs / Frees:   %lu / %lu (failures %lu)",
+                 (unsigned long)s.alloc_count, (unsigned long)s.free_count,
+                 (unsigned long)s.alloc_failures);
+        ESP_LOGI(TAG, "  Alloc cycles:     max %lu, avg %lu",
+                 (unsigned long)s.alloc_cycles_max,
+                 (unsigned long)(s.alloc_count ? s.alloc_cycles_total / s.alloc_count : 0));
+        ESP_LOGI(TAG, "  Free cycles:      max %lu, avg %lu",
+                 (unsigned long)s.free_cycles_max,
+                 (unsigned long)(s.free_count ? s.free_cycles_total / s.free_count : 0));
+        ESP_LOGI(TAG, "  Integrity:        %s", tlsf_heap_check_integrity(heap) ? "OK" : "FAILED");
+    }
+
+    ESP_LOGI(TAG, "═══════════════════════════════");
+}
@@ -0,0 +1,53 @@
+#ifndef TLSF_HEAP_H
+#define TLSF_HEAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Two-Level Segregated Fit heap over a dedicated memory region.
+// malloc/free run in O(1) regardless of heap state, so the worst case
+// can be bounded for hard real-time tasks.
+
+#define TLSF_MAX_HEAPS  4   // Instances that can be registered at once
+
+typedef struct tlsf_heap tlsf_heap_t;
+
+typedef struct {
+    const char* name;
+    uint32_t caps;
+    size_t region_size;
+    size_t free_bytes;
+    size_t used_bytes;
+    size_t peak_used_bytes;
+    uint32_t alloc_count;
+    uint32_t free_count;
+    uint32_t alloc_failures;
+    uint32_t alloc_cycles_max;   // Worst-case malloc cost in CPU cycles
+    uint32_t free_cycles_max;    // Worst-case free cost in CPU cycles
+    uint64_t alloc_cycles_total;
+    uint64_t free_cycles_total;
+} tlsf_heap_stats_t;
+
+// Build a heap inside a caller-provided region (control block lives at its start)
+tlsf_heap_t* tlsf_heap_create(const char* name, void* region, size_t size, uint32_t caps);
+
+// Reserve a region with heap_caps_malloc(caps) and build a heap inside it
+tlsf_heap_t* tlsf_heap_create_with_caps(const char* name, size_t size, uint32_t caps);
+void tlsf_heap_destroy(tlsf_heap_t* heap);
+
+void* tlsf_heap_malloc(tlsf_heap_t* heap, size_t size);
+void tlsf_heap_free(tlsf_heap_t* heap, void* ptr);
+size_t tlsf_heap_block_size(const void* ptr);
+bool tlsf_heap_owns(const tlsf_heap_t* heap, const void* ptr);
+
+// Registry lookups across all created instances
+tlsf_heap_t* tlsf_heap_for_caps(uint32_t caps);
+tlsf_heap_t* tlsf_heap_from_ptr(const void* ptr);
+
+void tlsf_heap_get_stats(tlsf_heap_t* heap, tlsf_heap_stats_t* stats);
+void tlsf_heap_reset_worst_case(tlsf_heap_t* heap);
+bool tlsf_heap_check_integrity(tlsf_heap_t* heap);
+void tlsf_heap_print_stats_all(void);
+
+#endif
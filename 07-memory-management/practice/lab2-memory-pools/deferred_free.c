@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "deferred_free.h"
+
+static const char *TAG = "DEFER_FREE";
+
+// One Treiber stack per core. The reclaimer takes a whole list with a
+// single exchange, so pushes never race a pop and there is no ABA.
+typedef struct deferred_node {
+    struct deferred_node* next;
+} deferred_node_t;
+
+static _Atomic(deferred_node_t*) pending_lists[portNUM_PROCESSORS];
+static atomic_uint pending_count;
+
+static int group_count = 0;
+static deferred_classify_fn classify_block = NULL;
+static deferred_free_batch_fn free_block_batch = NULL;
+static TaskHandle_t reclaimer_task = NULL;
+
+static deferred_free_stats_t stats = {0};
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void deferred_free(void* ptr) {
+    if (!ptr) return;
+
+    // Counted before the node becomes visible: a drain that takes it
+    // (acquire, pairing with the release CAS) has also seen this increment,
+    // so its subtraction can never take the count below zero
+    unsigned pending = atomic_fetch_add_explicit(&pending_count, 1, memory_order_relaxed) + 1;
+
+    // The core id only spreads contention; migrating before the CAS is harmless
+    _Atomic(deferred_node_t*)* list = &pending_lists[xPortGetCoreID()];
+    deferred_node_t* node = (deferred_node_t*)ptr;
+    deferred_node_t* head = atomic_load_explicit(list, memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(list, &head, node,
+                                                    memory_order_release, memory_order_relaxed));
+
+    // Only the push that reaches the threshold pays for the notification
+    if (pending == DEFERRED_FREE_WAKE_PENDING && reclaimer_task) {
+        xTaskNotifyGive(reclaimer_task);
+    }
+}
+
+// Counting sort by group, then one free_batch call per non-empty group
+static void free_batch_grouped(void** blocks, int count) {
+    void* sorted[DEFERRED_FREE_BATCH_MAX];
+    uint8_t keys[DEFERRED_FREE_BATCH_MAX];
+    int starts[DEFERRED_FREE_MAX_GROUPS + 1] = {0};
+
+    for (int i = 0; i < count; i++) {
+        int key = classify_block(blocks[i]);
+        if (key < 0 || key >= group_count) key = group_count - 1;
+        keys[i] = key;
+        starts[key + 1]++;
+    }
+    for (int g = 0; g < group_count; g++) {
+        starts[g + 1] += starts[g];
+    }
+    int fill[DEFERRED_FREE_MAX_GROUPS];
+    memcpy(fill, starts, sizeof(fill));
+    for (int i = 0; i < count; i++) {
+        sorted[fill[keys[i]]++] = blocks[i];
+    }
+
+    uint32_t batches = 0;
+    for (int g = 0; g < group_count; g++) {
+        int n = starts[g + 1] - starts[g];
+        if (n > 0) {
+            free_block_batch(g, &sorted[starts[g]], n);
+            batches++;
+        }
+    }
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.reclaimed += count;
+    stats.batches += batches;
+    if (count > stats.largest_batch) {
+        stats.largest_batch = count;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+}
+
+void deferred_free_drain(void) {
+    if (!free_block_batch) return;
+
+    unsigned pending = atomic_load_explicit(&pending_count, memory_order_relaxed);
+    portENTER_CRITICAL(&stats_lock);
+    if (pending > stats.peak_pending) {
+        stats.peak_pending = pending;
+    }
+    portEXIT_CRITICAL(&stats_lock);
+
+    void* batch[DEFERRED_FREE_BATCH_MAX];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        deferred_node_t* node = atomic_exchange_explicit(&pending_lists[core], NULL,
+                                                         memory_order_acquire);
+        while (node) {
+            int count = 0;
+            while (node && count < DEFERRED_FREE_BATCH_MAX) {
+                batch[count++] = node;
+                node = node->next;
+            }
+            atomic_fetch_sub_explicit(&pending_count, count, memory_order_relaxed);
+            free_batch_grouped(batch, count);
+        }
+    }
+}
+
+static void reclaimer_task_fn(void *pvParameters) {
+    ESP_LOGI(TAG, "♻️ Reclaimer started (%d groups)", group_count);
+
+    while (1) {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DEFERRED_FREE_PERIOD_MS)) > 0) {
+            portENTER_CRITICAL(&stats_lock);
+            stats.early_wakeups++;
+            portEXIT_CRITICAL(&stats_lock);
+        }
+        deferred_free_drain();
+    }
+}
+
+bool deferred_free_init(int groups, deferred_classify_fn classify,
+                        deferred_free_batch_fn free_batch, UBaseType_t reclaimer_priority) {
+    if (groups <= 0 || groups > DEFERRED_FREE_MAX_GROUPS || !classify || !free_batch) {
+        ESP_LOGE(TAG, "Invalid deferred free configuration");
+        return false;
+    }
+
+    group_count = groups;
+    classify_block = classify;
+    free_block_batch = free_batch;
+
+    if (xTaskCreate(reclaimer_task_fn, "Reclaimer", 3072, NULL,
+                    reclaimer_priority, &reclaimer_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create reclaimer task");
+        free_block_batch = NULL;
+        return false;
+    }
+    return true;
+}
+
+uint32_t deferred_free_pending(void) {
+    return atomic_load_explicit(&pending_count, memory_order_relaxed);
+}
+
+void deferred_free_get_stats(deferred_free_stats_t* out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    out->deferred = stats.reclaimed + atomic_load_explicit(&pending_count, memory_order_relaxed);
+    portEXIT_CRITICAL(&stats_lock);
+}
@@ -0,0 +1,47 @@
+#ifndef DEFERRED_FREE_H
+#define DEFERRED_FREE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+// Deferred frees for latency-critical tasks. deferred_free() pushes the
+// block onto a lock-free list for the current core (the first word of the
+// dead block is reused as the link, so nothing is allocated), and a
+// low-priority reclaimer task later frees the blocks in batches, grouped
+// so each owner (e.g. one memory pool) is locked once per batch.
+
+#define DEFERRED_FREE_MAX_GROUPS    8
+#define DEFERRED_FREE_BATCH_MAX     32      // Blocks handed over per drain step
+#define DEFERRED_FREE_WAKE_PENDING  16      // Wake the reclaimer early at this backlog
+#define DEFERRED_FREE_PERIOD_MS     50
+
+// Group key in [0, groups) for a block, e.g. its pool index; anything
+// out of range goes to the last group
+typedef int (*deferred_classify_fn)(void* ptr);
+// Frees count blocks that all belong to group
+typedef void (*deferred_free_batch_fn)(int group, void** ptrs, int count);
+
+typedef struct {
+    uint32_t deferred;
+    uint32_t reclaimed;
+    uint32_t batches;               // free_batch calls
+    uint32_t largest_batch;
+    uint32_t peak_pending;
+    uint32_t early_wakeups;
+} deferred_free_stats_t;
+
+bool deferred_free_init(int groups, deferred_classify_fn classify,
+                        deferred_free_batch_fn free_batch, UBaseType_t reclaimer_priority);
+
+// Lock-free; ptr must be pointer-aligned and at least pointer-sized
+void deferred_free(void* ptr);
+
+// Reclaim everything pending now, from the calling task
+void deferred_free_drain(void);
+
+uint32_t deferred_free_pending(void);
+void deferred_free_get_stats(deferred_free_stats_t* out);
+
+#endif
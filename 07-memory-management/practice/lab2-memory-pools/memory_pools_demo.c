@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -11,6 +12,10 @@
 #include "esp_timer.h"
 #include "esp_system.h"
 #include "driver/gpio.h"
+#include "shared_buffer.h"
+#include "mem_kernels.h"
+#include "deferred_free.h"
+#include "log2_hist.h"
 
 static const char *TAG = "MEM_POOLS";
 
@@ -34,6 +39,24 @@ static const char *TAG = "MEM_POOLS";
 #define HUGE_POOL_BLOCK_SIZE    4096
 #define HUGE_POOL_BLOCK_COUNT   4
 
+// Shared buffer fan-out benchmark
+#define BROADCAST_ITERATIONS    200
+#define BROADCAST_MAX_CONSUMERS 8
+
+// Loop jitter of a high-priority task: inline vs deferred frees
+#define JITTER_PERIOD_MS        5
+#define JITTER_ITERATIONS       400
+#define JITTER_BLOCKS           8
+#define JITTER_TASK_PRIORITY    7     // Above every other lab task
+#define RECLAIMER_PRIORITY      1
+
+// Block lifetime histograms: bucket b counts lifetimes in [2^b, 2^(b+1)) μs,
+// the last bucket everything from ~134 s up
+#define LIFETIME_BUCKETS        28
+#define LIFETIME_MIN_SAMPLES    20
+#define LIFETIME_SHORT_US       (10 * 1000)        // p90 below: arena candidate
+#define LIFETIME_LONG_US        (10 * 1000 * 1000) // p50 above: static candidate
+
 // Pool management structures
 typedef struct memory_block {
     struct memory_block* next;
@@ -62,6 +85,7 @@ typedef struct {
     uint64_t allocation_time_total;
     uint64_t deallocation_time_total;
     uint32_t allocation_failures;
+    uint32_t lifetime_hist[LIFETIME_BUCKETS];
     
     // Synchronization
     SemaphoreHandle_t mutex;
@@ -235,6 +259,64 @@ void* pool_malloc(memory_pool_t* pool) {
     return result;
 }
 
+// Caller holds pool->mutex
+static void record_block_lifetime(memory_pool_t* pool, uint64_t lifetime_us) {
+    pool->lifetime_hist[log2_hist_bucket(lifetime_us, LIFETIME_BUCKETS)]++;
+}
+
+// Caller holds pool->mutex
+static bool pool_free_locked(memory_pool_t* pool, void* ptr) {
+    // Calculate block address from data pointer
+    size_t header_size = sizeof(memory_block_t);
+    memory_block_t* block = (memory_block_t*)((uint8_t*)ptr - header_size);
+    
+    // Verify block belongs to this pool
+    if (block->magic != POOL_MAGIC_ALLOC || block->pool_id != pool->pool_id) {
+        ESP_LOGE(TAG, "🚨 Invalid block %p for %s pool! Magic: 0x%08lX, Pool ID: %lu",
+                 ptr, pool->name, block->magic, block->pool_id);
+        gpio_set_level(LED_POOL_ERROR, 1);
+        return false;
+    }
+    
+    // Check if pointer is within pool bounds
+    size_t aligned_block_size = (pool->block_size + pool->alignment - 1) & 
+                               ~(pool->alignment - 1);
+    size_t total_block_size = header_size + aligned_block_size;
+    
+    if ((uint8_t*)block < (uint8_t*)pool->pool_memory ||
+        (uint8_t*)block >= (uint8_t*)pool->pool_memory + 
+                           (total_block_size * pool->block_count)) {
+        ESP_LOGE(TAG, "🚨 Block %p out of bounds for %s pool!", ptr, pool->name);
+        gpio_set_level(LED_POOL_ERROR, 1);
+        return false;
+    }
+    
+    // Calculate block index
+    size_t block_index = ((uint8_t*)block - (uint8_t*)pool->pool_memory) / 
+                        total_block_size;
+    
+    // Clear bitmap
+    if (block_index < pool->block_count) {
+        pool->usage_bitmap[block_index / 8] &= ~(1 << (block_index % 8));
+    }
+    
+    record_block_lifetime(pool, esp_timer_get_time() - block->alloc_time);
+    
+    // Mark as free and add to free list  
+    block->magic = POOL_MAGIC_FREE;
+    block->next = pool->free_list;
+    pool->free_list = block;
+    
+    // Update statistics
+    pool->allocated_blocks--;
+    pool->total_deallocations++;
+    
+    ESP_LOGD(TAG, "🟢 %s pool: freed block %p (index %d)", 
+             pool->name, ptr, (int)block_index);
+    
+    return true;
+}
+
 bool pool_free(memory_pool_t* pool, void* ptr) {
     if (!pool || !ptr || !pool->mutex) return false;
     
@@ -242,56 +324,7 @@ bool pool_free(memory_pool_t* pool, void* ptr) {
     bool result = false;
     
     if (xSemaphoreTake(pool->mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        // Calculate block address from data pointer
-        size_t header_size = sizeof(memory_block_t);
-        memory_block_t* block = (memory_block_t*)((uint8_t*)ptr - header_size);
-        
-        // Verify block belongs to this pool
-        if (block->magic != POOL_MAGIC_ALLOC || block->pool_id != pool->pool_id) {
-            ESP_LOGE(TAG, "🚨 Invalid block %p for %s pool! Magic: 0x%08lX, Pool ID: %lu",
-                     ptr, pool->name, block->magic, block->pool_id);
-            gpio_set_level(LED_POOL_ERROR, 1);
-            xSemaphoreGive(pool->mutex);
-            return false;
-        }
-        
-        // Check if pointer is within pool bounds
-        size_t aligned_block_size = (pool->block_size + pool->alignment - 1) & 
-                                   ~(pool->alignment - 1);
-        size_t total_block_size = header_size + aligned_block_size;
-        
-        if ((uint8_t*)block >= (uint8_t*)pool->pool_memory &&
-            (uint8_t*)block < (uint8_t*)pool->pool_memory + 
-                             (total_block_size * pool->block_count)) {
-            
-            // Calculate block index
-            size_t block_index = ((uint8_t*)block - (uint8_t*)pool->pool_memory) / 
-                                total_block_size;
-            
-            // Clear bitmap
-            if (block_index < pool->block_count) {
-                pool->usage_bitmap[block_index / 8] &= ~(1 << (block_index % 8));
-            }
-            
-            // Mark as free and add to free list  
-            block->magic = POOL_MAGIC_FREE;
-            block->next = pool->free_list;
-            pool->free_list = block;
-            
-            // Update statistics
-            pool->allocated_blocks--;
-            pool->total_deallocations++;
-            
-            ESP_LOGD(TAG, "🟢 %s pool: freed block %p (index %d)", 
-                     pool->name, ptr, (int)block_index);
-            
-            result = true;
-            
-        } else {
-            ESP_LOGE(TAG, "🚨 Block %p out of bounds for %s pool!", ptr, pool->name);
-            gpio_set_level(LED_POOL_ERROR, 1);
-        }
-        
+        result = pool_free_locked(pool, ptr);
         xSemaphoreGive(pool->mutex);
     }
     
@@ -301,39 +334,85 @@ bool pool_free(memory_pool_t* pool, void* ptr) {
     return result;
 }
 
-// Smart pool allocator - automatically selects appropriate pool
-void* smart_pool_malloc(size_t size) {
+// Frees several blocks of one pool under a single lock acquisition. Meant
+// for background callers: waits for the lock rather than dropping blocks.
+int pool_free_batch(memory_pool_t* pool, void** ptrs, int count) {
+    if (!pool || !pool->mutex) return 0;
+    
+    uint64_t start_time = esp_timer_get_time();
+    int freed = 0;
+    
+    if (xSemaphoreTake(pool->mutex, portMAX_DELAY) == pdTRUE) {
+        for (int i = 0; i < count; i++) {
+            if (ptrs[i] && pool_free_locked(pool, ptrs[i])) {
+                freed++;
+            }
+        }
+        xSemaphoreGive(pool->mutex);
+    }
+    
+    pool->deallocation_time_total += esp_timer_get_time() - start_time;
+    return freed;
+}
+
+bool pool_contains(const memory_pool_t* pool, const void* ptr) {
+    if (!pool || !pool->pool_memory) return false;
+    
+    size_t aligned_block_size = (pool->block_size + pool->alignment - 1) & 
+                               ~(pool->alignment - 1);
+    size_t total_block_size = sizeof(memory_block_t) + aligned_block_size;
+    const uint8_t* start = (const uint8_t*)pool->pool_memory;
+    
+    return (const uint8_t*)ptr >= start &&
+           (const uint8_t*)ptr < start + (total_block_size * pool->block_count);
+}
+
+// Best-fit pool selection without the LED feedback (for hot paths)
+void* pool_malloc_best_fit(size_t size, int* pool_index) {
     // Add small overhead for metadata if needed
     size_t required_size = size + 16; // Safety margin
     
-    // Find best-fit pool
     for (int i = 0; i < POOL_COUNT; i++) {
         if (required_size <= pools[i].block_size) {
             void* ptr = pool_malloc(&pools[i]);
             if (ptr) {
-                // Light up corresponding LED briefly
-                gpio_set_level(pool_configs[i].led_pin, 1);
-                vTaskDelay(pdMS_TO_TICKS(50));
-                gpio_set_level(pool_configs[i].led_pin, 0);
-                
-                ESP_LOGD(TAG, "🎯 Smart allocation: %d bytes from %s pool", 
-                         (int)size, pools[i].name);
+                if (pool_index) *pool_index = i;
                 return ptr;
             }
         }
     }
     
-    ESP_LOGW(TAG, "⚠️ No suitable pool for %d bytes, falling back to heap", (int)size);
+    if (pool_index) *pool_index = -1;
     return heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
 }
 
+// Smart pool allocator - automatically selects appropriate pool
+void* smart_pool_malloc(size_t size) {
+    int pool_index;
+    void* ptr = pool_malloc_best_fit(size, &pool_index);
+    
+    if (ptr && pool_index >= 0) {
+        // Light up corresponding LED briefly
+        gpio_set_level(pool_configs[pool_index].led_pin, 1);
+        vTaskDelay(pdMS_TO_TICKS(50));
+        gpio_set_level(pool_configs[pool_index].led_pin, 0);
+        
+        ESP_LOGD(TAG, "🎯 Smart allocation: %d bytes from %s pool", 
+                 (int)size, pools[pool_index].name);
+    } else if (ptr) {
+        ESP_LOGW(TAG, "⚠️ No suitable pool for %d bytes, falling back to heap", (int)size);
+    }
+    
+    return ptr;
+}
+
 bool smart_pool_free(void* ptr) {
     if (!ptr) return false;
     
-    // Try to free from each pool
+    // Free to the pool whose memory range holds the pointer
     for (int i = 0; i < POOL_COUNT; i++) {
-        if (pool_free(&pools[i], ptr)) {
-            return true;
+        if (pool_contains(&pools[i], ptr)) {
+            return pool_free(&pools[i], ptr);
         }
     }
     
@@ -343,6 +422,74 @@ bool smart_pool_free(void* ptr) {
     return true;
 }
 
+// Deferred frees: group = pool index, POOL_COUNT = general heap
+static int deferred_pool_classify(void* ptr) {
+    for (int i = 0; i < POOL_COUNT; i++) {
+        if (pool_contains(&pools[i], ptr)) {
+            return i;
+        }
+    }
+    return POOL_COUNT;
+}
+
+static void deferred_pool_free_batch(int group, void** ptrs, int count) {
+    if (group < POOL_COUNT) {
+        pool_free_batch(&pools[group], ptrs, count);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        heap_caps_free(ptrs[i]);
+    }
+}
+
+// Lifetime percentiles of freed blocks plus the age of the oldest live one,
+// and where the size class would be better served. Caller holds pool->mutex.
+static void print_lifetime_report(memory_pool_t* pool) {
+    uint32_t total = 0;
+    for (int b = 0; b < LIFETIME_BUCKETS; b++) {
+        total += pool->lifetime_hist[b];
+    }
+    
+    uint64_t now = esp_timer_get_time();
+    uint64_t oldest_live = 0;
+    size_t total_block_size = sizeof(memory_block_t) + 
+                              ((pool->block_size + pool->alignment - 1) & ~(pool->alignment - 1));
+    for (size_t i = 0; i < pool->block_count; i++) {
+        if (pool->usage_bitmap[i / 8] & (1 << (i % 8))) {
+            memory_block_t* block = (memory_block_t*)((uint8_t*)pool->pool_memory + i * total_block_size);
+            if (now - block->alloc_time > oldest_live) {
+                oldest_live = now - block->alloc_time;
+            }
+        }
+    }
+    
+    char p50[12], p90[12], p99[12], oldest[12];
+    log2_hist_format_us(oldest_live, oldest, sizeof(oldest));
+    if (total == 0) {
+        ESP_LOGI(TAG, "  Lifetime:        no frees yet, oldest live %s", oldest);
+        return;
+    }
+    uint64_t p50_us = log2_hist_percentile(pool->lifetime_hist, LIFETIME_BUCKETS, 50);
+    uint64_t p90_us = log2_hist_percentile(pool->lifetime_hist, LIFETIME_BUCKETS, 90);
+    log2_hist_format_us(p50_us, p50, sizeof(p50));
+    log2_hist_format_us(p90_us, p90, sizeof(p90));
+    log2_hist_format_us(log2_hist_percentile(pool->lifetime_hist, LIFETIME_BUCKETS, 99), p99, sizeof(p99));
+    ESP_LOGI(TAG, "  Lifetime:        p50 ≤%s, p90 ≤%s, p99 ≤%s (%lu frees), oldest live %s",
+             p50, p90, p99, (unsigned long)total, oldest);
+    
+    const char* advice;
+    if (total < LIFETIME_MIN_SAMPLES) {
+        advice = "not enough samples yet";
+    } else if (p90_us <= LIFETIME_SHORT_US) {
+        advice = "short-lived → per-task arena / scratch buffer";
+    } else if (p50_us >= LIFETIME_LONG_US || oldest_live >= 10 * LIFETIME_LONG_US) {
+        advice = "long-lived → static reservation";
+    } else {
+        advice = "mixed lifetimes → keep pooled";
+    }
+    ESP_LOGI(TAG, "  Placement:       %s", advice);
+}
+
 // Pool statistics and monitoring
 void print_pool_statistics(void) {
     ESP_LOGI(TAG, "
@@ -374,6 +521,8 @@ void print_pool_statistics(void) {
                 ESP_LOGI(TAG, "  Avg Dealloc Time: %lu μs", avg_dealloc_time);
             }
             
+            print_lifetime_report(pool);
+            
             xSemaphoreGive(pool->mutex);
         }
     }
@@ -482,7 +631,7 @@ void pool_stress_test_task(void *pvParameters) {
                 test_sizes[allocation_count] = size;
                 
                 // Write test pattern
-                memset(test_ptrs[allocation_count], 0xAA, size);
+                mk_fill32(test_ptrs[allocation_count], 0xAAAAAAAA, size);
                 
                 allocation_count++;
                 ESP_LOGI(TAG, "🏋️ Allocated %d bytes (%d/100)", (int)size, allocation_count);
@@ -494,18 +643,13 @@ void pool_stress_test_task(void *pvParameters) {
             
             if (test_ptrs[index]) {
                 // Verify test pattern before freeing
-                uint8_t* data = (uint8_t*)test_ptrs[index];
-                bool pattern_ok = true;
-                
-                for (size_t i = 0; i < test_sizes[index]; i++) {
-                    if (data[i] != 0xAA) {
-                        pattern_ok = false;
-                        break;
-                    }
-                }
+                size_t bad_offset;
+                bool pattern_ok = mk_verify32(test_ptrs[index], 0xAAAAAAAA, 
+                                              test_sizes[index], &bad_offset);
                 
                 if (!pattern_ok) {
-                    ESP_LOGE(TAG, "🚨 Data corruption detected in allocation %d!", index);
+                    ESP_LOGE(TAG, "🚨 Data corruption detected in allocation %d at offset %d!", 
+                             index, (int)bad_offset);
                     gpio_set_level(LED_POOL_ERROR, 1);
                 }
                 
@@ -631,10 +775,7 @@ void pool_pattern_test_task(void *pvParameters) {
                 tests[i].pattern = pattern;
                 
                 // Fill with pattern
-                uint32_t* data = (uint32_t*)tests[i].ptr;
-                for (size_t j = 0; j < size / sizeof(uint32_t); j++) {
-                    data[j] = pattern;
-                }
+                mk_fill32(tests[i].ptr, pattern, size);
                 
                 test_count++;
             }
@@ -650,15 +791,8 @@ void pool_pattern_test_task(void *pvParameters) {
         
         for (int i = 0; i < test_count; i++) {
             if (tests[i].ptr) {
-                uint32_t* data = (uint32_t*)tests[i].ptr;
-                bool pattern_ok = true;
-                
-                for (size_t j = 0; j < tests[i].size / sizeof(uint32_t); j++) {
-                    if (data[j] != tests[i].pattern) {
-                        pattern_ok = false;
-                        break;
-                    }
-                }
+                bool pattern_ok = mk_verify32(tests[i].ptr, tests[i].pattern, 
+                                              tests[i].size, NULL);
                 
                 if (!pattern_ok) {
                     corruptions++;
@@ -719,6 +853,265 @@ void pool_monitor_task(void *pvParameters) {
     }
 }
 
+typedef struct {
+    uint32_t mean_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t max_period_dev_us; // Worst wake-to-wake deviation from the period
+    uint32_t heap_fallbacks;    // Blocks that missed the pools and came from the heap
+} jitter_result_t;
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Periodic loop that allocates a few blocks, touches them and frees them
+// again, as a high-priority producer would; measures each iteration
+static void run_jitter_loop(bool deferred, jitter_result_t* result) {
+    static uint32_t loop_us[JITTER_ITERATIONS];
+    static const size_t block_sizes[JITTER_BLOCKS] = {24, 40, 100, 200, 24, 48, 180, 600};
+    void* blocks[JITTER_BLOCKS];
+    uint64_t total = 0;
+    uint32_t max_dev = 0;
+    uint64_t prev_start = 0;
+    uint32_t fallbacks = 0;
+    
+    TickType_t last_wake = xTaskGetTickCount();
+    for (int it = 0; it < JITTER_ITERATIONS; it++) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(JITTER_PERIOD_MS));
+        uint64_t start = esp_timer_get_time();
+        if (it > 0) {
+            int64_t dev = (int64_t)(start - prev_start) - JITTER_PERIOD_MS * 1000;
+            if (dev < 0) dev = -dev;
+            if (dev > max_dev) max_dev = dev;
+        }
+        prev_start = start;
+        
+        for (int b = 0; b < JITTER_BLOCKS; b++) {
+            int pool_index;
+            blocks[b] = pool_malloc_best_fit(block_sizes[b], &pool_index);
+            if (blocks[b] && pool_index < 0) fallbacks++;
+            if (blocks[b]) {
+                memset(blocks[b], it, block_sizes[b]);
+            }
+        }
+        for (int b = 0; b < JITTER_BLOCKS; b++) {
+            if (deferred) {
+                deferred_free(blocks[b]);
+            } else {
+                smart_pool_free(blocks[b]);
+            }
+        }
+        
+        loop_us[it] = esp_timer_get_time() - start;
+        total += loop_us[it];
+    }
+    
+    qsort(loop_us, JITTER_ITERATIONS, sizeof(uint32_t), compare_u32);
+    result->mean_us = total / JITTER_ITERATIONS;
+    result->p99_us = loop_us[(JITTER_ITERATIONS * 99) / 100];
+    result->max_us = loop_us[JITTER_ITERATIONS - 1];
+    result->max_period_dev_us = max_dev;
+    result->heap_fallbacks = fallbacks;
+}
+
+void free_jitter_test_task(void *pvParameters) {
+    ESP_LOGI(TAG, "⏱️ Free jitter test started");
+    
+    while (1) {
+        jitter_result_t inline_result, deferred_result;
+        
+        run_jitter_loop(false, &inline_result);
+        run_jitter_loop(true, &deferred_result);
+        
+        deferred_free_stats_t ds;
+        deferred_free_get_stats(&ds);
+        
+        ESP_LOGI(TAG, "\n⏱️ ═══ HIGH-PRIORITY LOOP JITTER (%d × %d ms, %d blocks) ═══",
+                 JITTER_ITERATIONS, JITTER_PERIOD_MS, JITTER_BLOCKS);
+        ESP_LOGI(TAG, "%-9s %8s %8s %8s %10s %8s", "Free", "Mean", "p99", "Max", "Period dev", "Heap");
+        ESP_LOGI(TAG, "%-9s %6luus %6luus %6luus %8luus %8lu", "inline",
+                 (unsigned long)inline_result.mean_us, (unsigned long)inline_result.p99_us,
+                 (unsigned long)inline_result.max_us, (unsigned long)inline_result.max_period_dev_us,
+                 (unsigned long)inline_result.heap_fallbacks);
+        ESP_LOGI(TAG, "%-9s %6luus %6luus %6luus %8luus %8lu", "deferred",
+                 (unsigned long)deferred_result.mean_us, (unsigned long)deferred_result.p99_us,
+                 (unsigned long)deferred_result.max_us, (unsigned long)deferred_result.max_period_dev_us,
+                 (unsigned long)deferred_result.heap_fallbacks);
+        if (deferred_result.heap_fallbacks > inline_result.heap_fallbacks) {
+            ESP_LOGW(TAG, "Deferred run fell back to the heap %lu times while frees were pending; "
+                     "its timings include heap_caps_malloc",
+                     (unsigned long)deferred_result.heap_fallbacks);
+        }
+        ESP_LOGI(TAG, "Reclaimer: %lu blocks in %lu batches (largest %lu), peak backlog %lu, %lu early wakeups",
+                 (unsigned long)ds.reclaimed, (unsigned long)ds.batches, (unsigned long)ds.largest_batch,
+                 (unsigned long)ds.peak_pending, (unsigned long)ds.early_wakeups);
+        
+        vTaskDelay(pdMS_TO_TICKS(60000));
+    }
+}
+
+// Shared buffer storage comes from the pools
+static void* shared_storage_alloc(size_t size) {
+    return pool_malloc_best_fit(size, NULL);
+}
+
+static void shared_storage_free(void* ptr) {
+    smart_pool_free(ptr);
+}
+
+// 1→N broadcast: by-value queue copies vs refcounted shared buffers
+static void run_broadcast_benchmark(size_t payload_size, int consumers) {
+    static uint8_t payload[HUGE_POOL_BLOCK_SIZE];
+    static uint8_t received[HUGE_POOL_BLOCK_SIZE];
+    QueueHandle_t copy_queues[BROADCAST_MAX_CONSUMERS] = {NULL};
+    QueueHandle_t view_queues[BROADCAST_MAX_CONSUMERS] = {NULL};
+    bool ready = true;
+    
+    for (int c = 0; c < consumers; c++) {
+        copy_queues[c] = xQueueCreate(2, payload_size);
+        view_queues[c] = xQueueCreate(2, sizeof(shared_buf_t));
+        ready = ready && copy_queues[c] && view_queues[c];
+    }
+    
+    if (ready) {
+        // By value: every consumer gets its own copy through its queue.
+        // Each successful send and receive copies the payload once.
+        uint64_t copy_bytes = 0;
+        size_t copy_peak = 0;
+        uint64_t start = esp_timer_get_time();
+        for (int i = 0; i < BROADCAST_ITERATIONS; i++) {
+            memset(payload, i & 0xFF, payload_size);
+            size_t in_flight = 0;
+            for (int c = 0; c < consumers; c++) {
+                if (xQueueSend(copy_queues[c], payload, 0) == pdPASS) {
+                    copy_bytes += payload_size;
+                    in_flight += payload_size;
+                }
+            }
+            if (in_flight > copy_peak) copy_peak = in_flight;
+            for (int c = 0; c < consumers; c++) {
+                if (xQueueReceive(copy_queues[c], received, 0) == pdPASS) {
+                    copy_bytes += payload_size;
+                }
+            }
+        }
+        uint64_t copy_time = esp_timer_get_time() - start;
+        
+        // Shared: one pool block, consumers receive a retained view.
+        // Views are copied through the queues, payloads only on write.
+        shared_buf_stats_t before, after;
+        shared_buf_reset_peak();
+        shared_buf_get_stats(&before);
+        uint32_t failed = 0;
+        uint64_t view_bytes = 0;
+        size_t views_peak = 0;
+        
+        start = esp_timer_get_time();
+        for (int i = 0; i < BROADCAST_ITERATIONS; i++) {
+            shared_buf_t msg;
+            if (!shared_buf_alloc(&msg, payload_size)) {
+                failed++;
+                continue;
+            }
+            memset(shared_buf_mutable(&msg), i & 0xFF, payload_size);
+            
+            size_t in_flight = 0;
+            for (int c = 0; c < consumers; c++) {
+                shared_buf_t view = shared_buf_retain(&msg);
+                if (xQueueSend(view_queues[c], &view, 0) != pdPASS) {
+                    shared_buf_release(&view);
+                } else {
+                    view_bytes += sizeof(shared_buf_t);
+                    in_flight += sizeof(shared_buf_t);
+                }
+            }
+            if (in_flight > views_peak) views_peak = in_flight;
+            shared_buf_release(&msg);
+            
+            for (int c = 0; c < consumers; c++) {
+                shared_buf_t view;
+                if (xQueueReceive(view_queues[c], &view, 0) == pdPASS) {
+                    view_bytes += sizeof(shared_buf_t);
+                    received[0] = ((const uint8_t*)shared_buf_data(&view))[0];
+                    shared_buf_release(&view);
+                }
+            }
+        }
+        uint64_t shared_time = esp_timer_get_time() - start;
+        shared_buf_get_stats(&after);
+        
+        uint64_t shared_bytes = view_bytes + (after.cow_bytes_copied - before.cow_bytes_copied);
+        size_t shared_peak = after.peak_live_bytes - before.live_bytes + views_peak;
+        
+        ESP_LOGI(TAG, "1→%d, %4d B: copy %6.1f μs/msg, %5lu B copied, %5d B peak | "
+                 "shared %6.1f μs/msg, %4lu B copied, %5d B peak%s",
+                 consumers, (int)payload_size,
+                 (float)copy_time / BROADCAST_ITERATIONS,
+                 (unsigned long)(copy_bytes / BROADCAST_ITERATIONS), (int)copy_peak,
+                 (float)shared_time / BROADCAST_ITERATIONS,
+                 (unsigned long)(shared_bytes / BROADCAST_ITERATIONS), (int)shared_peak,
+                 failed ? " (pool exhausted)" : "");
+        
+        if (after.releases - before.releases != after.allocations - before.allocations) {
+            ESP_LOGE(TAG, "🚨 Shared buffer leak in broadcast benchmark!");
+            gpio_set_level(LED_POOL_ERROR, 1);
+        }
+    }
+    
+    for (int c = 0; c < consumers; c++) {
+        if (copy_queues[c]) vQueueDelete(copy_queues[c]);
+        if (view_queues[c]) vQueueDelete(view_queues[c]);
+    }
+}
+
+void shared_buffer_broadcast_task(void *pvParameters) {
+    ESP_LOGI(TAG, "📡 Shared buffer broadcast test started");
+    
+    const size_t payload_sizes[] = {100, 900};
+    const int consumer_counts[] = {1, 2, 4, 8};
+    
+    while (1) {
+        ESP_LOGI(TAG, "\n📡 ═══ 1→N BROADCAST BENCHMARK ═══");
+        
+        for (int s = 0; s < 2; s++) {
+            for (int n = 0; n < 4; n++) {
+                run_broadcast_benchmark(payload_sizes[s], consumer_counts[n]);
+            }
+        }
+        
+        // Copy-on-write check: a writer must not disturb other holders
+        shared_buf_t original, reader, header;
+        if (shared_buf_alloc(&original, 64)) {
+            memset(shared_buf_mutable(&original), 0x11, 64);
+            reader = shared_buf_retain(&original);
+            shared_buf_slice(&original, 0, 16, &header);
+            
+            memset(shared_buf_mutable(&original), 0x22, 64);
+            bool isolated = ((const uint8_t*)shared_buf_data(&reader))[0] == 0x11 &&
+                            ((const uint8_t*)shared_buf_data(&header))[0] == 0x11 &&
+                            ((const uint8_t*)shared_buf_data(&original))[0] == 0x22;
+            ESP_LOGI(TAG, "Copy-on-write isolation: %s (reader refs %lu)",
+                     isolated ? "OK" : "FAILED", (unsigned long)shared_buf_refcount(&reader));
+            
+            shared_buf_release(&header);
+            shared_buf_release(&reader);
+            shared_buf_release(&original);
+        }
+        
+        shared_buf_stats_t st;
+        shared_buf_get_stats(&st);
+        ESP_LOGI(TAG, "Shared buffers: %lu allocs, %lu retains, %lu slices, %lu COW (%llu B), peak %d B",
+                 (unsigned long)st.allocations, (unsigned long)st.retains,
+                 (unsigned long)st.slices, (unsigned long)st.cow_copies,
+                 st.cow_bytes_copied, (int)st.peak_live_bytes);
+        
+        vTaskDelay(pdMS_TO_TICKS(45000));
+    }
+}
+
 void app_main(void) {
     ESP_LOGI(TAG, "🚀 Memory Pools Lab Starting...");
     
@@ -747,6 +1140,11 @@ void app_main(void) {
     }
     
     pools_initialized = true;
+    shared_buf_init(shared_storage_alloc, shared_storage_free);
+    if (!deferred_free_init(POOL_COUNT + 1, deferred_pool_classify,
+                            deferred_pool_free_batch, RECLAIMER_PRIORITY)) {
+        ESP_LOGW(TAG, "Deferred free unavailable");
+    }
     ESP_LOGI(TAG, "All memory pools initialized successfully");
     
     // Print initial pool status
@@ -759,6 +1157,8 @@ void app_main(void) {
     xTaskCreate(pool_stress_test_task, "StressTest", 3072, NULL, 5, NULL);
     xTaskCreate(pool_performance_test_task, "PerfTest", 3072, NULL, 4, NULL);
     xTaskCreate(pool_pattern_test_task, "PatternTest", 3072, NULL, 5, NULL);
+    xTaskCreate(shared_buffer_broadcast_task, "Broadcast", 3072, NULL, 3, NULL);
+    xTaskCreate(free_jitter_test_task, "FreeJitter", 3072, NULL, JITTER_TASK_PRIORITY, NULL);
     
     ESP_LOGI(TAG, "All tasks created successfully");
     
@@ -793,6 +1193,7 @@ void app_main(void) {
     ESP_LOGI(TAG, "  • Corruption Detection");
     ESP_LOGI(TAG, "  • Usage Visualization");
     ESP_LOGI(TAG, "  • Integrity Checking");
+    ESP_LOGI(TAG, "  • Refcounted Copy-on-Write Buffers");
     
     ESP_LOGI(TAG, "Memory Pool System operational!");
 }
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "shared_buffer.h"
+
+static const char *TAG = "SHARED_BUF";
+
+#define SHARED_MAGIC    0x53484246  // "SHBF"
+
+struct shared_storage {
+    _Atomic uint32_t refcount;
+    uint32_t capacity;
+    uint32_t magic;
+    uint32_t reserved;              // Keeps data[] 8-byte aligned
+    uint8_t data[];
+};
+
+static shared_alloc_fn storage_alloc = NULL;
+static shared_free_fn storage_free = NULL;
+
+// Counters are relaxed atomics so retain/slice/release never serialize the
+// cores on a lock; only the peak needs a critical section
+static struct {
+    atomic_uint allocations;
+    atomic_uint releases;
+    atomic_uint retains;
+    atomic_uint slices;
+    atomic_uint cow_copies;
+    _Atomic uint64_t cow_bytes_copied;
+    _Atomic size_t live_bytes;
+} counters;
+static size_t peak_live_bytes = 0;
+static portMUX_TYPE peak_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void shared_buf_init(shared_alloc_fn alloc_fn, shared_free_fn free_fn) {
+    storage_alloc = alloc_fn;
+    storage_free = free_fn;
+}
+
+static shared_storage_t* storage_create(size_t size) {
+    if (!storage_alloc) return NULL;
+
+    shared_storage_t* storage = storage_alloc(sizeof(shared_storage_t) + size);
+    if (!storage) return NULL;
+
+    atomic_init(&storage->refcount, 1);
+    storage->capacity = size;
+    storage->magic = SHARED_MAGIC;
+
+    atomic_fetch_add_explicit(&counters.allocations, 1, memory_order_relaxed);
+    size_t live = atomic_fetch_add_explicit(&counters.live_bytes, size, memory_order_relaxed) + size;
+    portENTER_CRITICAL(&peak_lock);
+    if (live > peak_live_bytes) {
+        peak_live_bytes = live;
+    }
+    portEXIT_CRITICAL(&peak_lock);
+
+    return storage;
+}
+
+static void storage_release(shared_storage_t* storage) {
+    if (atomic_fetch_sub_explicit(&storage->refcount, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // Last reference gone
+    atomic_fetch_add_explicit(&counters.releases, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&counters.live_bytes, storage->capacity, memory_order_relaxed);
+
+    storage->magic = 0;
+    storage_free(storage);
+}
+
+bool shared_buf_alloc(shared_buf_t* buf, size_t size) {
+    if (!buf || size == 0) return false;
+
+    buf->storage = storage_create(size);
+    buf->offset = 0;
+    buf->length = buf->storage ? size : 0;
+    return buf->storage != NULL;
+}
+
+shared_buf_t shared_buf_retain(const shared_buf_t* buf) {
+    shared_buf_t copy = {0};
+
+    if (buf && buf->storage) {
+        atomic_fetch_add_explicit(&buf->storage->refcount, 1, memory_order_relaxed);
+        copy = *buf;
+        atomic_fetch_add_explicit(&counters.retains, 1, memory_order_relaxed);
+    }
+
+    return copy;
+}
+
+void shared_buf_release(shared_buf_t* buf) {
+    if (!buf || !buf->storage) return;
+
+    if (buf->storage->magic != SHARED_MAGIC) {
+        ESP_LOGE(TAG, "🚨 Releasing corrupted or freed buffer %p!", buf->storage);
+        return;
+    }
+
+    storage_release(buf->storage);
+    buf->storage = NULL;
+    buf->offset = 0;
+    buf->length = 0;
+}
+
+bool shared_buf_slice(const shared_buf_t* buf, size_t offset, size_t length, shared_buf_t* out) {
+    if (!buf || !buf->storage || !out) return false;
+    if (offset > buf->length || length > buf->length - offset) return false;
+
+    *out = shared_buf_retain(buf);
+    out->offset += offset;
+    out->length = length;
+    atomic_fetch_add_explicit(&counters.slices, 1, memory_order_relaxed);
+
+    return true;
+}
+
+const void* shared_buf_data(const shared_buf_t* buf) {
+    return (buf && buf->storage) ? buf->storage->data + buf->offset : NULL;
+}
+
+uint32_t shared_buf_refcount(const shared_buf_t* buf) {
+    return (buf && buf->storage) ?
+           atomic_load_explicit(&buf->storage->refcount, memory_order_acquire) : 0;
+}
+
+void* shared_buf_mutable(shared_buf_t* buf) {
+    if (!buf || !buf->storage) return NULL;
+
+    // Sole owner can write in place
+    if (atomic_load_explicit(&buf->storage->refcount, memory_order_acquire) == 1) {
+        return buf->storage->data + buf->offset;
+    }
+
+    shared_storage_t* copy = storage_create(buf->length);
+    if (!copy) {
+        ESP_LOGW(TAG, "⚠️ Copy-on-write of %lu bytes failed", (unsigned long)buf->length);
+        return NULL;
+    }
+
+    memcpy(copy->data, buf->storage->data + buf->offset, buf->length);
+    storage_release(buf->storage);
+    buf->storage = copy;
+    buf->offset = 0;
+
+    atomic_fetch_add_explicit(&counters.cow_copies, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters.cow_bytes_copied, buf->length, memory_order_relaxed);
+
+    return copy->data;
+}
+
+void shared_buf_get_stats(shared_buf_stats_t* out) {
+    if (!out) return;
+
+    out->allocations = atomic_load_explicit(&counters.allocations, memory_order_relaxed);
+    out->releases = atomic_load_explicit(&counters.releases, memory_order_relaxed);
+    out->retains = atomic_load_explicit(&counters.retains, memory_order_relaxed);
+    out->slices = atomic_load_explicit(&counters.slices, memory_order_relaxed);
+    out->cow_copies = atomic_load_explicit(&counters.cow_copies, memory_order_relaxed);
+    out->cow_bytes_copied = atomic_load_explicit(&counters.cow_bytes_copied, memory_order_relaxed);
+    out->live_bytes = atomic_load_explicit(&counters.live_bytes, memory_order_relaxed);
+    portENTER_CRITICAL(&peak_lock);
+    out->peak_live_bytes = peak_live_bytes;
+    portEXIT_CRITICAL(&peak_lock);
+}
+
+void shared_buf_reset_peak(void) {
+    portENTER_CRITICAL(&peak_lock);
+    peak_live_bytes = atomic_load_explicit(&counters.live_bytes, memory_order_relaxed);
+    portEXIT_CRITICAL(&peak_lock);
+}
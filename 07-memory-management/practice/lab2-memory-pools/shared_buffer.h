@@ -0,0 +1,55 @@
+#ifndef SHARED_BUFFER_H
+#define SHARED_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Reference-counted buffers for 1→N fan-out. A shared_buf_t is a small
+// view (storage + offset + length) that can be passed through queues by
+// value; every view holds one reference on the underlying storage.
+
+typedef struct shared_storage shared_storage_t;
+
+typedef struct {
+    shared_storage_t* storage;
+    uint32_t offset;
+    uint32_t length;
+} shared_buf_t;
+
+typedef void* (*shared_alloc_fn)(size_t size);
+typedef void (*shared_free_fn)(void* ptr);
+
+typedef struct {
+    uint32_t allocations;
+    uint32_t releases;          // Storage actually returned to the pool
+    uint32_t retains;
+    uint32_t slices;
+    uint32_t cow_copies;
+    uint64_t cow_bytes_copied;
+    size_t live_bytes;
+    size_t peak_live_bytes;
+} shared_buf_stats_t;
+
+// Storage comes from the pool layer through these callbacks
+void shared_buf_init(shared_alloc_fn alloc_fn, shared_free_fn free_fn);
+
+bool shared_buf_alloc(shared_buf_t* buf, size_t size);
+shared_buf_t shared_buf_retain(const shared_buf_t* buf);
+void shared_buf_release(shared_buf_t* buf);
+
+// New view onto part of buf; shares (and retains) the same storage
+bool shared_buf_slice(const shared_buf_t* buf, size_t offset, size_t length, shared_buf_t* out);
+
+const void* shared_buf_data(const shared_buf_t* buf);
+uint32_t shared_buf_refcount(const shared_buf_t* buf);
+
+// Writable pointer; copies the viewed bytes first if the storage is shared
+void* shared_buf_mutable(shared_buf_t* buf);
+
+void shared_buf_get_stats(shared_buf_stats_t* stats);
+
+// Restarts peak_live_bytes from the current live_bytes, to measure one phase
+void shared_buf_reset_peak(void);
+
+#endif
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "aligned_pool.h"
+
+static const char *TAG = "ALIGN_POOL";
+
+// Slabs never need more than a cache line / DMA burst of alignment;
+// stricter requests go to heap_caps_aligned_alloc
+#define ALIGNED_MAX_ALIGNMENT   64
+
+// When the best class is empty, try at most this many bigger ones before
+// falling back, so small requests cannot drain the few large blocks
+#define ALIGNED_SPILL_CLASSES   2
+
+// Power-of-two classes plus the 1.5× steps between them, which keep the
+// alignment of their lowest set bit (48 → 16, 96 → 32, 192+ → 64)
+static const uint16_t class_sizes[ALIGNED_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 2048, ALIGNED_MAX_BLOCK
+};
+
+typedef struct aligned_free_block {
+    struct aligned_free_block* next;
+} aligned_free_block_t;
+
+typedef struct {
+    uint8_t* slab;
+    uint8_t* slab_end;
+    aligned_free_block_t* free_list;
+    aligned_class_stats_t stats;
+} aligned_class_t;
+
+typedef struct {
+    const char* name;
+    uint32_t caps;
+    uint16_t counts[ALIGNED_CLASS_COUNT];
+    aligned_class_t classes[ALIGNED_CLASS_COUNT];
+    portMUX_TYPE lock;
+} aligned_arena_t;
+
+static aligned_arena_t arenas[ALIGNED_ARENA_COUNT] = {
+    {.name = "Internal", .caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | MALLOC_CAP_32BIT,
+     .counts = {16, 16, 8, 16, 8, 8, 4, 4, 4, 4, 2, 2, 2, 1}},
+    {.name = "DMA", .caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT | MALLOC_CAP_32BIT,
+     .counts = {8, 8, 0, 8, 0, 4, 0, 4, 0, 2, 0, 2, 0, 0}},
+};
+
+static uint32_t fallback_count = 0;
+static portMUX_TYPE fallback_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static size_t class_alignment(size_t block_size) {
+    size_t natural = block_size & -block_size;
+    return natural < ALIGNED_MAX_ALIGNMENT ? natural : ALIGNED_MAX_ALIGNMENT;
+}
+
+bool aligned_pool_init(void) {
+    bool ok = true;
+
+    for (int a = 0; a < ALIGNED_ARENA_COUNT; a++) {
+        aligned_arena_t* arena = &arenas[a];
+        portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+        arena->lock = unlocked;
+        size_t total = 0;
+
+        for (int c = 0; c < ALIGNED_CLASS_COUNT; c++) {
+            aligned_class_t* cls = &arena->classes[c];
+            size_t size = class_sizes[c];
+            size_t count = arena->counts[c];
+
+            memset(cls, 0, sizeof(aligned_class_t));
+            cls->stats.block_size = size;
+            cls->stats.alignment = class_alignment(size);
+            if (count == 0) continue;
+
+            cls->slab = heap_caps_aligned_alloc(cls->stats.alignment, size * count, arena->caps);
+            if (!cls->slab) {
+                ESP_LOGW(TAG, "⚠️ No %s slab for %d-byte class", arena->name, (int)size);
+                ok = false;
+                continue;
+            }
+            cls->slab_end = cls->slab + size * count;
+            cls->stats.block_count = count;
+            total += size * count;
+
+            // Thread blocks in address order
+            for (int i = count - 1; i >= 0; i--) {
+                aligned_free_block_t* block = (aligned_free_block_t*)(cls->slab + i * size);
+                block->next = cls->free_list;
+                cls->free_list = block;
+            }
+        }
+
+        ESP_LOGI(TAG, "✅ %s aligned pools: %d bytes", arena->name, (int)total);
+    }
+    return ok;
+}
+
+static aligned_arena_t* arena_for_caps(uint32_t caps) {
+    uint32_t required = caps & ~MALLOC_CAP_DEFAULT;
+    for (int a = 0; a < ALIGNED_ARENA_COUNT; a++) {
+        if ((required & ~arenas[a].caps) == 0) {
+            return &arenas[a];
+        }
+    }
+    return NULL;
+}
+
+void* aligned_pool_alloc(size_t size, size_t alignment, uint32_t caps) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        ESP_LOGE(TAG, "Invalid alignment: %d (must be power of 2)", (int)alignment);
+        return NULL;
+    }
+    if (size == 0) size = 1;
+
+    aligned_arena_t* arena = arena_for_caps(caps);
+    if (arena && alignment <= ALIGNED_MAX_ALIGNMENT && size <= ALIGNED_MAX_BLOCK) {
+        int candidates = 0;
+        portENTER_CRITICAL(&arena->lock);
+        for (int c = 0; c < ALIGNED_CLASS_COUNT && candidates <= ALIGNED_SPILL_CLASSES; c++) {
+            aligned_class_t* cls = &arena->classes[c];
+            if (cls->stats.block_size < size || cls->stats.alignment < alignment ||
+                cls->stats.block_count == 0) {
+                continue;
+            }
+            candidates++;
+            aligned_free_block_t* block = cls->free_list;
+            if (!block) {
+                cls->stats.exhausted++;
+                continue;
+            }
+            cls->free_list = block->next;
+            cls->stats.in_use++;
+            if (cls->stats.in_use > cls->stats.peak_in_use) {
+                cls->stats.peak_in_use = cls->stats.in_use;
+            }
+            cls->stats.allocations++;
+            cls->stats.bytes_requested += size;
+            portEXIT_CRITICAL(&arena->lock);
+            return block;
+        }
+        portEXIT_CRITICAL(&arena->lock);
+    }
+
+    void* ptr = heap_caps_aligned_alloc(alignment, size, caps);
+    if (ptr) {
+        portENTER_CRITICAL(&fallback_lock);
+        fallback_count++;
+        portEXIT_CRITICAL(&fallback_lock);
+    }
+    return ptr;
+}
+
+static aligned_class_t* class_for_ptr(const void* ptr, aligned_arena_t** arena_out) {
+    const uint8_t* p = (const uint8_t*)ptr;
+    for (int a = 0; a < ALIGNED_ARENA_COUNT; a++) {
+        for (int c = 0; c < ALIGNED_CLASS_COUNT; c++) {
+            aligned_class_t* cls = &arenas[a].classes[c];
+            if (p >= cls->slab && p < cls->slab_end) {
+                *arena_out = &arenas[a];
+                return cls;
+            }
+        }
+    }
+    return NULL;
+}
+
+void aligned_pool_free(void* ptr) {
+    if (!ptr) return;
+
+    aligned_arena_t* arena;
+    aligned_class_t* cls = class_for_ptr(ptr, &arena);
+    if (!cls) {
+        heap_caps_free(ptr);
+        return;
+    }
+    if (((uint8_t*)ptr - cls->slab) % cls->stats.block_size != 0) {
+        ESP_LOGE(TAG, "🚨 %p is not a block start in the %s %d-byte class",
+                 ptr, arena->name, cls->stats.block_size);
+        return;
+    }
+
+    aligned_free_block_t* block = (aligned_free_block_t*)ptr;
+    portENTER_CRITICAL(&arena->lock);
+    block->next = cls->free_list;
+    cls->free_list = block;
+    cls->stats.in_use--;
+    portEXIT_CRITICAL(&arena->lock);
+}
+
+size_t aligned_pool_block_size(const void* ptr) {
+    aligned_arena_t* arena;
+    aligned_class_t* cls = class_for_ptr(ptr, &arena);
+    return cls ? cls->stats.block_size : 0;
+}
+
+bool aligned_pool_get_class_stats(int arena, int cls, aligned_class_stats_t* out) {
+    if (arena < 0 || arena >= ALIGNED_ARENA_COUNT || cls < 0 || cls >= ALIGNED_CLASS_COUNT) {
+        return false;
+    }
+    portENTER_CRITICAL(&arenas[arena].lock);
+    *out = arenas[arena].classes[cls].stats;
+    portEXIT_CRITICAL(&arenas[arena].lock);
+    return true;
+}
+
+uint32_t aligned_pool_fallbacks(void) {
+    return fallback_count;
+}
+
+uint32_t aligned_pool_blocks_in_use(void) {
+    uint32_t total = 0;
+    for (int a = 0; a < ALIGNED_ARENA_COUNT; a++) {
+        for (int c = 0; c < ALIGNED_CLASS_COUNT; c++) {
+            total += arenas[a].classes[c].stats.in_use;
+        }
+    }
+    return total;
+}
+
+void aligned_pool_print_stats(void) {
+    ESP_LOGI(TAG, "Aligned pools (fallbacks to heap_caps_aligned_alloc: %lu):",
+             (unsigned long)fallback_count);
+    for (int a = 0; a < ALIGNED_ARENA_COUNT; a++) {
+        for (int c = 0; c < ALIGNED_CLASS_COUNT; c++) {
+            aligned_class_stats_t st;
+            aligned_pool_get_class_stats(a, c, &st);
+            if (st.block_count == 0 || st.allocations == 0) continue;
+
+            uint64_t block_bytes = (uint64_t)st.block_size * st.allocations;
+            ESP_LOGI(TAG, "  %-8s %4d B/%2d: %2d/%2d in use (peak %d), %lu allocs, %.0f%% fill, %lu exhausted",
+                     arenas[a].name, st.block_size, st.alignment, st.in_use, st.block_count,
+                     st.peak_in_use, (unsigned long)st.allocations,
+                     st.bytes_requested * 100.0 / block_bytes, (unsigned long)st.exhausted);
+        }
+    }
+}
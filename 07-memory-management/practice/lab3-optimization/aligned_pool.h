@@ -0,0 +1,45 @@
+#ifndef ALIGNED_POOL_H
+#define ALIGNED_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Aligned allocation from naturally aligned size-class pools. Each class
+// is one slab aligned to the class's largest power-of-two factor, so every
+// block is aligned to at least that much without padding or a header:
+// 64-byte blocks are 64-aligned, 96-byte blocks 32-aligned, and so on.
+// A request takes the smallest class that fits both its size and its
+// alignment. Slabs exist per capability set (internal, DMA); anything
+// the pools cannot serve goes to heap_caps_aligned_alloc.
+
+#define ALIGNED_CLASS_COUNT     14
+#define ALIGNED_ARENA_COUNT     2
+#define ALIGNED_MAX_BLOCK       4096
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t alignment;
+    uint16_t block_count;
+    uint16_t in_use;
+    uint16_t peak_in_use;
+    uint32_t allocations;
+    uint32_t exhausted;             // Requests that moved to a bigger class or fell back
+    uint64_t bytes_requested;       // Sum of requested sizes (vs block_size × allocations)
+} aligned_class_stats_t;
+
+bool aligned_pool_init(void);
+
+// caps as for heap_caps_malloc; alignment must be a power of two
+void* aligned_pool_alloc(size_t size, size_t alignment, uint32_t caps);
+void aligned_pool_free(void* ptr);
+
+// Usable size of a pool block (block_size), 0 for fallback allocations
+size_t aligned_pool_block_size(const void* ptr);
+
+bool aligned_pool_get_class_stats(int arena, int cls, aligned_class_stats_t* out);
+uint32_t aligned_pool_fallbacks(void);
+uint32_t aligned_pool_blocks_in_use(void);
+void aligned_pool_print_stats(void);
+
+#endif
@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mem_bench.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static const char *TAG = "MEM_BENCH";
+
+#define BENCH_LINE          32                  // ESP32 cache line
+#define BENCH_LOADS         (1 << 16)
+#define BENCH_BYTES_PER_RUN (2 * 1024 * 1024)
+
+static uint64_t bench_now_ns(void) {
+    return (uint64_t)esp_timer_get_time() * 1000;
+}
+
+static void* bench_alloc(size_t size, uint32_t caps) {
+    return heap_caps_aligned_alloc(BENCH_LINE, size, caps);
+}
+
+static void bench_free(void* ptr) {
+    heap_caps_free(ptr);
+}
+
+// Keeps the task watchdog quiet between measurements
+static void bench_yield(void) {
+    vTaskDelay(1);
+}
+#else
+#include <time.h>
+
+#define BENCH_LINE          64
+#define BENCH_LOADS         (1 << 22)
+#define BENCH_BYTES_PER_RUN (256 * 1024 * 1024)
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void* bench_alloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return aligned_alloc(BENCH_LINE, (size + BENCH_LINE - 1) & ~(size_t)(BENCH_LINE - 1));
+}
+
+static void bench_free(void* ptr) {
+    free(ptr);
+}
+
+static void bench_yield(void) {
+}
+#endif
+
+#define BENCH_MIN_BYTES     1024
+
+// Results are consumed here so the loops cannot be optimized away; the
+// barrier stops the compiler from merging repeated passes over a buffer
+static volatile uintptr_t bench_sink;
+#define BENCH_BARRIER() __asm__ volatile("" ::: "memory")
+
+// xorshift32: cheap and deterministic, so runs are comparable
+static uint32_t bench_rand(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void print_row(const char* region, const char* test, size_t bytes, size_t stride,
+                      double ns_per_access, double mb_per_s) {
+    printf("%s,%s,%u,%u,%.2f,%.1f\n", region, test, (unsigned)bytes, (unsigned)stride,
+           ns_per_access, mb_per_s);
+}
+
+void mem_bench_print_header(void) {
+    printf("region,test,bytes,stride,ns_per_access,mb_per_s\n");
+}
+
+// One node per cache line linked into a single random cycle (Sattolo),
+// so every load depends on the previous one and prefetching cannot help
+static void bench_pointer_chase(const char* region, uint8_t* buf, size_t bytes) {
+    size_t nodes = bytes / BENCH_LINE;
+    uint32_t seed = 0x9E3779B9;
+
+    for (size_t i = 0; i < nodes; i++) {
+        *(uintptr_t*)(buf + i * BENCH_LINE) = i;
+    }
+    for (size_t i = nodes - 1; i > 0; i--) {
+        size_t j = bench_rand(&seed) % i;
+        uintptr_t* a = (uintptr_t*)(buf + i * BENCH_LINE);
+        uintptr_t* b = (uintptr_t*)(buf + j * BENCH_LINE);
+        uintptr_t tmp = *a;
+        *a = *b;
+        *b = tmp;
+    }
+    for (size_t i = 0; i < nodes; i++) {
+        uintptr_t* slot = (uintptr_t*)(buf + i * BENCH_LINE);
+        *slot = (uintptr_t)(buf + *slot * BENCH_LINE);
+    }
+
+    // Warm up once around the cycle
+    void** p = (void**)buf;
+    for (size_t i = 0; i < nodes; i++) {
+        p = (void**)*p;
+    }
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_LOADS; i += 4) {
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+        p = (void**)*p;
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_sink = (uintptr_t)p;
+
+    print_row(region, "chase", bytes, BENCH_LINE, (double)elapsed / BENCH_LOADS, 0);
+}
+
+static void bench_stride(const char* region, uint8_t* buf, size_t bytes, size_t stride) {
+    size_t mask = bytes - 1;
+    size_t offset = 0;
+    uint32_t sum = 0;
+
+    uint64_t start = bench_now_ns();
+    for (int i = 0; i < BENCH_LOADS; i++) {
+        sum += *(volatile uint32_t*)(buf + offset);
+        offset = (offset + stride) & mask;
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_sink = sum;
+
+    print_row(region, "stride", bytes, stride, (double)elapsed / BENCH_LOADS, 0);
+}
+
+static size_t bench_passes(size_t bytes) {
+    size_t passes = BENCH_BYTES_PER_RUN / bytes;
+    return passes ? passes : 1;
+}
+
+static void print_bandwidth(const char* region, const char* test, size_t bytes,
+                            size_t passes, uint64_t elapsed_ns) {
+    double total = (double)bytes * passes;
+    double ns_per_word = elapsed_ns / (total / sizeof(uint32_t));
+    double mb_per_s = elapsed_ns ? total * 1000.0 / elapsed_ns : 0;
+    print_row(region, test, bytes, sizeof(uint32_t), ns_per_word, mb_per_s);
+}
+
+static void bench_bandwidth(const char* region, uint8_t* buf, size_t bytes) {
+    uint32_t* words = (uint32_t*)buf;
+    size_t count = bytes / sizeof(uint32_t);
+    size_t passes = bench_passes(bytes);
+
+    // Sequential read, four independent accumulators
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    uint64_t start = bench_now_ns();
+    for (size_t p = 0; p < passes; p++) {
+        for (size_t i = 0; i < count; i += 4) {
+            s0 += words[i];
+            s1 += words[i + 1];
+            s2 += words[i + 2];
+            s3 += words[i + 3];
+        }
+        BENCH_BARRIER();
+    }
+    uint64_t elapsed = bench_now_ns() - start;
+    bench_sink = s0 + s1 + s2 + s3;
+    print_bandwidth(region, "read", bytes, passes, elapsed);
+
+    // Sequential write
+    start = bench_now_ns();
+    for (size_t p = 0; p < passes; p++) {
+        uint32_t value = (uint32_t)p;
+        for (size_t i = 0; i < count; i++) {
+            words[i] = value;
+        }
+        BENCH_BARRIER();
+    }
+    elapsed = bench_now_ns() - start;
+    print_bandwidth(region, "write", bytes, passes, elapsed);
+
+    // Copy: first half to second half, counted as bytes read plus written
+    size_t half = bytes / 2;
+    start = bench_now_ns();
+    for (size_t p = 0; p < passes; p++) {
+        memcpy(buf + half, buf, half);
+        BENCH_BARRIER();
+    }
+    elapsed = bench_now_ns() - start;
+    print_bandwidth(region, "copy", bytes, passes, elapsed);
+}
+
+void mem_bench_run_region(const char* name, uint32_t caps, size_t max_bytes) {
+    if (max_bytes < BENCH_MIN_BYTES) return;
+
+    // Power-of-two working sets keep the stride wrap a simple mask
+    size_t bytes = BENCH_MIN_BYTES;
+    while (bytes * 2 <= max_bytes) {
+        bytes *= 2;
+    }
+
+    uint8_t* buf = bench_alloc(bytes, caps);
+    if (!buf) {
+#ifdef ESP_PLATFORM
+        ESP_LOGW(TAG, "⚠️ Could not allocate %d bytes for %s", (int)bytes, name);
+#endif
+        return;
+    }
+
+    for (size_t ws = BENCH_MIN_BYTES; ws <= bytes; ws *= 2) {
+        bench_pointer_chase(name, buf, ws);
+        bench_yield();
+    }
+
+    for (size_t stride = sizeof(uint32_t); stride <= bytes / 16 && stride <= 4096; stride *= 2) {
+        bench_stride(name, buf, bytes, stride);
+        bench_yield();
+    }
+
+    size_t last = 0;
+    for (size_t ws = 4 * BENCH_MIN_BYTES; ws <= bytes; ws *= 4) {
+        bench_bandwidth(name, buf, ws);
+        bench_yield();
+        last = ws;
+    }
+    if (last != bytes) {
+        bench_bandwidth(name, buf, bytes);  // Always include the largest set
+    }
+
+    bench_free(buf);
+}
+
+#ifdef ESP_PLATFORM
+void mem_bench_run_all(void) {
+    // Leave room for the rest of the system in each region
+    static const struct {
+        const char* name;
+        uint32_t caps;
+        size_t limit;
+    } regions[] = {
+        {"internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, 128 * 1024},
+        {"spiram",   MALLOC_CAP_SPIRAM,                     1024 * 1024},
+        {"dma",      MALLOC_CAP_DMA,                        64 * 1024},
+    };
+
+    mem_bench_print_header();
+    for (int i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+        size_t largest = heap_caps_get_largest_free_block(regions[i].caps) / 2;
+        if (largest < BENCH_MIN_BYTES) {
+            ESP_LOGI(TAG, "Skipping %s (not available)", regions[i].name);
+            continue;
+        }
+        size_t max_bytes = largest < regions[i].limit ? largest : regions[i].limit;
+        mem_bench_run_region(regions[i].name, regions[i].caps, max_bytes);
+    }
+}
+#else
+void mem_bench_run_all(void) {
+    mem_bench_print_header();
+    mem_bench_run_region("host", 0, 64 * 1024 * 1024);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        mem_bench_print_header();
+        mem_bench_run_region("host", 0, strtoul(argv[1], NULL, 10) * 1024);
+    } else {
+        mem_bench_run_all();
+    }
+    return 0;
+}
+#endif
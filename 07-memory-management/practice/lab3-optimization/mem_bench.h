@@ -0,0 +1,25 @@
+#ifndef MEM_BENCH_H
+#define MEM_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Memory hierarchy microbenchmarks, printed as CSV:
+//   region,test,bytes,stride,ns_per_access,mb_per_s
+//
+//   chase   - dependent loads over a random cycle (latency vs working set)
+//   stride  - one load every `stride` bytes over the largest working set
+//   read / write / copy - sequential bandwidth per working set
+//
+// The same file builds for the Linux host:
+//   gcc -O2 -o mem_bench mem_bench.c && ./mem_bench [max_kb]
+
+void mem_bench_print_header(void);
+
+// Runs every test on one allocation region; caps is ignored on the host
+void mem_bench_run_region(const char* name, uint32_t caps, size_t max_bytes);
+
+// Internal, SPIRAM (when present) and DMA-capable memory on target
+void mem_bench_run_all(void);
+
+#endif
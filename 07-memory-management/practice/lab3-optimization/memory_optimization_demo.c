@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -13,6 +14,8 @@
 #include "esp_attr.h"
 #include "driver/gpio.h"
 #include "soc/soc_memory_layout.h"
+#include "mem_bench.h"
+#include "aligned_pool.h"
 
 static const char *TAG = "MEM_OPT";
 
@@ -34,15 +37,71 @@ static const char *TAG = "MEM_OPT";
 #define TASK_STACK_SIZE      2048
 #define MAX_TASKS            4
 
+// Static task pool size classes (stack sizes in StackType_t units)
+#define TASK_STACK_SMALL     1536
+#define TASK_STACK_SMALL_COUNT  4
+#define TASK_STACK_MEDIUM    TASK_STACK_SIZE
+#define TASK_STACK_MEDIUM_COUNT MAX_TASKS
+#define TASK_STACK_LARGE     4096
+#define TASK_STACK_LARGE_COUNT  2
+#define TASK_CLASS_COUNT     3
+#define TASK_SLOT_COUNT      (TASK_STACK_SMALL_COUNT + TASK_STACK_MEDIUM_COUNT + TASK_STACK_LARGE_COUNT)
+#define TASK_SLOT_NONE       -1
+
+// Buddy allocator over the static region (power-of-two blocks, 64 B - 32 KB)
+#define BUDDY_REGION_SIZE    (STATIC_BUFFER_COUNT * STATIC_BUFFER_SIZE)
+#define BUDDY_MIN_BLOCK_LOG2 6
+#define BUDDY_MIN_BLOCK      (1 << BUDDY_MIN_BLOCK_LOG2)
+#define BUDDY_MAX_ORDER      9      // 64 B << 9 = 32 KB
+#define BUDDY_MAX_BLOCK      (BUDDY_MIN_BLOCK << BUDDY_MAX_ORDER)
+#define BUDDY_MIN_BLOCKS     (BUDDY_REGION_SIZE / BUDDY_MIN_BLOCK)
+#define BUDDY_BITMAP_WORDS   ((BUDDY_MIN_BLOCKS + 31) / 32)
+#define BUDDY_ORDER_NONE     0xFF
+
+// Aligned allocation benchmark
+#define ALIGNED_BENCH_ITERATIONS 500
+
+_Static_assert(BUDDY_REGION_SIZE % BUDDY_MAX_BLOCK == 0,
+               "Static region must be a whole number of top-order blocks");
+
 // Static allocations
-static uint8_t static_buffers[STATIC_BUFFER_COUNT][STATIC_BUFFER_SIZE] __attribute__((aligned(4)));
-static bool static_buffer_used[STATIC_BUFFER_COUNT] = {false};
+static uint8_t static_region[BUDDY_REGION_SIZE] __attribute__((aligned(BUDDY_MIN_BLOCK)));
+static uint32_t buddy_free_map[BUDDY_MAX_ORDER + 1][BUDDY_BITMAP_WORDS]; // 1 = free block
+static uint16_t buddy_free_count[BUDDY_MAX_ORDER + 1];
+static uint8_t buddy_block_order[BUDDY_MIN_BLOCKS];  // Order of allocated block starts
+static size_t buddy_bytes_in_use = 0;
 static SemaphoreHandle_t static_buffer_mutex;
 
-// Static task stacks
-static StackType_t task_stacks[MAX_TASKS][TASK_STACK_SIZE] __attribute__((aligned(8)));
-static StaticTask_t task_buffers[MAX_TASKS];
-static int next_task_slot = 0;
+// Static task stacks, one array per size class
+static StackType_t small_stacks[TASK_STACK_SMALL_COUNT][TASK_STACK_SMALL] __attribute__((aligned(8)));
+static StackType_t medium_stacks[TASK_STACK_MEDIUM_COUNT][TASK_STACK_MEDIUM] __attribute__((aligned(8)));
+static StackType_t large_stacks[TASK_STACK_LARGE_COUNT][TASK_STACK_LARGE] __attribute__((aligned(8)));
+
+typedef struct {
+    StaticTask_t tcb;
+    StackType_t* stack;
+    int next_free;              // Free list link, TASK_SLOT_NONE at the end
+    bool in_use;
+} task_slot_t;
+
+typedef struct {
+    const char* name;
+    uint32_t stack_size;
+    int free_head;
+    int in_use;
+    int peak_in_use;
+    uint32_t created;
+    uint32_t reclaimed;
+    uint32_t failures;
+} task_class_t;
+
+static task_slot_t task_slots[TASK_SLOT_COUNT];
+static task_class_t task_classes[TASK_CLASS_COUNT] = {
+    {"Small",  TASK_STACK_SMALL,  TASK_SLOT_NONE, 0, 0, 0, 0, 0},
+    {"Medium", TASK_STACK_MEDIUM, TASK_SLOT_NONE, 0, 0, 0, 0, 0},
+    {"Large",  TASK_STACK_LARGE,  TASK_SLOT_NONE, 0, 0, 0, 0, 0},
+};
+static portMUX_TYPE task_pool_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // Memory optimization statistics
 typedef struct {
@@ -53,6 +112,10 @@ typedef struct {
     size_t memory_saved_bytes;
     size_t fragmentation_reduced;
     uint64_t allocation_time_saved;
+    size_t buddy_splits;
+    size_t buddy_merges;
+    size_t buddy_bytes_requested;
+    size_t buddy_bytes_allocated;
 } optimization_stats_t;
 
 static optimization_stats_t opt_stats = {0};
@@ -87,20 +150,97 @@ typedef struct {
     bool is_dma_capable;
 } memory_region_info_t;
 
+// Buddy bitmap helpers (call with static_buffer_mutex held)
+static inline void buddy_set_free(int order, size_t index) {
+    buddy_free_map[order][index / 32] |= (1u << (index % 32));
+    buddy_free_count[order]++;
+}
+
+static inline void buddy_clear_free(int order, size_t index) {
+    buddy_free_map[order][index / 32] &= ~(1u << (index % 32));
+    buddy_free_count[order]--;
+}
+
+static inline bool buddy_is_free(int order, size_t index) {
+    return (buddy_free_map[order][index / 32] & (1u << (index % 32))) != 0;
+}
+
+static int buddy_order_for_size(size_t size) {
+    if (size == 0 || size > BUDDY_MAX_BLOCK) {
+        return -1;
+    }
+    
+    int order = 0;
+    while ((size_t)(BUDDY_MIN_BLOCK << order) < size) {
+        order++;
+    }
+    return order;
+}
+
+static size_t buddy_take_first_free(int order) {
+    size_t blocks = BUDDY_REGION_SIZE >> (BUDDY_MIN_BLOCK_LOG2 + order);
+    size_t words = (blocks + 31) / 32;
+    
+    for (size_t w = 0; w < words; w++) {
+        if (buddy_free_map[order][w]) {
+            size_t index = w * 32 + __builtin_ctz(buddy_free_map[order][w]);
+            buddy_clear_free(order, index);
+            return index;
+        }
+    }
+    return SIZE_MAX; // Unreachable while buddy_free_count[order] > 0
+}
+
+void buddy_init(void) {
+    memset(buddy_free_map, 0, sizeof(buddy_free_map));
+    memset(buddy_free_count, 0, sizeof(buddy_free_count));
+    memset(buddy_block_order, BUDDY_ORDER_NONE, sizeof(buddy_block_order));
+    
+    for (size_t i = 0; i < BUDDY_REGION_SIZE / BUDDY_MAX_BLOCK; i++) {
+        buddy_set_free(BUDDY_MAX_ORDER, i);
+    }
+    buddy_bytes_in_use = 0;
+}
+
 // Static buffer management
-void* allocate_static_buffer(void) {
+void* allocate_static_buffer(size_t size) {
     void* buffer = NULL;
+    int order = buddy_order_for_size(size);
+    
+    if (order < 0) {
+        ESP_LOGW(TAG, "Static buffer request of %d bytes out of range", (int)size);
+        return NULL;
+    }
     
     if (static_buffer_mutex && xSemaphoreTake(static_buffer_mutex, pdMS_TO_TICKS(100))) {
-        for (int i = 0; i < STATIC_BUFFER_COUNT; i++) {
-            if (!static_buffer_used[i]) {
-                static_buffer_used[i] = true;
-                buffer = static_buffers[i];
-                opt_stats.static_allocations++;
-                ESP_LOGD(TAG, "🟢 Static buffer %d allocated: %p", i, buffer);
-                gpio_set_level(LED_STATIC_ALLOC, 1);
-                break;
+        // Smallest order with a free block that can satisfy the request
+        int found = order;
+        while (found <= BUDDY_MAX_ORDER && buddy_free_count[found] == 0) {
+            found++;
+        }
+        
+        if (found <= BUDDY_MAX_ORDER) {
+            size_t index = buddy_take_first_free(found);
+            
+            // Split down, releasing the upper half at each level
+            while (found > order) {
+                found--;
+                index *= 2;
+                buddy_set_free(found, index + 1);
+                opt_stats.buddy_splits++;
             }
+            
+            size_t offset = index << (BUDDY_MIN_BLOCK_LOG2 + order);
+            buddy_block_order[offset >> BUDDY_MIN_BLOCK_LOG2] = order;
+            buffer = &static_region[offset];
+            
+            buddy_bytes_in_use += BUDDY_MIN_BLOCK << order;
+            opt_stats.static_allocations++;
+            opt_stats.buddy_bytes_requested += size;
+            opt_stats.buddy_bytes_allocated += BUDDY_MIN_BLOCK << order;
+            ESP_LOGD(TAG, "🟢 Static buffer %d bytes (order %d) allocated: %p", 
+                     (int)size, order, buffer);
+            gpio_set_level(LED_STATIC_ALLOC, 1);
         }
         xSemaphoreGive(static_buffer_mutex);
     }
@@ -111,25 +251,36 @@ void* allocate_static_buffer(void) {
 void free_static_buffer(void* buffer) {
     if (!buffer || !static_buffer_mutex) return;
     
+    uintptr_t offset = (uint8_t*)buffer - static_region;
+    if ((uint8_t*)buffer < static_region || offset >= BUDDY_REGION_SIZE ||
+        (offset & (BUDDY_MIN_BLOCK - 1)) != 0) {
+        ESP_LOGE(TAG, "🚨 %p is not a static buffer!", buffer);
+        return;
+    }
+    
     if (xSemaphoreTake(static_buffer_mutex, pdMS_TO_TICKS(100))) {
-        for (int i = 0; i < STATIC_BUFFER_COUNT; i++) {
-            if (buffer == static_buffers[i] && static_buffer_used[i]) {
-                static_buffer_used[i] = false;
-                ESP_LOGD(TAG, "🗑️ Static buffer %d freed: %p", i, buffer);
-                break;
-            }
-        }
+        int order = buddy_block_order[offset >> BUDDY_MIN_BLOCK_LOG2];
         
-        // Check if any static buffers still in use
-        bool any_used = false;
-        for (int i = 0; i < STATIC_BUFFER_COUNT; i++) {
-            if (static_buffer_used[i]) {
-                any_used = true;
-                break;
+        if (order == BUDDY_ORDER_NONE) {
+            ESP_LOGE(TAG, "🚨 Static buffer %p freed twice or never allocated!", buffer);
+        } else {
+            buddy_block_order[offset >> BUDDY_MIN_BLOCK_LOG2] = BUDDY_ORDER_NONE;
+            buddy_bytes_in_use -= BUDDY_MIN_BLOCK << order;
+            
+            // Merge with the buddy for as long as it is free too
+            size_t index = offset >> (BUDDY_MIN_BLOCK_LOG2 + order);
+            while (order < BUDDY_MAX_ORDER && buddy_is_free(order, index ^ 1)) {
+                buddy_clear_free(order, index ^ 1);
+                index >>= 1;
+                order++;
+                opt_stats.buddy_merges++;
             }
+            buddy_set_free(order, index);
+            
+            ESP_LOGD(TAG, "🗑️ Static buffer freed: %p", buffer);
         }
         
-        if (!any_used) {
+        if (buddy_bytes_in_use == 0) {
             gpio_set_level(LED_STATIC_ALLOC, 0);
         }
         
@@ -137,52 +288,45 @@ void free_static_buffer(void* buffer) {
     }
 }
 
-// Memory alignment optimization
+// Memory alignment optimization: served from naturally aligned size-class
+// pools, so there is no padding or pointer stash in front of the block
 void* aligned_malloc(size_t size, size_t alignment) {
-    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
-        ESP_LOGE(TAG, "Invalid alignment: %d (must be power of 2)", (int)alignment);
+    void* ptr = aligned_pool_alloc(size, alignment, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!ptr) {
         return NULL;
     }
     
-    // Allocate extra space for alignment
-    size_t total_size = size + alignment + sizeof(void*);
-    void* raw_ptr = malloc(total_size);
-    
-    if (!raw_ptr) {
-        return NULL;
-    }
-    
-    // Calculate aligned address
-    uintptr_t raw_addr = (uintptr_t)raw_ptr;
-    uintptr_t aligned_addr = ALIGN_UP(raw_addr + sizeof(void*), alignment);
-    void* aligned_ptr = (void*)aligned_addr;
-    
-    // Store original pointer before aligned address
-    void** orig_ptr_storage = (void**)aligned_addr - 1;
-    *orig_ptr_storage = raw_ptr;
-    
     opt_stats.alignment_optimizations++;
     opt_stats.dynamic_allocations++;
     
     ESP_LOGD(TAG, "🎯 Aligned malloc: %d bytes, %d-byte aligned at %p", 
-             (int)size, (int)alignment, aligned_ptr);
+             (int)size, (int)alignment, ptr);
     
-    gpio_set_level(LED_ALIGNMENT_OPT, 1);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    gpio_set_level(LED_ALIGNMENT_OPT, 0);
-    
-    return aligned_ptr;
+    return ptr;
 }
 
 void aligned_free(void* aligned_ptr) {
     if (!aligned_ptr) return;
     
-    // Retrieve original pointer
-    void** orig_ptr_storage = (void**)aligned_ptr - 1;
-    void* orig_ptr = *orig_ptr_storage;
-    
-    ESP_LOGD(TAG, "🗑️ Aligned free: %p (original: %p)", aligned_ptr, orig_ptr);
-    free(orig_ptr);
+    ESP_LOGD(TAG, "🗑️ Aligned free: %p", aligned_ptr);
+    aligned_pool_free(aligned_ptr);
+}
+
+// Previous over-allocating scheme, kept for the alignment benchmark
+static void* overalloc_aligned_malloc(size_t size, size_t alignment) {
+    void* raw_ptr = malloc(size + alignment + sizeof(void*));
+    if (!raw_ptr) {
+        return NULL;
+    }
+    uintptr_t aligned_addr = ALIGN_UP((uintptr_t)raw_ptr + sizeof(void*), alignment);
+    ((void**)aligned_addr)[-1] = raw_ptr;
+    return (void*)aligned_addr;
+}
+
+static void overalloc_aligned_free(void* aligned_ptr) {
+    if (aligned_ptr) {
+        free(((void**)aligned_ptr)[-1]);
+    }
 }
 
 // Struct packing optimization demonstration
@@ -310,14 +454,19 @@ void optimize_memory_access_patterns(void) {
     
     uint64_t sequential_time = esp_timer_get_time() - start_time;
     
-    // Random access test
+    // Random access test: indices are drawn up front so the loop measures
+    // memory access, not the RNG
+    static uint16_t random_indices[1024];
+    for (size_t i = 0; i < array_size; i++) {
+        random_indices[i] = esp_random() % array_size;
+    }
+    
     start_time = esp_timer_get_time();
     sum = 0;
     
     for (int iter = 0; iter < iterations; iter++) {
         for (size_t i = 0; i < array_size; i++) {
-            size_t random_index = esp_random() % array_size;
-            sum += test_array[random_index];
+            sum += test_array[random_indices[i]];
         }
     }
     
@@ -336,6 +485,10 @@ void optimize_memory_access_patterns(void) {
     uint32_t* matrix = aligned_malloc(matrix_size * matrix_size * sizeof(uint32_t), 64);
     
     if (matrix) {
+        for (size_t i = 0; i < matrix_size * matrix_size; i++) {
+            matrix[i] = i;
+        }
+        
         // Row-major access (cache-friendly)
         start_time = esp_timer_get_time();
         sum = 0;
@@ -397,7 +550,7 @@ void benchmark_allocation_strategies(void) {
     start_time = esp_timer_get_time();
     
     for (int i = 0; i < iterations; i++) {
-        void* ptr = allocate_static_buffer();
+        void* ptr = allocate_static_buffer(test_size);
         if (ptr) {
             memset(ptr, 0xFF, test_size);
             free_static_buffer(ptr);
@@ -449,34 +602,259 @@ void benchmark_allocation_strategies(void) {
     ESP_LOGI(TAG, "═══════════════════════════════════════");
 }
 
-// Static task creation demonstration
-BaseType_t create_static_task(TaskFunction_t task_function, const char* name, 
-                             UBaseType_t priority, void* parameters) {
-    if (next_task_slot >= MAX_TASKS) {
-        ESP_LOGE(TAG, "No more static task slots available");
+typedef void* (*aligned_alloc_fn)(size_t size, size_t alignment);
+typedef void (*aligned_free_fn)(void* ptr);
+
+static void* heap_caps_aligned_internal(size_t size, size_t alignment) {
+    return heap_caps_aligned_alloc(alignment, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+}
+
+// Average alloc+free time in ns; all pointers are checked for alignment
+static uint32_t time_aligned_pairs(aligned_alloc_fn alloc_fn, aligned_free_fn free_fn,
+                                   size_t size, size_t alignment, bool* aligned_ok) {
+    uint64_t start = esp_timer_get_time();
+    for (int i = 0; i < ALIGNED_BENCH_ITERATIONS; i++) {
+        void* ptr = alloc_fn(size, alignment);
+        if (!ptr || !IS_ALIGNED(ptr, alignment)) {
+            *aligned_ok = false;
+        }
+        free_fn(ptr);
+    }
+    return (esp_timer_get_time() - start) * 1000 / ALIGNED_BENCH_ITERATIONS;
+}
+
+void benchmark_aligned_allocation(void) {
+    ESP_LOGI(TAG, "\n🎯 ═══ ALIGNED ALLOCATION BENCHMARK ═══");
+    ESP_LOGI(TAG, "%5s %5s | %10s %10s %10s | %9s %9s",
+             "Align", "Size", "overalloc", "heap_caps", "pool", "Over B", "Pool B");
+    
+    const size_t alignments[] = {16, 32, 64};
+    const size_t sizes[] = {24, 100, 200, 1000};
+    
+    for (int a = 0; a < 3; a++) {
+        for (int s = 0; s < 4; s++) {
+            size_t align = alignments[a];
+            size_t size = sizes[s];
+            bool ok = true;
+            
+            uint32_t over_ns = time_aligned_pairs(overalloc_aligned_malloc, overalloc_aligned_free,
+                                                  size, align, &ok);
+            uint32_t caps_ns = time_aligned_pairs(heap_caps_aligned_internal, heap_caps_free,
+                                                  size, align, &ok);
+            uint32_t pool_ns = time_aligned_pairs(aligned_malloc, aligned_free, size, align, &ok);
+            
+            // Bytes reserved beyond the request: worst-case padding + stash
+            // for the old scheme, class rounding for the pools
+            void* probe = aligned_malloc(size, align);
+            size_t pool_block = aligned_pool_block_size(probe);
+            aligned_free(probe);
+            char pool_extra[12];
+            if (pool_block) {
+                snprintf(pool_extra, sizeof(pool_extra), "%d", (int)(pool_block - size));
+            } else {
+                snprintf(pool_extra, sizeof(pool_extra), "fallback");
+            }
+            
+            ESP_LOGI(TAG, "%5d %5d | %8luns %8luns %8luns | %9d %9s%s",
+                     (int)align, (int)size, (unsigned long)over_ns, (unsigned long)caps_ns,
+                     (unsigned long)pool_ns, (int)(align + sizeof(void*)),
+                     pool_extra, ok ? "" : " ❌ misaligned");
+        }
+    }
+    
+    ESP_LOGI(TAG, "═══════════════════════════════════════");
+}
+
+// Static task pool: threads the slots of each class onto its free list
+void task_pool_init(void) {
+    StackType_t* stacks[TASK_CLASS_COUNT] = {small_stacks[0], medium_stacks[0], large_stacks[0]};
+    const int counts[TASK_CLASS_COUNT] = {TASK_STACK_SMALL_COUNT, TASK_STACK_MEDIUM_COUNT, TASK_STACK_LARGE_COUNT};
+    int slot = 0;
+    
+    for (int c = 0; c < TASK_CLASS_COUNT; c++) {
+        task_classes[c].free_head = TASK_SLOT_NONE;
+        for (int i = counts[c] - 1; i >= 0; i--) {
+            task_slots[slot + i].stack = stacks[c] + (size_t)i * task_classes[c].stack_size;
+            task_slots[slot + i].in_use = false;
+            task_slots[slot + i].next_free = task_classes[c].free_head;
+            task_classes[c].free_head = slot + i;
+        }
+        slot += counts[c];
+    }
+    
+#if !CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP
+    ESP_LOGW(TAG, "⚠️ CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP is off; "
+             "only the churn test returns slots, by deleting its workers itself");
+#endif
+}
+
+static int task_slot_class(int slot) {
+    if (slot < TASK_STACK_SMALL_COUNT) return 0;
+    if (slot < TASK_STACK_SMALL_COUNT + TASK_STACK_MEDIUM_COUNT) return 1;
+    return 2;
+}
+
+static void task_slot_release(int slot) {
+    int c = task_slot_class(slot);
+    
+    portENTER_CRITICAL(&task_pool_lock);
+    if (task_slots[slot].in_use) {
+        task_slots[slot].in_use = false;
+        task_slots[slot].next_free = task_classes[c].free_head;
+        task_classes[c].free_head = slot;
+        task_classes[c].in_use--;
+        task_classes[c].reclaimed++;
+    }
+    portEXIT_CRITICAL(&task_pool_lock);
+}
+
+// Slots are found by their TCB, which is also the task handle
+static void task_slot_release_tcb(void* tcb) {
+    for (int slot = 0; slot < TASK_SLOT_COUNT; slot++) {
+        if (tcb == &task_slots[slot].tcb) {
+            task_slot_release(slot);
+            return;
+        }
+    }
+}
+
+#if CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP
+// Called by FreeRTOS once a deleted task's TCB is no longer used: from the
+// idle task for tasks that deleted themselves, otherwise from vTaskDelete()
+void vPortCleanUpTCB(void *pxTCB) {
+    task_slot_release_tcb(pxTCB);
+}
+#endif
+
+// Static task creation from the smallest size class that fits
+static BaseType_t create_static_task_handle(TaskFunction_t task_function, const char* name,
+                                            uint32_t stack_size, UBaseType_t priority,
+                                            void* parameters, TaskHandle_t* handle_out) {
+    int slot = TASK_SLOT_NONE;
+    int c;
+    
+    portENTER_CRITICAL(&task_pool_lock);
+    for (c = 0; c < TASK_CLASS_COUNT; c++) {
+        if (stack_size <= task_classes[c].stack_size && task_classes[c].free_head != TASK_SLOT_NONE) {
+            slot = task_classes[c].free_head;
+            task_classes[c].free_head = task_slots[slot].next_free;
+            task_slots[slot].in_use = true;
+            task_classes[c].in_use++;
+            task_classes[c].created++;
+            if (task_classes[c].in_use > task_classes[c].peak_in_use) {
+                task_classes[c].peak_in_use = task_classes[c].in_use;
+            }
+            break;
+        }
+    }
+    if (slot == TASK_SLOT_NONE) {
+        for (c = 0; c < TASK_CLASS_COUNT - 1 && stack_size > task_classes[c].stack_size; c++) {}
+        task_classes[c].failures++;
+    }
+    portEXIT_CRITICAL(&task_pool_lock);
+    
+    if (slot == TASK_SLOT_NONE) {
+        ESP_LOGE(TAG, "No static task slot available for %d-byte stack", (int)stack_size);
         return pdFAIL;
     }
     
     TaskHandle_t task_handle = xTaskCreateStatic(
         task_function,
         name,
-        TASK_STACK_SIZE,
+        task_classes[c].stack_size,
         parameters,
         priority,
-        task_stacks[next_task_slot],
-        &task_buffers[next_task_slot]
+        task_slots[slot].stack,
+        &task_slots[slot].tcb
     );
     
     if (task_handle) {
-        ESP_LOGI(TAG, "✅ Created static task '%s' in slot %d", name, next_task_slot);
-        next_task_slot++;
+        ESP_LOGD(TAG, "✅ Created static task '%s' in %s slot %d", name, task_classes[c].name, slot);
+        if (handle_out) *handle_out = task_handle;
         return pdPASS;
     } else {
         ESP_LOGE(TAG, "❌ Failed to create static task '%s'", name);
+        task_slot_release(slot);
         return pdFAIL;
     }
 }
 
+BaseType_t create_static_task(TaskFunction_t task_function, const char* name, 
+                             uint32_t stack_size, UBaseType_t priority, void* parameters) {
+    return create_static_task_handle(task_function, name, stack_size, priority, parameters, NULL);
+}
+
+void print_task_pool_statistics(void) {
+    ESP_LOGI(TAG, "Static Task Pool:");
+    for (int c = 0; c < TASK_CLASS_COUNT; c++) {
+        task_class_t* tc = &task_classes[c];
+        ESP_LOGI(TAG, "  %-6s (%4d): in use %d, peak %d, created %lu, reclaimed %lu, failed %lu",
+                 tc->name, (int)(tc->stack_size * sizeof(StackType_t)), tc->in_use, tc->peak_in_use,
+                 (unsigned long)tc->created, (unsigned long)tc->reclaimed, (unsigned long)tc->failures);
+    }
+}
+
+// Short-lived worker: touches its stack, then deletes itself. Without the
+// cleanup hook it parks instead and the churn task deletes it.
+static void churn_worker_task(void *pvParameters) {
+    volatile uint8_t scratch[256];
+    for (int i = 0; i < sizeof(scratch); i++) {
+        scratch[i] = (uint8_t)i;
+    }
+    xTaskNotifyGive((TaskHandle_t)pvParameters);
+#if CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP
+    vTaskDelete(NULL);
+#else
+    vTaskSuspend(NULL);
+#endif
+}
+
+#if !CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP
+// A suspended task is not running on any core, so vTaskDelete() finishes
+// with its TCB and stack right away and the slot can be reused
+static void reclaim_parked_task(TaskHandle_t worker) {
+    while (eTaskGetState(worker) != eSuspended) {
+        vTaskDelay(1);
+    }
+    vTaskDelete(worker);
+    task_slot_release_tcb(worker);
+}
+#endif
+
+void task_churn_test_task(void *pvParameters) {
+    const uint32_t stack_sizes[3] = {TASK_STACK_SMALL, TASK_STACK_MEDIUM, TASK_STACK_LARGE};
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    
+    ESP_LOGI(TAG, "🔁 Task churn test started");
+    
+    while (1) {
+        size_t heap_before = esp_get_free_heap_size();
+        uint32_t spawned = 0;
+        uint64_t start = esp_timer_get_time();
+        
+        for (int round = 0; round < 50; round++) {
+            uint32_t stack_size = stack_sizes[round % 3];
+            TaskHandle_t worker;
+            if (create_static_task_handle(churn_worker_task, "Churn", stack_size, 3, self, &worker) == pdPASS) {
+                ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+#if !CONFIG_FREERTOS_ENABLE_STATIC_TASK_CLEAN_UP
+                reclaim_parked_task(worker);
+#endif
+                spawned++;
+            }
+            // Let the idle task run its cleanup and reclaim the slot
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+        
+        uint64_t elapsed = esp_timer_get_time() - start;
+        ESP_LOGI(TAG, "🔁 Churn: %lu static tasks in %llu ms, heap delta %d bytes",
+                 (unsigned long)spawned, elapsed / 1000,
+                 (int)esp_get_free_heap_size() - (int)heap_before);
+        
+        vTaskDelay(pdMS_TO_TICKS(30000));
+    }
+}
+
 // Test tasks
 void optimization_test_task(void *pvParameters) {
     ESP_LOGI(TAG, "🧪 Optimization test task started");
@@ -495,6 +873,9 @@ void optimization_test_task(void *pvParameters) {
         vTaskDelay(pdMS_TO_TICKS(2000));
         
         benchmark_allocation_strategies();
+        vTaskDelay(pdMS_TO_TICKS(2000));
+        
+        benchmark_aligned_allocation();
         
         gpio_set_level(LED_OPTIMIZATION, 0);
         
@@ -506,15 +887,17 @@ void memory_usage_test_task(void *pvParameters) {
     ESP_LOGI(TAG, "📊 Memory usage test task started");
     
     while (1) {
-        // Test static buffer allocation
+        // Test static buffer allocation with mixed sizes
+        const size_t buffer_sizes[4] = {256, 1024, STATIC_BUFFER_SIZE, 2 * STATIC_BUFFER_SIZE};
         void* static_buffers[4] = {NULL};
         
         ESP_LOGI(TAG, "📊 Testing static buffer allocation...");
         for (int i = 0; i < 4; i++) {
-            static_buffers[i] = allocate_static_buffer();
+            static_buffers[i] = allocate_static_buffer(buffer_sizes[i]);
             if (static_buffers[i]) {
-                ESP_LOGI(TAG, "  Allocated static buffer %d: %p", i, static_buffers[i]);
-                memset(static_buffers[i], 0x55, STATIC_BUFFER_SIZE);
+                ESP_LOGI(TAG, "  Allocated static buffer %d (%d bytes): %p", 
+                         i, (int)buffer_sizes[i], static_buffers[i]);
+                memset(static_buffers[i], 0x55, buffer_sizes[i]);
             }
         }
         
@@ -556,6 +939,18 @@ void memory_usage_test_task(void *pvParameters) {
     }
 }
 
+// Full hierarchy sweep (CSV on the console); heavy, so it runs once
+void memory_benchmark_task(void *pvParameters) {
+    vTaskDelay(pdMS_TO_TICKS(5000));
+    
+    ESP_LOGI(TAG, "📏 Memory hierarchy benchmark (CSV follows)");
+    uint64_t start = esp_timer_get_time();
+    mem_bench_run_all();
+    ESP_LOGI(TAG, "📏 Benchmark finished in %llu ms", (esp_timer_get_time() - start) / 1000);
+    
+    vTaskDelete(NULL);
+}
+
 void optimization_monitor_task(void *pvParameters) {
     ESP_LOGI(TAG, "📈 Optimization monitor started");
     
@@ -571,6 +966,18 @@ void optimization_monitor_task(void *pvParameters) {
         ESP_LOGI(TAG, "Memory Saved:            %d bytes (%.1f KB)", 
                  (int)opt_stats.memory_saved_bytes, opt_stats.memory_saved_bytes / 1024.0);
         ESP_LOGI(TAG, "Time Saved:              %llu μs", opt_stats.allocation_time_saved);
+        ESP_LOGI(TAG, "Buddy Splits / Merges:   %d / %d", 
+                 (int)opt_stats.buddy_splits, (int)opt_stats.buddy_merges);
+        ESP_LOGI(TAG, "Buddy In Use:            %d / %d bytes", 
+                 (int)buddy_bytes_in_use, BUDDY_REGION_SIZE);
+        if (opt_stats.buddy_bytes_allocated > 0) {
+            ESP_LOGI(TAG, "Buddy Fill Ratio:        %.1f%% (requested / allocated)",
+                     opt_stats.buddy_bytes_requested * 100.0 / opt_stats.buddy_bytes_allocated);
+        }
+        
+        print_task_pool_statistics();
+        aligned_pool_print_stats();
+        gpio_set_level(LED_ALIGNMENT_OPT, aligned_pool_blocks_in_use() > 0);
         
         // Update LED based on savings
         if (opt_stats.memory_saved_bytes > 1024) {
@@ -614,6 +1021,11 @@ void app_main(void) {
         ESP_LOGE(TAG, "Failed to create static buffer mutex!");
         return;
     }
+    buddy_init();
+    task_pool_init();
+    if (!aligned_pool_init()) {
+        ESP_LOGW(TAG, "Some aligned pools unavailable, those sizes use heap_caps_aligned_alloc");
+    }
     
     ESP_LOGI(TAG, "Static memory system initialized");
     
@@ -625,23 +1037,26 @@ void app_main(void) {
     
     ESP_LOGI(TAG, "
 🏗️ ═══ STATIC ALLOCATION SETUP ═══");
-    ESP_LOGI(TAG, "Static buffers: %d × %d bytes = %d KB total",
-             STATIC_BUFFER_COUNT, STATIC_BUFFER_SIZE,
-             (STATIC_BUFFER_COUNT * STATIC_BUFFER_SIZE) / 1024);
-    ESP_LOGI(TAG, "Task stacks: %d × %d bytes = %d KB total",
-             MAX_TASKS, (int)(TASK_STACK_SIZE * sizeof(StackType_t)),
-             (int)((MAX_TASKS * TASK_STACK_SIZE * sizeof(StackType_t)) / 1024));
+    ESP_LOGI(TAG, "Static buddy region: %d KB total (%d B - %d KB blocks)",
+             BUDDY_REGION_SIZE / 1024, BUDDY_MIN_BLOCK, BUDDY_MAX_BLOCK / 1024);
+    ESP_LOGI(TAG, "Task stacks: %d × %d + %d × %d + %d × %d bytes = %d KB total",
+             TASK_STACK_SMALL_COUNT, (int)(TASK_STACK_SMALL * sizeof(StackType_t)),
+             TASK_STACK_MEDIUM_COUNT, (int)(TASK_STACK_MEDIUM * sizeof(StackType_t)),
+             TASK_STACK_LARGE_COUNT, (int)(TASK_STACK_LARGE * sizeof(StackType_t)),
+             (int)((sizeof(small_stacks) + sizeof(medium_stacks) + sizeof(large_stacks)) / 1024));
     ESP_LOGI(TAG, "═══════════════════════════════════════");
     
     // Create tasks using static allocation
     ESP_LOGI(TAG, "Creating optimization test tasks...");
     
     // Use both static and dynamic task creation for demonstration
-    create_static_task(optimization_test_task, "OptTest", 5, NULL);
-    create_static_task(memory_usage_test_task, "MemUsage", 4, NULL);
+    create_static_task(optimization_test_task, "OptTest", TASK_STACK_SIZE, 5, NULL);
+    create_static_task(memory_usage_test_task, "MemUsage", TASK_STACK_SIZE, 4, NULL);
+    create_static_task(task_churn_test_task, "Churn", TASK_STACK_MEDIUM, 2, NULL);
     
     // Use regular dynamic allocation for monitor task
     xTaskCreate(optimization_monitor_task, "OptMonitor", 3072, NULL, 6, NULL);
+    xTaskCreate(memory_benchmark_task, "MemBench", 3072, NULL, 1, NULL);
     
     ESP_LOGI(TAG, "All tasks created successfully");
     
@@ -660,6 +1075,7 @@ void app_main(void) {
     ESP_LOGI(TAG, "  • Struct Packing Optimization");
     ESP_LOGI(TAG, "  • Memory Access Pattern Analysis");
     ESP_LOGI(TAG, "  • Allocation Performance Benchmarking");
+    ESP_LOGI(TAG, "  • Memory Hierarchy Microbenchmarks (CSV)");
     ESP_LOGI(TAG, "  • Memory Region Analysis");
     
     ESP_LOGI(TAG, "Memory Optimization System operational!");